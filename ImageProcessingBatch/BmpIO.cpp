@@ -0,0 +1,130 @@
+﻿#include "BmpIO.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+
+namespace {
+	uint16_t readU16(const unsigned char* p) {
+		return static_cast<uint16_t>(p[0] | (p[1] << 8));
+	}
+
+	uint32_t readU32(const unsigned char* p) {
+		return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+			(static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+	}
+
+	void writeU16(unsigned char* p, uint16_t v) {
+		p[0] = static_cast<unsigned char>(v);
+		p[1] = static_cast<unsigned char>(v >> 8);
+	}
+
+	void writeU32(unsigned char* p, uint32_t v) {
+		for (int i = 0; i < 4; i++) p[i] = static_cast<unsigned char>(v >> (8 * i));
+	}
+
+	const int fileHeaderSize = 14;
+	const int infoHeaderSize = 40;
+	const uint32_t BI_RGB = 0;
+	const uint32_t BI_BITFIELDS = 3;
+}
+
+bool BatchIO::ReadBmp(const std::string& path, BgraImage& image, std::string& error) {
+	std::ifstream file(path, std::ios::binary);
+	if (!file) {
+		error = "cannot open " + path;
+		return false;
+	}
+
+	std::vector<unsigned char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	if (data.size() < fileHeaderSize + infoHeaderSize || data[0] != 'B' || data[1] != 'M') {
+		error = "not a BMP file: " + path;
+		return false;
+	}
+
+	const uint32_t pixelOffset = readU32(&data[10]);
+	const unsigned char* info = &data[fileHeaderSize];
+	const int32_t width = static_cast<int32_t>(readU32(info + 4));
+	const int32_t rawHeight = static_cast<int32_t>(readU32(info + 8));
+	const uint16_t bitCount = readU16(info + 14);
+	const uint32_t compression = readU32(info + 16);
+
+	// 높이가 음수면 top-down 저장
+	const bool topDown = rawHeight < 0;
+	const int height = std::abs(rawHeight);
+
+	if (width <= 0 || height <= 0) {
+		error = "invalid BMP size: " + path;
+		return false;
+	}
+	if ((bitCount != 24 && bitCount != 32) ||
+		!(compression == BI_RGB || (compression == BI_BITFIELDS && bitCount == 32))) {
+		error = "unsupported BMP format (24/32bpp uncompressed only): " + path;
+		return false;
+	}
+
+	const int bytesPerPixel = bitCount / 8;
+	const size_t srcStride = (static_cast<size_t>(width) * bytesPerPixel + 3) & ~static_cast<size_t>(3);
+	if (pixelOffset + srcStride * height > data.size()) {
+		error = "truncated BMP file: " + path;
+		return false;
+	}
+
+	image.width = width;
+	image.height = height;
+	image.pixels.resize(static_cast<size_t>(width) * height * 4);
+
+	for (int y = 0; y < height; y++) {
+		const int srcY = topDown ? y : (height - 1 - y);
+		const unsigned char* src = &data[pixelOffset + srcStride * srcY];
+		unsigned char* dst = &image.pixels[static_cast<size_t>(y) * width * 4];
+
+		for (int x = 0; x < width; x++) {
+			dst[x * 4 + 0] = src[x * bytesPerPixel + 0];
+			dst[x * 4 + 1] = src[x * bytesPerPixel + 1];
+			dst[x * 4 + 2] = src[x * bytesPerPixel + 2];
+			dst[x * 4 + 3] = (bytesPerPixel == 4) ? src[x * 4 + 3] : 255;
+		}
+	}
+
+	return true;
+}
+
+bool BatchIO::WriteBmp(const std::string& path, const BgraImage& image, std::string& error) {
+	const uint32_t stride = static_cast<uint32_t>(image.width) * 4;
+	const uint32_t imageSize = stride * static_cast<uint32_t>(image.height);
+
+	unsigned char header[fileHeaderSize + infoHeaderSize] = { 0 };
+	header[0] = 'B';
+	header[1] = 'M';
+	writeU32(&header[2], fileHeaderSize + infoHeaderSize + imageSize);
+	writeU32(&header[10], fileHeaderSize + infoHeaderSize);
+
+	unsigned char* info = &header[fileHeaderSize];
+	writeU32(info + 0, infoHeaderSize);
+	writeU32(info + 4, static_cast<uint32_t>(image.width));
+	writeU32(info + 8, static_cast<uint32_t>(image.height)); // bottom-up
+	writeU16(info + 12, 1);
+	writeU16(info + 14, 32);
+	writeU32(info + 16, BI_RGB);
+	writeU32(info + 20, imageSize);
+	writeU32(info + 24, 3780); // 96 DPI
+	writeU32(info + 28, 3780);
+
+	std::ofstream file(path, std::ios::binary);
+	if (!file) {
+		error = "cannot create " + path;
+		return false;
+	}
+
+	file.write(reinterpret_cast<const char*>(header), sizeof(header));
+	for (int y = image.height - 1; y >= 0; y--) {
+		file.write(reinterpret_cast<const char*>(&image.pixels[static_cast<size_t>(y) * stride]), stride);
+	}
+
+	if (!file) {
+		error = "write failed: " + path;
+		return false;
+	}
+	return true;
+}
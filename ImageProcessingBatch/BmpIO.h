@@ -0,0 +1,18 @@
+﻿#pragma once
+
+#include <string>
+#include <vector>
+
+// 배치 CLI용 최소 BMP 입출력 (외부 라이브러리 없이 리눅스에서도 빌드)
+// 엔진 입력 형식과 같은 top-down BGRA 버퍼로 읽고 쓴다
+namespace BatchIO {
+	struct BgraImage {
+		int width = 0;
+		int height = 0;
+		std::vector<unsigned char> pixels; // width * height * 4
+	};
+
+	// 24/32비트 비압축(BI_RGB, BI_BITFIELDS) BMP만 지원
+	bool ReadBmp(const std::string& path, BgraImage& image, std::string& error);
+	bool WriteBmp(const std::string& path, const BgraImage& image, std::string& error);
+}
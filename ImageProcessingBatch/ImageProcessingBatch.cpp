@@ -0,0 +1,354 @@
+﻿#include <omp.h>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include "ImageProcessingEngineApp.h"
+#include "BmpIO.h"
+
+// UI 없이 엔진을 직접 호출하는 배치 처리기
+// 사용법: ImageProcessingBatch -i <입력 폴더> -o <출력 폴더> -p grayscale,blur:2,median:5 [-j 스레드 수]
+
+namespace fs = std::filesystem;
+using NativeEngine::ImageProcessingEngine;
+using NativeEngine::ImageView;
+using NativeEngine::CompoundMorphology;
+
+namespace {
+	enum class OpType {
+		Grayscale, Gaussian, GaussianBlur, Median, Binarization, Threshold, Bradley, Sauvola, MultiOtsu, Equalize, Clahe, Dilation, Erosion,
+		Opening, Closing, Gradient, TopHat, BlackHat, DiskDilation, DiskErosion,
+		Sobel, Canny, Laplacian, LaplacianFixed, Scharr, Prewitt, Emboss, FFT, IFFT, TemplateMatch, PyramidMatch, Components
+	};
+
+	struct BatchOp {
+		OpType type;
+		int param = 0;
+		int paramY = 0; // 세로 인자 (dilate:15x1 같은 직사각형 커널)
+		double value = 0.0; // 실수 인자 (gaussian sigma, 원판 반지름)
+		std::string arg;
+	};
+
+	struct OpInfo {
+		const char* name;
+		OpType type;
+		int defaultParam;
+	};
+
+	const OpInfo opTable[] = {
+		{ "grayscale", OpType::Grayscale, 0 },
+		{ "gaussian", OpType::Gaussian, 1 },
+		{ "blur", OpType::GaussianBlur, 1 },
+		{ "median", OpType::Median, 3 },
+		{ "binarize", OpType::Binarization, 0 },
+		{ "threshold", OpType::Threshold, 128 },
+		{ "bradley", OpType::Bradley, 0 },
+		{ "sauvola", OpType::Sauvola, 0 },
+		{ "multiotsu", OpType::MultiOtsu, 3 },
+		{ "equalize", OpType::Equalize, 0 },
+		{ "clahe", OpType::Clahe, 2 },
+		{ "dilate", OpType::Dilation, 3 },
+		{ "erode", OpType::Erosion, 3 },
+		{ "open", OpType::Opening, 3 },
+		{ "close", OpType::Closing, 3 },
+		{ "gradient", OpType::Gradient, 3 },
+		{ "tophat", OpType::TopHat, 3 },
+		{ "blackhat", OpType::BlackHat, 3 },
+		{ "diskdilate", OpType::DiskDilation, 3 },
+		{ "diskerode", OpType::DiskErosion, 3 },
+		{ "sobel", OpType::Sobel, 0 },
+		{ "canny", OpType::Canny, 50 },
+		{ "laplacian", OpType::Laplacian, 8 },
+		{ "laplacianfixed", OpType::LaplacianFixed, 8 },
+		{ "scharr", OpType::Scharr, 0 },
+		{ "prewitt", OpType::Prewitt, 0 },
+		{ "emboss", OpType::Emboss, 0 },
+		{ "fft", OpType::FFT, 0 },
+		{ "ifft", OpType::IFFT, 0 },
+		{ "match", OpType::TemplateMatch, 0 },
+		{ "pmatch", OpType::PyramidMatch, 0 },
+		{ "components", OpType::Components, 8 },
+	};
+
+	struct Options {
+		std::string inputDir;
+		std::string outputDir;
+		std::vector<BatchOp> ops;
+		int threads = 0;
+		bool quiet = false;
+	};
+
+	void printUsage() {
+		std::printf(
+			"usage: ImageProcessingBatch -i <input dir> -o <output dir> -p <op[:param],...> [-j threads] [-q]\n"
+			"ops: grayscale, gaussian[:sigma], blur[:radius], median[:kernel], binarize (Otsu),\n"
+			"     threshold[:value], bradley[:window], sauvola[:window] (window 0 = auto),\n"
+			"     multiotsu[:classes] (gray levels), equalize, clahe[:clipLimit] (8x8 tiles),\n"
+			"     dilate, erode, open, close, gradient, tophat, blackhat (each [:size] or [:WxH]),\n"
+			"     diskdilate[:radius], diskerode[:radius],\n"
+			"     sobel, canny[:low or :lowxhigh] (high defaults to 3 * low), laplacian[:4 or :8],\n"
+			"     laplacianfixed[:4 or :8] (no normalization, clipped at 255),\n"
+			"     scharr, prewitt, emboss, fft, ifft,\n"
+			"     match:<template.bmp>, pmatch:<template.bmp> (coarse-to-fine pyramid search),\n"
+			"     components[:4 or :8] (reports blob count, image unchanged)\n");
+	}
+
+	std::string toLower(std::string s) {
+		std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+		return s;
+	}
+
+	bool parseOps(const std::string& chain, std::vector<BatchOp>& ops) {
+		size_t start = 0;
+		while (start <= chain.size()) {
+			size_t end = chain.find(',', start);
+			if (end == std::string::npos) end = chain.size();
+			std::string token = chain.substr(start, end - start);
+			start = end + 1;
+			if (token.empty()) continue;
+
+			std::string name = token;
+			std::string arg;
+			const size_t colon = token.find(':');
+			if (colon != std::string::npos) {
+				name = token.substr(0, colon);
+				arg = token.substr(colon + 1);
+			}
+			name = toLower(name);
+
+			const OpInfo* info = nullptr;
+			for (const OpInfo& candidate : opTable) {
+				if (name == candidate.name) info = &candidate;
+			}
+			if (info == nullptr) {
+				std::fprintf(stderr, "unknown op: %s\n", name.c_str());
+				return false;
+			}
+
+			BatchOp op{ info->type, info->defaultParam, info->defaultParam, static_cast<double>(info->defaultParam), arg };
+			if (op.type == OpType::TemplateMatch || op.type == OpType::PyramidMatch) {
+				if (arg.empty()) {
+					std::fprintf(stderr, "%s needs a template path (%s:<file>)\n", info->name, info->name);
+					return false;
+				}
+			}
+			else if (!arg.empty()) {
+				op.param = std::atoi(arg.c_str());
+				op.value = std::atof(arg.c_str());
+				const size_t cross = toLower(arg).find('x');
+				op.paramY = cross != std::string::npos ? std::atoi(arg.c_str() + cross + 1) : op.param;
+			}
+			if (op.type == OpType::Canny && toLower(arg).find('x') == std::string::npos) op.paramY = 3 * op.param;
+			ops.push_back(op);
+		}
+		return !ops.empty();
+	}
+
+	bool parseArgs(int argc, char** argv, Options& options) {
+		for (int i = 1; i < argc; i++) {
+			const std::string a = argv[i];
+			const bool hasValue = i + 1 < argc;
+			if (a == "-i" && hasValue) options.inputDir = argv[++i];
+			else if (a == "-o" && hasValue) options.outputDir = argv[++i];
+			else if (a == "-p" && hasValue) {
+				if (!parseOps(argv[++i], options.ops)) return false;
+			}
+			else if (a == "-j" && hasValue) options.threads = std::atoi(argv[++i]);
+			else if (a == "-q") options.quiet = true;
+			else return false;
+		}
+		return !options.inputDir.empty() && !options.outputDir.empty() && !options.ops.empty();
+	}
+
+	// 체인 실행, 실패 시 false
+	// generation은 파일마다 달라야 함 (같은 주소의 버퍼를 다음 파일이 재사용해도 캐시가 섞이지 않게)
+	bool runChain(ImageProcessingEngine& engine, const std::vector<BatchOp>& ops,
+		const std::vector<BatchIO::BgraImage>& templates, BatchIO::BgraImage& image,
+		unsigned long long generation, std::string& report)
+	{
+		ImageView view(image.pixels.data(), image.width, image.height);
+		view.generation = generation;
+		size_t templateIndex = 0;
+
+		for (const BatchOp& op : ops) {
+			switch (op.type) {
+			case OpType::Grayscale: engine.ApplyGrayscale(view); break;
+			case OpType::Gaussian: engine.ApplyGaussianBlur(view, static_cast<float>(op.value)); break;
+			case OpType::GaussianBlur: engine.ApplyGaussianBlur(view, op.param); break;
+			case OpType::Median: engine.ApplyMedian(view, op.param); break;
+			case OpType::Binarization: engine.ApplyBinarization(view); break;
+			case OpType::Threshold:
+			case OpType::Bradley:
+			case OpType::Sauvola: {
+				NativeEngine::BinarizationOptions options;
+				options.method = op.type == OpType::Threshold ? NativeEngine::BinarizationMethod::Fixed
+					: op.type == OpType::Bradley ? NativeEngine::BinarizationMethod::Bradley : NativeEngine::BinarizationMethod::Sauvola;
+				options.threshold = op.param;
+				options.windowSize = op.param;
+				engine.ApplyBinarization(view, options);
+				break;
+			}
+			case OpType::MultiOtsu: engine.ApplyMultiOtsu(view, op.param); break;
+			case OpType::Equalize: engine.ApplyHistogramEqualization(view); break;
+			case OpType::Clahe: {
+				NativeEngine::ClaheOptions options;
+				options.clipLimit = static_cast<float>(op.value);
+				engine.ApplyClahe(view, options);
+				break;
+			}
+			case OpType::Dilation: engine.ApplyDilation(view, op.param, op.paramY); break;
+			case OpType::Erosion: engine.ApplyErosion(view, op.param, op.paramY); break;
+			case OpType::Opening: engine.ApplyMorphology(view, CompoundMorphology::Opening, op.param, op.paramY); break;
+			case OpType::Closing: engine.ApplyMorphology(view, CompoundMorphology::Closing, op.param, op.paramY); break;
+			case OpType::Gradient: engine.ApplyMorphology(view, CompoundMorphology::Gradient, op.param, op.paramY); break;
+			case OpType::TopHat: engine.ApplyMorphology(view, CompoundMorphology::TopHat, op.param, op.paramY); break;
+			case OpType::BlackHat: engine.ApplyMorphology(view, CompoundMorphology::BlackHat, op.param, op.paramY); break;
+			case OpType::DiskDilation: engine.ApplyDiskDilation(view, static_cast<float>(op.value)); break;
+			case OpType::DiskErosion: engine.ApplyDiskErosion(view, static_cast<float>(op.value)); break;
+			case OpType::Sobel: engine.ApplySobel(view); break;
+			case OpType::Canny: engine.ApplyCanny(view, 1.4f, op.param, op.paramY); break;
+			case OpType::Laplacian:
+			case OpType::LaplacianFixed:
+				engine.ApplyLaplacian(view, op.param == 4 ? NativeEngine::StencilOperator::Laplacian4 : NativeEngine::StencilOperator::Laplacian8,
+					op.type == OpType::LaplacianFixed ? NativeEngine::LaplacianScale::Fixed : NativeEngine::LaplacianScale::Normalized);
+				break;
+			case OpType::Scharr: engine.ApplyStencil(view, NativeEngine::StencilOperator::Scharr); break;
+			case OpType::Prewitt: engine.ApplyStencil(view, NativeEngine::StencilOperator::Prewitt); break;
+			case OpType::Emboss: engine.ApplyStencil(view, NativeEngine::StencilOperator::Emboss); break;
+			case OpType::FFT:
+				if (!engine.ApplyFFT(view)) return false;
+				break;
+			case OpType::IFFT:
+				if (!engine.ApplyIFFT(view)) return false;
+				break;
+			case OpType::TemplateMatch:
+			case OpType::PyramidMatch: {
+				const BatchIO::BgraImage& t = templates[templateIndex++];
+				if (t.width > view.width || t.height > view.height) return false;
+				NativeEngine::TemplateMatchOptions options;
+				if (op.type == OpType::PyramidMatch) options.mode = NativeEngine::TemplateMatchMode::Pyramid;
+				int matchX = -1, matchY = -1;
+				engine.ApplyTemplateMatch(view, ImageView(const_cast<unsigned char*>(t.pixels.data()), t.width, t.height),
+					&matchX, &matchY, options);
+				report += " match=" + std::to_string(matchX) + "," + std::to_string(matchY);
+				break;
+			}
+			case OpType::Components: {
+				std::vector<NativeEngine::Blob> blobs;
+				const int count = engine.LabelComponents(view,
+					op.param == 4 ? NativeEngine::Connectivity::Four : NativeEngine::Connectivity::Eight, nullptr, blobs);
+				report += " blobs=" + std::to_string(count);
+				break;
+			}
+			}
+		}
+		engine.ClearFFTData();
+		return true;
+	}
+}
+
+int main(int argc, char** argv) {
+	Options options;
+	if (!parseArgs(argc, argv, options)) {
+		printUsage();
+		return 1;
+	}
+
+	// 템플릿은 한 번만 읽어서 모든 스레드가 공유
+	std::vector<BatchIO::BgraImage> templates;
+	for (const BatchOp& op : options.ops) {
+		if (op.type != OpType::TemplateMatch && op.type != OpType::PyramidMatch) continue;
+		BatchIO::BgraImage t;
+		std::string error;
+		if (!BatchIO::ReadBmp(op.arg, t, error)) {
+			std::fprintf(stderr, "%s\n", error.c_str());
+			return 1;
+		}
+		templates.push_back(std::move(t));
+	}
+
+	std::error_code ec;
+	std::vector<fs::path> files;
+	for (const auto& entry : fs::directory_iterator(options.inputDir, ec)) {
+		if (entry.is_regular_file() && toLower(entry.path().extension().string()) == ".bmp") {
+			files.push_back(entry.path());
+		}
+	}
+	if (ec) {
+		std::fprintf(stderr, "cannot read %s: %s\n", options.inputDir.c_str(), ec.message().c_str());
+		return 1;
+	}
+	std::sort(files.begin(), files.end());
+
+	fs::create_directories(options.outputDir, ec);
+	if (ec) {
+		std::fprintf(stderr, "cannot create %s: %s\n", options.outputDir.c_str(), ec.message().c_str());
+		return 1;
+	}
+
+	const int fileCount = static_cast<int>(files.size());
+	if (fileCount == 0) {
+		std::printf("no .bmp files in %s\n", options.inputDir.c_str());
+		return 0;
+	}
+
+	// 파일 단위 병렬화가 기본, 파일 수가 스레드보다 적으면 남는 코어는 엔진 내부 병렬화에 사용
+	const int threads = options.threads > 0 ? options.threads : omp_get_max_threads();
+	const int outerThreads = std::min(threads, fileCount);
+	const int innerThreads = std::max(1, threads / outerThreads);
+	omp_set_max_active_levels(innerThreads > 1 ? 2 : 1);
+
+	int failed = 0;
+	long long totalPixels = 0;
+	const auto start = std::chrono::steady_clock::now();
+
+#pragma omp parallel num_threads(outerThreads) reduction(+:failed, totalPixels)
+	{
+		omp_set_num_threads(innerThreads);
+		ImageProcessingEngine engine; // FFT 상태가 있어서 스레드마다 하나씩
+
+#pragma omp for schedule(dynamic)
+		for (int i = 0; i < fileCount; i++) {
+			BatchIO::BgraImage image;
+			std::string error;
+			std::string report;
+			const fs::path outPath = fs::path(options.outputDir) / files[i].filename().replace_extension(".bmp");
+
+			bool ok = BatchIO::ReadBmp(files[i].string(), image, error);
+			if (ok && !runChain(engine, options.ops, templates, image, static_cast<unsigned long long>(i) + 1, report)) {
+				error = "processing failed: " + files[i].string();
+				ok = false;
+			}
+			if (ok) ok = BatchIO::WriteBmp(outPath.string(), image, error);
+
+			if (ok) {
+				totalPixels += static_cast<long long>(image.width) * image.height;
+			}
+			else {
+				failed++;
+			}
+
+			if (!ok || !options.quiet || !report.empty()) {
+#pragma omp critical(batch_log)
+				{
+					if (ok) std::printf("%s%s\n", files[i].filename().string().c_str(), report.c_str());
+					else std::fprintf(stderr, "%s\n", error.c_str());
+				}
+			}
+		}
+	}
+
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	const int processed = fileCount - failed;
+	const double imagesPerSec = seconds > 0 ? processed / seconds : 0.0;
+
+	std::printf("processed %d/%d images in %.3f s with %d threads\n", processed, fileCount, seconds, threads);
+	std::printf("throughput: %.2f images/s, %.2f images/s/core, %.1f MP/s\n",
+		imagesPerSec, imagesPerSec / threads, seconds > 0 ? totalPixels / seconds / 1e6 : 0.0);
+
+	return failed == 0 ? 0 : 2;
+}
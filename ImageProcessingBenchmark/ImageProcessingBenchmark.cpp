@@ -0,0 +1,449 @@
+﻿#include <omp.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "ImageProcessingEngineApp.h"
+#include "BinaryImage.h"
+#include "SeparableFilter.h"
+
+// 엔진 Apply* 커널 벤치마크
+// 합성 이미지(고정 시드)로 크기/스레드 수별 시간 측정 -> ns/pixel, GB/s, 병렬 효율
+// 사용법: ImageProcessingBenchmark [--sizes 0.3,2,8,33,100] [--threads 1,2,4] [--kernels sobel,median]
+//                                  [--reps 3] [--json result.json] [--no-limits]
+
+using NativeEngine::ImageProcessingEngine;
+using NativeEngine::ImageView;
+
+namespace {
+	struct ImageSize {
+		const char* name;
+		int width;
+		int height;
+	};
+
+	const ImageSize sizeTable[] = {
+		{ "0.3", 640, 480 },
+		{ "2", 1920, 1080 },
+		{ "8", 3840, 2160 },
+		{ "33", 7680, 4320 },
+		{ "100", 12288, 8192 },
+	};
+
+	struct Image {
+		int width = 0;
+		int height = 0;
+		std::vector<unsigned char> pixels;
+	};
+
+	// 커널 하나 = 준비(시간 미포함) + 측정 대상
+	struct Kernel {
+		const char* name;
+		double bytesPerPixel;   // GB/s 계산용 (읽기 + 쓰기)
+		double maxMegapixels;   // 기본 실행 상한 (0 = 제한 없음)
+		std::function<void(ImageProcessingEngine&, Image&)> prepare;
+		std::function<void(ImageProcessingEngine&, Image&)> run;
+	};
+
+	struct Result {
+		std::string kernel;
+		std::string size;
+		int width;
+		int height;
+		int threads;
+		double ms;
+		double nsPerPixel;
+		double gbPerSec;
+		double speedup;
+		double efficiency;
+	};
+
+	struct Options {
+		std::vector<std::string> sizes;
+		std::vector<int> threads;
+		std::vector<std::string> kernels;
+		int reps = 3;
+		std::string jsonPath;
+		bool noLimits = false;
+	};
+
+	// 결정적 합성 이미지: 그라디언트 + 도형 + xorshift 노이즈
+	Image makeImage(int width, int height, uint32_t seed) {
+		Image image;
+		image.width = width;
+		image.height = height;
+		image.pixels.resize(static_cast<size_t>(width) * height * 4);
+
+#pragma omp parallel for schedule(static)
+		for (int y = 0; y < height; y++) {
+			uint32_t state = seed ^ (static_cast<uint32_t>(y) * 2654435761u);
+			if (state == 0) state = 1;
+			unsigned char* row = &image.pixels[static_cast<size_t>(y) * width * 4];
+			for (int x = 0; x < width; x++) {
+				state ^= state << 13;
+				state ^= state >> 17;
+				state ^= state << 5;
+				const int noise = static_cast<int>(state & 31) - 16;
+				const bool block = ((x / 64) + (y / 64)) % 5 == 0;
+				const int base = block ? 220 : (x * 255 / width + y * 255 / height) / 2;
+				row[x * 4 + 0] = static_cast<unsigned char>(std::clamp(base + noise, 0, 255));
+				row[x * 4 + 1] = static_cast<unsigned char>(std::clamp(base * 3 / 4 + noise, 0, 255));
+				row[x * 4 + 2] = static_cast<unsigned char>(std::clamp(255 - base + noise, 0, 255));
+				row[x * 4 + 3] = 255;
+			}
+		}
+		return image;
+	}
+
+	std::vector<Kernel> makeKernels() {
+		auto none = [](ImageProcessingEngine&, Image&) {};
+		std::vector<Kernel> kernels;
+
+		kernels.push_back({ "grayscale", 8, 0, none,
+			[](ImageProcessingEngine& e, Image& img) { e.ApplyGrayscale(img.pixels.data(), img.width, img.height); } });
+		kernels.push_back({ "boxBlur", 8, 0, none,
+			[](ImageProcessingEngine& e, Image& img) { e.ApplyGaussianBlur(img.pixels.data(), img.width, img.height, 2); } });
+		// 박스 블러 가로/세로 패스 단독 (8K 폭에서 세로 패스가 전체를 좌우하지 않는지 확인)
+		auto passBuffer = std::make_shared<std::vector<unsigned char>>();
+		auto preparePass = [passBuffer](ImageProcessingEngine&, Image& img) { passBuffer->resize(img.pixels.size()); };
+		kernels.push_back({ "boxRows", 8, 0, preparePass,
+			[passBuffer](ImageProcessingEngine&, Image& img) {
+				NativeEngine::BoxFilterRows(ImageView(img.pixels.data(), img.width, img.height),
+					ImageView(passBuffer->data(), img.width, img.height), 2);
+			} });
+		kernels.push_back({ "boxColumns", 8, 0, preparePass,
+			[passBuffer](ImageProcessingEngine&, Image& img) {
+				NativeEngine::BoxFilterColumns(ImageView(img.pixels.data(), img.width, img.height),
+					ImageView(passBuffer->data(), img.width, img.height), 2);
+			} });
+		// 작은 sigma(직접 컨볼루션)와 큰 sigma(재귀 필터)의 시간이 같은 수준이어야 함
+		kernels.push_back({ "gaussian1", 8, 0, none,
+			[](ImageProcessingEngine& e, Image& img) { e.ApplyGaussianBlur(img.pixels.data(), img.width, img.height, 1.0f); } });
+		kernels.push_back({ "gaussian25", 8, 0, none,
+			[](ImageProcessingEngine& e, Image& img) { e.ApplyGaussianBlur(img.pixels.data(), img.width, img.height, 25.0f); } });
+		kernels.push_back({ "median3", 8, 0, none,
+			[](ImageProcessingEngine& e, Image& img) { e.ApplyMedian(img.pixels.data(), img.width, img.height, 3); } });
+		kernels.push_back({ "median15", 8, 0, none,
+			[](ImageProcessingEngine& e, Image& img) { e.ApplyMedian(img.pixels.data(), img.width, img.height, 15); } });
+		kernels.push_back({ "binarization", 8, 0, none,
+			[](ImageProcessingEngine& e, Image& img) { e.ApplyBinarization(img.pixels.data(), img.width, img.height); } });
+		kernels.push_back({ "multiOtsu4", 8, 0, none,
+			[](ImageProcessingEngine& e, Image& img) { e.ApplyMultiOtsu(img.pixels.data(), img.width, img.height, 4); } });
+		kernels.push_back({ "histograms", 4, 0, none,
+			[](ImageProcessingEngine& e, Image& img) {
+				NativeEngine::ImageHistograms histograms;
+				e.ComputeHistograms(img.pixels.data(), img.width, img.height, histograms);
+			} });
+		kernels.push_back({ "equalize", 8, 0, none,
+			[](ImageProcessingEngine& e, Image& img) { e.ApplyHistogramEqualization(img.pixels.data(), img.width, img.height); } });
+		kernels.push_back({ "clahe", 8, 0, none,
+			[](ImageProcessingEngine& e, Image& img) { e.ApplyClahe(img.pixels.data(), img.width, img.height, NativeEngine::ClaheOptions()); } });
+		kernels.push_back({ "bradley", 24, 0, none,
+			[](ImageProcessingEngine& e, Image& img) {
+				NativeEngine::BinarizationOptions options;
+				options.method = NativeEngine::BinarizationMethod::Bradley;
+				e.ApplyBinarization(img.pixels.data(), img.width, img.height, options);
+			} });
+		kernels.push_back({ "sauvola", 56, 0, none,
+			[](ImageProcessingEngine& e, Image& img) {
+				NativeEngine::BinarizationOptions options;
+				options.method = NativeEngine::BinarizationMethod::Sauvola;
+				e.ApplyBinarization(img.pixels.data(), img.width, img.height, options);
+			} });
+		kernels.push_back({ "dilation", 8, 0, none,
+			[](ImageProcessingEngine& e, Image& img) { e.ApplyDilation(img.pixels.data(), img.width, img.height); } });
+		kernels.push_back({ "erosion", 8, 0, none,
+			[](ImageProcessingEngine& e, Image& img) { e.ApplyErosion(img.pixels.data(), img.width, img.height); } });
+		// 3x3과 비슷한 시간이어야 함
+		kernels.push_back({ "dilation51", 8, 0, none,
+			[](ImageProcessingEngine& e, Image& img) { e.ApplyDilation(img.pixels.data(), img.width, img.height, 51); } });
+		// 침식 + 팽창 두 번 호출보다 빨라야 함
+		kernels.push_back({ "opening15", 8, 0, none,
+			[](ImageProcessingEngine& e, Image& img) {
+				e.ApplyMorphology(img.pixels.data(), img.width, img.height, NativeEngine::CompoundMorphology::Opening, 15);
+			} });
+		// 1비트 이진 이미지 (BGRA dilation과 비교)
+		struct BinaryState {
+			NativeEngine::BinaryImage image;
+			NativeEngine::ScratchPool scratch;
+		};
+		auto binary = std::make_shared<BinaryState>();
+		kernels.push_back({ "binaryPack", 8, 0, none,
+			[binary](ImageProcessingEngine&, Image& img) {
+				NativeEngine::PackBinary(ImageView(img.pixels.data(), img.width, img.height), binary->image);
+			} });
+		kernels.push_back({ "binaryDilate15", 8, 0,
+			[binary](ImageProcessingEngine&, Image& img) {
+				NativeEngine::PackBinary(ImageView(img.pixels.data(), img.width, img.height), binary->image);
+			},
+			[binary](ImageProcessingEngine&, Image&) {
+				NativeEngine::BinaryDilate(binary->image, binary->image, 15, 15, binary->scratch);
+			} });
+		// 거리 변환 (BGRA 읽기 + float 쓰기), 원판 팽창은 반지름과 무관해야 함
+		auto distanceBuffer = std::make_shared<std::vector<float>>();
+		kernels.push_back({ "distance", 8, 0,
+			[distanceBuffer](ImageProcessingEngine&, Image& img) {
+				distanceBuffer->resize(static_cast<size_t>(img.width) * img.height);
+			},
+			[distanceBuffer](ImageProcessingEngine& e, Image& img) {
+				e.ApplyDistanceTransform(img.pixels.data(), img.width, img.height, distanceBuffer->data());
+			} });
+		// 연결 요소 (이진화는 준비 단계, 라벨 평면 int 쓰기 + union-find 읽기)
+		auto labelBuffer = std::make_shared<std::vector<int>>();
+		kernels.push_back({ "components", 12, 0,
+			[labelBuffer](ImageProcessingEngine& e, Image& img) {
+				labelBuffer->resize(static_cast<size_t>(img.width) * img.height);
+				e.ApplyBinarization(img.pixels.data(), img.width, img.height);
+			},
+			[labelBuffer](ImageProcessingEngine& e, Image& img) {
+				std::vector<NativeEngine::Blob> blobs;
+				e.LabelComponents(img.pixels.data(), img.width, img.height, NativeEngine::Connectivity::Eight, labelBuffer->data(), blobs);
+			} });
+		kernels.push_back({ "diskDilate25", 8, 0, none,
+			[](ImageProcessingEngine& e, Image& img) { e.ApplyDiskDilation(img.pixels.data(), img.width, img.height, 25.0f); } });
+		kernels.push_back({ "sobel", 8, 0, none,
+			[](ImageProcessingEngine& e, Image& img) { e.ApplySobel(img.pixels.data(), img.width, img.height); } });
+		kernels.push_back({ "sobelL1", 8, 0, none,
+			[](ImageProcessingEngine& e, Image& img) {
+				e.ApplySobel(img.pixels.data(), img.width, img.height, NativeEngine::GradientNorm::L1, nullptr);
+			} });
+		// 방향 평면 추가 쓰기 (BGRA 읽기/쓰기 + 1바이트)
+		auto directionBuffer = std::make_shared<std::vector<unsigned char>>();
+		kernels.push_back({ "sobelDirection", 9, 0,
+			[directionBuffer](ImageProcessingEngine&, Image& img) {
+				directionBuffer->resize(static_cast<size_t>(img.width) * img.height);
+			},
+			[directionBuffer](ImageProcessingEngine& e, Image& img) {
+				e.ApplySobel(img.pixels.data(), img.width, img.height, NativeEngine::GradientNorm::L2, directionBuffer->data());
+			} });
+		kernels.push_back({ "canny", 8, 0, none,
+			[](ImageProcessingEngine& e, Image& img) { e.ApplyCanny(img.pixels.data(), img.width, img.height, 1.4f, 50, 150); } });
+		kernels.push_back({ "laplacian", 8, 0, none,
+			[](ImageProcessingEngine& e, Image& img) { e.ApplyLaplacian(img.pixels.data(), img.width, img.height); } });
+		kernels.push_back({ "laplacian4", 8, 0, none,
+			[](ImageProcessingEngine& e, Image& img) {
+				e.ApplyLaplacian(img.pixels.data(), img.width, img.height, NativeEngine::StencilOperator::Laplacian4);
+			} });
+		kernels.push_back({ "laplacianFixed", 8, 0, none,
+			[](ImageProcessingEngine& e, Image& img) {
+				e.ApplyLaplacian(img.pixels.data(), img.width, img.height, NativeEngine::StencilOperator::Laplacian8, NativeEngine::LaplacianScale::Fixed);
+			} });
+		kernels.push_back({ "scharr", 8, 0, none,
+			[](ImageProcessingEngine& e, Image& img) { e.ApplyStencil(img.pixels.data(), img.width, img.height, NativeEngine::StencilOperator::Scharr); } });
+		kernels.push_back({ "prewitt", 8, 0, none,
+			[](ImageProcessingEngine& e, Image& img) { e.ApplyStencil(img.pixels.data(), img.width, img.height, NativeEngine::StencilOperator::Prewitt); } });
+		kernels.push_back({ "emboss", 8, 0, none,
+			[](ImageProcessingEngine& e, Image& img) { e.ApplyStencil(img.pixels.data(), img.width, img.height, NativeEngine::StencilOperator::Emboss); } });
+		// 옥타브 0만 해도 float 가우시안 6장 + DoG 5장 쓰기, 전체는 그 4/3배 (읽기 포함 대략)
+		auto scaleSpace = std::make_shared<NativeEngine::ScaleSpace>();
+		kernels.push_back({ "scaleSpaceDoG", 80, 0, none,
+			[scaleSpace](ImageProcessingEngine& e, Image& img) {
+				e.BuildScaleSpace(img.pixels.data(), img.width, img.height, NativeEngine::ScaleSpaceOptions(), *scaleSpace);
+			} });
+
+		// 템플릿은 준비 단계에서 이미지 크기가 바뀔 때만 잘라 둠 (복사는 측정에서 제외)
+		struct Template {
+			int imageWidth = 0;
+			int imageHeight = 0;
+			int width = 0;
+			int height = 0;
+			std::vector<unsigned char> pixels;
+		};
+		auto cropTemplate = [](Template& templ, const Image& img, int tw, int th, int ox, int oy) {
+			if (templ.imageWidth == img.width && templ.imageHeight == img.height) return;
+			templ.imageWidth = img.width;
+			templ.imageHeight = img.height;
+			templ.width = tw;
+			templ.height = th;
+			templ.pixels.resize(static_cast<size_t>(tw) * th * 4);
+			for (int y = 0; y < th; y++) {
+				memcpy(&templ.pixels[static_cast<size_t>(y) * tw * 4], &img.pixels[(static_cast<size_t>(oy + y) * img.width + ox) * 4], static_cast<size_t>(tw) * 4);
+			}
+		};
+
+		// 전수 SAD 탐색이라 큰 이미지는 기본 제외
+		auto matchTemplate = std::make_shared<Template>();
+		kernels.push_back({ "templateMatch", 4, 2.5,
+			[matchTemplate, cropTemplate](ImageProcessingEngine&, Image& img) {
+				cropTemplate(*matchTemplate, img, 16, 16, img.width / 2, img.height / 2);
+			},
+			[matchTemplate](ImageProcessingEngine& e, Image& img) {
+				int matchX = -1, matchY = -1;
+				e.ApplyTemplateMatch(img.pixels.data(), img.width, img.height, matchTemplate->pixels.data(),
+					matchTemplate->width, matchTemplate->height, &matchX, &matchY);
+			} });
+		// 피라미드는 맨 위 단계만 전수라 큰 템플릿/이미지도 전체 크기에서
+		auto pyramidTemplate = std::make_shared<Template>();
+		kernels.push_back({ "templatePyramid", 4, 0,
+			[pyramidTemplate, cropTemplate](ImageProcessingEngine&, Image& img) {
+				cropTemplate(*pyramidTemplate, img, std::min(128, img.width / 2), std::min(128, img.height / 2), img.width / 3, img.height / 3);
+			},
+			[pyramidTemplate](ImageProcessingEngine& e, Image& img) {
+				NativeEngine::TemplateMatchOptions options;
+				options.mode = NativeEngine::TemplateMatchMode::Pyramid;
+				int matchX = -1, matchY = -1;
+				e.ApplyTemplateMatch(img.pixels.data(), img.width, img.height, pyramidTemplate->pixels.data(),
+					pyramidTemplate->width, pyramidTemplate->height, &matchX, &matchY, options);
+			} });
+
+		// complex<double> 2D 배열 + 백업이라 메모리 사용량이 커서 기본 상한
+		kernels.push_back({ "fft", 8, 9, none,
+			[](ImageProcessingEngine& e, Image& img) { e.ApplyFFT(img.pixels.data(), img.width, img.height); } });
+		kernels.push_back({ "ifft", 8, 9,
+			[](ImageProcessingEngine& e, Image& img) { e.ApplyFFT(img.pixels.data(), img.width, img.height); },
+			[](ImageProcessingEngine& e, Image& img) { e.ApplyIFFT(img.pixels.data(), img.width, img.height); } });
+
+		return kernels;
+	}
+
+	std::vector<std::string> splitList(const std::string& s) {
+		std::vector<std::string> items;
+		size_t start = 0;
+		while (start <= s.size()) {
+			size_t end = s.find(',', start);
+			if (end == std::string::npos) end = s.size();
+			if (end > start) items.push_back(s.substr(start, end - start));
+			start = end + 1;
+		}
+		return items;
+	}
+
+	bool parseArgs(int argc, char** argv, Options& options) {
+		for (int i = 1; i < argc; i++) {
+			const std::string a = argv[i];
+			const bool hasValue = i + 1 < argc;
+			if (a == "--sizes" && hasValue) options.sizes = splitList(argv[++i]);
+			else if (a == "--kernels" && hasValue) options.kernels = splitList(argv[++i]);
+			else if (a == "--threads" && hasValue) {
+				for (const std::string& t : splitList(argv[++i])) options.threads.push_back(std::max(1, std::atoi(t.c_str())));
+			}
+			else if (a == "--reps" && hasValue) options.reps = std::max(1, std::atoi(argv[++i]));
+			else if (a == "--json" && hasValue) options.jsonPath = argv[++i];
+			else if (a == "--no-limits") options.noLimits = true;
+			else return false;
+		}
+		return true;
+	}
+
+	// 기본 스레드 목록: 1, 2, 4, ... , 최대
+	std::vector<int> defaultThreads() {
+		std::vector<int> threads;
+		const int maxThreads = omp_get_max_threads();
+		for (int t = 1; t < maxThreads; t *= 2) threads.push_back(t);
+		threads.push_back(maxThreads);
+		return threads;
+	}
+
+	bool contains(const std::vector<std::string>& list, const std::string& value) {
+		return list.empty() || std::find(list.begin(), list.end(), value) != list.end();
+	}
+
+	// 준비 + 원본 복사는 측정에서 제외, 반복 중 중앙값 사용
+	double measure(const Kernel& kernel, ImageProcessingEngine& engine, const Image& source, Image& work, int reps) {
+		std::vector<double> times;
+		work.width = source.width;
+		work.height = source.height;
+		for (int r = 0; r <= reps; r++) { // 첫 회는 워밍업
+			work.pixels = source.pixels;
+			kernel.prepare(engine, work);
+
+			const auto start = std::chrono::steady_clock::now();
+			kernel.run(engine, work);
+			const auto end = std::chrono::steady_clock::now();
+
+			engine.ClearFFTData();
+			if (r > 0) times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+		}
+		std::sort(times.begin(), times.end());
+		return times[times.size() / 2];
+	}
+
+	void writeJson(const std::string& path, const std::vector<Result>& results, int reps, ImageProcessingEngine& engine) {
+		FILE* file = std::fopen(path.c_str(), "w");
+		if (file == nullptr) {
+			std::fprintf(stderr, "cannot write %s\n", path.c_str());
+			return;
+		}
+
+		std::fprintf(file, "{\n  \"benchmark\": \"ImageProcessingEngine\",\n");
+		std::fprintf(file, "  \"maxThreads\": %d,\n  \"reps\": %d,\n", omp_get_max_threads(), reps);
+		std::fprintf(file, "  \"scratchHighWaterBytes\": %zu,\n  \"scratchHeapAllocations\": %zu,\n  \"results\": [\n",
+			engine.GetScratchHighWaterMark(), engine.GetScratchHeapAllocations());
+		for (size_t i = 0; i < results.size(); i++) {
+			const Result& r = results[i];
+			std::fprintf(file,
+				"    { \"kernel\": \"%s\", \"megapixels\": \"%s\", \"width\": %d, \"height\": %d, \"threads\": %d, "
+				"\"ms\": %.4f, \"nsPerPixel\": %.4f, \"gbPerSec\": %.4f, \"speedup\": %.4f, \"efficiency\": %.4f }%s\n",
+				r.kernel.c_str(), r.size.c_str(), r.width, r.height, r.threads,
+				r.ms, r.nsPerPixel, r.gbPerSec, r.speedup, r.efficiency,
+				i + 1 < results.size() ? "," : "");
+		}
+		std::fprintf(file, "  ]\n}\n");
+		std::fclose(file);
+	}
+}
+
+int main(int argc, char** argv) {
+	Options options;
+	if (!parseArgs(argc, argv, options)) {
+		std::printf("usage: ImageProcessingBenchmark [--sizes 0.3,2,8,33,100] [--threads 1,2,4] "
+			"[--kernels name,...] [--reps n] [--json file] [--no-limits]\n");
+		return 1;
+	}
+	if (options.threads.empty()) options.threads = defaultThreads();
+	std::sort(options.threads.begin(), options.threads.end());
+
+	const std::vector<Kernel> kernels = makeKernels();
+	std::vector<Result> results;
+	ImageProcessingEngine engine;
+
+	std::printf("%-14s %6s %8s %10s %10s %8s %8s %6s\n", "kernel", "MP", "threads", "ms", "ns/px", "GB/s", "speedup", "eff");
+
+	for (const ImageSize& size : sizeTable) {
+		if (!contains(options.sizes, size.name)) continue;
+
+		const double megapixels = static_cast<double>(size.width) * size.height / 1e6;
+		const Image source = makeImage(size.width, size.height, 0x1234567u);
+		Image work;
+
+		for (const Kernel& kernel : kernels) {
+			if (!contains(options.kernels, kernel.name)) continue;
+			if (!options.noLimits && kernel.maxMegapixels > 0 && megapixels > kernel.maxMegapixels) continue;
+
+			double baseMs = 0.0;
+			for (int threads : options.threads) {
+				omp_set_num_threads(threads);
+				const double ms = measure(kernel, engine, source, work, options.reps);
+				if (threads == options.threads.front()) baseMs = ms * threads;
+
+				Result r;
+				r.kernel = kernel.name;
+				r.size = size.name;
+				r.width = size.width;
+				r.height = size.height;
+				r.threads = threads;
+				r.ms = ms;
+				r.nsPerPixel = ms * 1e6 / (megapixels * 1e6);
+				r.gbPerSec = megapixels * 1e6 * kernel.bytesPerPixel / (ms * 1e-3) / 1e9;
+				r.speedup = baseMs / ms;
+				r.efficiency = r.speedup / threads;
+				results.push_back(r);
+
+				std::printf("%-14s %6s %8d %10.3f %10.3f %8.3f %8.2f %6.2f\n",
+					r.kernel.c_str(), r.size.c_str(), r.threads, r.ms, r.nsPerPixel, r.gbPerSec, r.speedup, r.efficiency);
+				std::fflush(stdout);
+			}
+		}
+	}
+
+	std::printf("scratch pool: high-water %.1f MB, %zu heap allocations\n",
+		engine.GetScratchHighWaterMark() / 1e6, engine.GetScratchHeapAllocations());
+
+	if (!options.jsonPath.empty()) writeJson(options.jsonPath, results, options.reps, engine);
+	return 0;
+}
@@ -0,0 +1,82 @@
+﻿#include <omp.h>
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+#include "AdaptiveThreshold.h"
+#include "IntegralImage.h"
+
+using namespace std;
+
+namespace {
+	using namespace NativeEngine;
+
+	// 창 [left, right) 합 (top/bottom은 표 행 포인터)
+	template <typename T>
+	inline float windowSum(const T* top, const T* bottom, int left, int right) {
+		return static_cast<float>(bottom[right] - bottom[left] - top[right] + top[left]);
+	}
+
+	// 행마다 창 [left, right) x [top, bottom)을 이미지 안으로 잘라 decide(값, 창 합, 창 제곱 합, 넓이)
+	// SquareTable이 nullptr_t면 제곱 합은 0
+	template <class SumTable, class SquareTable, class Decide>
+	void thresholdRows(const unsigned char* gray, unsigned char* binary, int width, int height, int radius,
+		const SumTable& sum, const SquareTable& squares, Decide decide)
+	{
+		constexpr bool hasSquares = !std::is_same_v<SquareTable, std::nullptr_t>;
+
+#pragma omp parallel for schedule(static)
+		for (int y = 0; y < height; y++) {
+			const int top = std::max(y - radius, 0);
+			const int bottom = std::min(y + radius + 1, height);
+			const auto* sTop = sum.Row(top);
+			const auto* sBottom = sum.Row(bottom);
+			const unsigned char* in = gray + static_cast<size_t>(y) * width;
+			unsigned char* out = binary + static_cast<size_t>(y) * width;
+
+			for (int x = 0; x < width; x++) {
+				const int left = std::max(x - radius, 0);
+				const int right = std::min(x + radius + 1, width);
+				const int area = (right - left) * (bottom - top);
+				float squareSum = 0.0f;
+				if constexpr (hasSquares) squareSum = windowSum(squares.Row(top), squares.Row(bottom), left, right);
+				out[x] = decide(static_cast<float>(in[x]), windowSum(sTop, sBottom, left, right), squareSum, static_cast<float>(area)) ? 255 : 0;
+			}
+		}
+	}
+}
+
+int NativeEngine::AdaptiveWindowSize(const BinarizationOptions& options, int width, int height) {
+	const int size = options.windowSize > 0 ? options.windowSize : std::max(15, std::min(width, height) / 8);
+	return size | 1;
+}
+
+void NativeEngine::AdaptiveThreshold(const unsigned char* gray, unsigned char* binary, int width, int height,
+	const BinarizationOptions& options, ScratchPool& scratch)
+{
+	if (gray == nullptr || binary == nullptr || width <= 0 || height <= 0) return;
+
+	const bool sauvola = options.method == BinarizationMethod::Sauvola;
+	IntegralImage integral(scratch);
+	integral.Build(gray, width, height, sauvola);
+
+	const int radius = AdaptiveWindowSize(options, width, height) / 2;
+	if (sauvola) {
+		const float k = options.k;
+		const float inverseRange = 1.0f / options.dynamicRange;
+		integral.Visit([&](const auto& sum, const auto& squares) {
+			thresholdRows(gray, binary, width, height, radius, sum, squares,
+				[=](float value, float total, float squareTotal, float area) {
+					const float mean = total / area;
+					const float variance = std::max(0.0f, squareTotal / area - mean * mean);
+					return value > mean * (1.0f + k * (std::sqrt(variance) * inverseRange - 1.0f));
+				});
+		});
+	}
+	else {
+		const float scale = 1.0f - options.sensitivity;
+		integral.VisitSum([&](const auto& sum) {
+			thresholdRows(gray, binary, width, height, radius, sum, nullptr,
+				[=](float value, float total, float, float area) { return value * area > total * scale; });
+		});
+	}
+}
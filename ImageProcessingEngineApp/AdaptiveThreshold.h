@@ -0,0 +1,31 @@
+﻿#pragma once
+
+#include "ScratchPool.h"
+
+namespace NativeEngine {
+	// 이진화 방식 (결과는 휘도 기준 0/255)
+	enum class BinarizationMethod {
+		Otsu,    // 전역 Otsu 임계값 (기존 기본값)
+		Fixed,   // 전역 고정 임계값 (threshold)
+		Bradley, // 창 평균보다 sensitivity 비율 이상 어두우면 0
+		Sauvola  // 창 평균 * (1 + k * (표준편차 / dynamicRange - 1)) 이하면 0
+	};
+
+	struct BinarizationOptions {
+		BinarizationMethod method = BinarizationMethod::Otsu;
+		int threshold = 128;         // Fixed: 이 값보다 크면 255
+		int windowSize = 0;          // Bradley/Sauvola 창 한 변 (홀수로 올림), 0이면 짧은 변의 1/8 (최소 15)
+		float sensitivity = 0.15f;   // Bradley
+		float k = 0.34f;             // Sauvola
+		float dynamicRange = 128.0f; // Sauvola 표준편차 기준
+	};
+
+	// 창 크기 정리 (0 -> 기본값, 짝수 -> 홀수)
+	int AdaptiveWindowSize(const BinarizationOptions& options, int width, int height);
+
+	// 국소 임계값 이진화 (Bradley/Sauvola), gray와 binary는 width * height, 같은 버퍼여도 됨
+	// 휘도와 휘도 제곱의 적분 영상(IntegralImage)에서 창 합은 모서리 네 개로 -> 픽셀당 비용이 창 크기와 무관
+	// 창은 이미지 안쪽만 셈 (가장자리는 창이 작아짐)
+	void AdaptiveThreshold(const unsigned char* gray, unsigned char* binary, int width, int height,
+		const BinarizationOptions& options, ScratchPool& scratch);
+}
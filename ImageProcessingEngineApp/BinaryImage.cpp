@@ -0,0 +1,241 @@
+﻿#include <omp.h>
+#include <algorithm>
+#include <cstring>
+#include "BinaryImage.h"
+#include "GrayPlane.h"
+#include "Morphology.h"
+#include "Simd.h"
+
+namespace {
+	using NativeEngine::BinaryImage;
+	using NativeEngine::ScratchBuffer;
+	using NativeEngine::ScratchPool;
+	using Word = BinaryImage::Word;
+	constexpr int wordBits = BinaryImage::wordBits;
+
+	struct OrOp {
+		static constexpr Word neutral = 0;
+		static Word Apply(Word a, Word b) { return a | b; }
+	};
+
+	struct AndOp {
+		static constexpr Word neutral = ~Word(0);
+		static Word Apply(Word a, Word b) { return a & b; }
+	};
+
+	// gray[x] >= threshold 비트 64개
+	Word packWord(const unsigned char* gray, int count, int threshold) {
+		Word bits = 0;
+		int x = 0;
+#ifdef ENGINE_SSE2
+		// 부호 없는 비교: max(v, t) == v
+		const __m128i t = _mm_set1_epi8(static_cast<char>(threshold));
+		for (; x + 16 <= count; x += 16) {
+			const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(gray + x));
+			const unsigned int mask = static_cast<unsigned int>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(v, t), v)));
+			bits |= static_cast<Word>(mask) << x;
+		}
+#endif
+		for (; x < count; x++) {
+			if (gray[x] >= threshold) bits |= Word(1) << x;
+		}
+		return bits;
+	}
+
+	// dst 비트 x = src 비트 x + shift (shift < 0이면 왼쪽에서 가져옴), 범위 밖은 fill
+	void shiftRow(const Word* src, Word* dst, int words, int shift, Word fill) {
+		const bool right = shift >= 0;
+		const int distance = right ? shift : -shift;
+		const int wordShift = distance / wordBits;
+		const int bitShift = distance % wordBits;
+		auto at = [&](int w) { return (w < 0 || w >= words) ? fill : src[w]; };
+
+		for (int w = 0; w < words; w++) {
+			if (right) {
+				const Word lo = at(w + wordShift);
+				dst[w] = bitShift == 0 ? lo : (lo >> bitShift) | (at(w + wordShift + 1) << (wordBits - bitShift));
+			}
+			else {
+				const Word hi = at(w - wordShift);
+				dst[w] = bitShift == 0 ? hi : (hi << bitShift) | (at(w - wordShift - 1) >> (wordBits - bitShift));
+			}
+		}
+	}
+
+	// run 비트 x = Op(row 비트 x, x + step, ..., x + (length - 1) * step), step은 +1 / -1
+	// 길이를 두 배씩 늘리고 마지막에 겹치게 한 번 더 (OR/AND는 겹쳐도 결과 같음)
+	template <class Op>
+	void windowRun(const Word* row, Word* run, Word* shifted, int words, int length, int step) {
+		memcpy(run, row, static_cast<size_t>(words) * sizeof(Word));
+		int covered = 1;
+		while (covered < length) {
+			const int add = std::min(covered, length - covered);
+			shiftRow(run, shifted, words, add * step, Op::neutral);
+			for (int w = 0; w < words; w++) run[w] = Op::Apply(run[w], shifted[w]);
+			covered += add;
+		}
+	}
+
+	template <class Op>
+	void binaryRows(const BinaryImage& src, Word* dst, int kernelWidth, int anchor, ScratchPool& scratch) {
+		const int words = src.wordsPerRow;
+		const Word tail = src.TailMask();
+
+#pragma omp parallel
+		{
+			ScratchBuffer<Word> buffer(scratch, static_cast<size_t>(words) * 4);
+			Word* row = buffer.data();
+			Word* right = row + words;
+			Word* left = right + words;
+			Word* shifted = left + words;
+
+#pragma omp for schedule(static)
+			for (int y = 0; y < src.height; y++) {
+				// 폭 밖 비트도 이미지 밖으로 취급
+				memcpy(row, src.Row(y), static_cast<size_t>(words) * sizeof(Word));
+				row[words - 1] = (row[words - 1] & tail) | (Op::neutral & ~tail);
+
+				// 창 [x - anchor, x + kernelWidth - 1 - anchor] = 오른쪽 [x, ...] + 왼쪽 [..., x]
+				windowRun<Op>(row, right, shifted, words, kernelWidth - anchor, 1);
+				windowRun<Op>(row, left, shifted, words, anchor + 1, -1);
+				Word* out = dst + static_cast<size_t>(y) * words;
+				for (int w = 0; w < words; w++) out[w] = Op::Apply(right[w], left[w]);
+			}
+		}
+	}
+
+	// 세로 van Herk/Gil-Werman, 워드 하나가 열 64개 (MorphologyColumns와 같은 구간 나눔)
+	template <class Op>
+	void binaryColumns(const Word* src, BinaryImage& dst, int kernelHeight, int anchor, ScratchPool& scratch) {
+		const int words = dst.wordsPerRow;
+		const int height = dst.height;
+		const int segments = (height + kernelHeight - 1) / kernelHeight;
+
+#pragma omp parallel
+		{
+			ScratchBuffer<Word> buffer(scratch, static_cast<size_t>(words) * (kernelHeight * 2 + 1));
+			Word* backward = buffer.data();
+			Word* forward = backward + static_cast<size_t>(words) * kernelHeight;
+			Word* outside = forward + static_cast<size_t>(words) * kernelHeight;
+			std::fill(outside, outside + words, Op::neutral);
+
+			auto row = [&](int i) -> const Word* {
+				const int y = i - anchor;
+				return (y < 0 || y >= height) ? outside : src + static_cast<size_t>(y) * words;
+			};
+			auto lane = [&](Word* base, int j) { return base + static_cast<size_t>(j) * words; };
+
+#pragma omp for schedule(static)
+			for (int segment = 0; segment < segments; segment++) {
+				const int s = segment * kernelHeight;
+				memcpy(lane(backward, kernelHeight - 1), row(s + kernelHeight - 1), static_cast<size_t>(words) * sizeof(Word));
+				for (int j = kernelHeight - 2; j >= 0; j--) {
+					const Word* in = row(s + j);
+					const Word* next = lane(backward, j + 1);
+					Word* cur = lane(backward, j);
+					for (int w = 0; w < words; w++) cur[w] = Op::Apply(next[w], in[w]);
+				}
+
+				const int rows = std::min(kernelHeight, height - s);
+				if (rows > 1) {
+					memcpy(forward, row(s + kernelHeight), static_cast<size_t>(words) * sizeof(Word));
+					for (int j = 1; j < rows - 1; j++) {
+						const Word* in = row(s + kernelHeight + j);
+						const Word* prev = lane(forward, j - 1);
+						Word* cur = lane(forward, j);
+						for (int w = 0; w < words; w++) cur[w] = Op::Apply(prev[w], in[w]);
+					}
+				}
+
+				memcpy(dst.Row(s), backward, static_cast<size_t>(words) * sizeof(Word));
+				for (int j = 1; j < rows; j++) {
+					const Word* b = lane(backward, j);
+					const Word* f = lane(forward, j - 1);
+					Word* out = dst.Row(s + j);
+					for (int w = 0; w < words; w++) out[w] = Op::Apply(b[w], f[w]);
+				}
+			}
+		}
+	}
+
+	template <class Op>
+	// reflected: 뒤집은 구조 요소 (MorphologyReflectedAnchor, 열림/닫힘 두 번째 연산)
+	void binaryMorphology(const BinaryImage& src, BinaryImage& dst, int kernelWidth, int kernelHeight, bool reflected, ScratchPool& scratch) {
+		kernelWidth = std::max(kernelWidth, 1);
+		kernelHeight = std::max(kernelHeight, 1);
+		auto anchor = [reflected](int kernelSize) {
+			return reflected ? NativeEngine::MorphologyReflectedAnchor(kernelSize) : NativeEngine::MorphologyAnchor(kernelSize);
+		};
+		if (src.words.empty()) {
+			dst.Resize(src.width, src.height);
+			return;
+		}
+
+		// 가로 결과를 임시 버퍼에 받아 두므로 src와 dst가 같아도 됨
+		ScratchBuffer<Word> temp(scratch, src.words.size());
+		binaryRows<Op>(src, temp.data(), kernelWidth, anchor(kernelWidth), scratch);
+		const Word tail = src.TailMask();
+		if (&dst != &src) dst.Resize(src.width, src.height);
+		binaryColumns<Op>(temp.data(), dst, kernelHeight, anchor(kernelHeight), scratch);
+
+#pragma omp parallel for schedule(static)
+		for (int y = 0; y < dst.height; y++) dst.Row(y)[dst.wordsPerRow - 1] &= tail;
+	}
+}
+
+void NativeEngine::PackBinary(const ImageView& image, BinaryImage& binary, int threshold) {
+	binary.Resize(image.width, image.height);
+	if (!image.IsValid()) return;
+
+	const int width = image.width;
+	const int words = binary.wordsPerRow;
+	threshold = std::clamp(threshold, 0, 255);
+
+#pragma omp parallel for schedule(static)
+	for (int y = 0; y < image.height; y++) {
+		BinaryImage::Word* out = binary.Row(y);
+		for (int w = 0; w < words; w++) {
+			// 한 워드 분량씩 휘도로 바꿔서 바로 묶음 (스택 버퍼)
+			unsigned char gray[wordBits];
+			const int x0 = w * wordBits;
+			const int count = std::min(wordBits, width - x0);
+			ConvertRowToGray(image.Pixel(x0, y), gray, count, image.layout);
+			out[w] = packWord(gray, count, threshold);
+		}
+	}
+}
+
+void NativeEngine::UnpackBinary(const BinaryImage& binary, const ImageView& image) {
+	if (!image.IsValid() || binary.width != image.width || binary.height != image.height) return;
+
+	const int channels = 4;
+#pragma omp parallel for schedule(static)
+	for (int y = 0; y < image.height; y++) {
+		const BinaryImage::Word* in = binary.Row(y);
+		unsigned char* row = image.Row(y);
+		for (int x = 0; x < image.width; x++) {
+			const unsigned char v = ((in[x / wordBits] >> (x % wordBits)) & 1) ? 255 : 0;
+			row[x * channels + 0] = v;
+			row[x * channels + 1] = v;
+			row[x * channels + 2] = v;
+		}
+	}
+}
+
+void NativeEngine::BinaryDilate(const BinaryImage& src, BinaryImage& dst, int kernelWidth, int kernelHeight, ScratchPool& scratch) {
+	binaryMorphology<OrOp>(src, dst, kernelWidth, kernelHeight, false, scratch);
+}
+
+void NativeEngine::BinaryErode(const BinaryImage& src, BinaryImage& dst, int kernelWidth, int kernelHeight, ScratchPool& scratch) {
+	binaryMorphology<AndOp>(src, dst, kernelWidth, kernelHeight, false, scratch);
+}
+
+void NativeEngine::BinaryOpen(const BinaryImage& src, BinaryImage& dst, int kernelWidth, int kernelHeight, ScratchPool& scratch) {
+	binaryMorphology<AndOp>(src, dst, kernelWidth, kernelHeight, false, scratch);
+	binaryMorphology<OrOp>(dst, dst, kernelWidth, kernelHeight, true, scratch);
+}
+
+void NativeEngine::BinaryClose(const BinaryImage& src, BinaryImage& dst, int kernelWidth, int kernelHeight, ScratchPool& scratch) {
+	binaryMorphology<OrOp>(src, dst, kernelWidth, kernelHeight, false, scratch);
+	binaryMorphology<AndOp>(dst, dst, kernelWidth, kernelHeight, true, scratch);
+}
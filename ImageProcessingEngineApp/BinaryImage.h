@@ -0,0 +1,60 @@
+﻿#pragma once
+
+#include <vector>
+#include "ImageView.h"
+#include "ScratchPool.h"
+
+namespace NativeEngine {
+	// 1비트 이진 이미지 (워드 하나에 가로 64픽셀, 비트 i = 픽셀 x % 64 == i)
+	// 이진화 결과를 BGRA 4바이트 대신 1비트로 들고 있으면 형태학 연산 메모리 이동량이 1/32
+	// 각 행 마지막 워드의 폭 밖 비트는 항상 0
+	struct BinaryImage {
+		using Word = unsigned long long;
+		static constexpr int wordBits = 64;
+
+		int width = 0;
+		int height = 0;
+		int wordsPerRow = 0;
+		std::vector<Word> words;
+
+		BinaryImage() = default;
+		BinaryImage(int width, int height) { Resize(width, height); }
+
+		void Resize(int w, int h) {
+			width = w;
+			height = h;
+			wordsPerRow = (w + wordBits - 1) / wordBits;
+			words.assign(static_cast<size_t>(wordsPerRow) * h, 0);
+		}
+
+		Word* Row(int y) { return words.data() + static_cast<size_t>(y) * wordsPerRow; }
+		const Word* Row(int y) const { return words.data() + static_cast<size_t>(y) * wordsPerRow; }
+
+		bool Get(int x, int y) const { return (Row(y)[x / wordBits] >> (x % wordBits)) & 1; }
+		void Set(int x, int y, bool on) {
+			const Word bit = Word(1) << (x % wordBits);
+			Word& w = Row(y)[x / wordBits];
+			w = on ? (w | bit) : (w & ~bit);
+		}
+
+		// 마지막 워드에서 이미지 안쪽 비트
+		Word TailMask() const {
+			const int used = width % wordBits;
+			return used == 0 ? ~Word(0) : (Word(1) << used) - 1;
+		}
+	};
+
+	// BGRA -> 1비트 (휘도 >= threshold면 1), 행 병렬, 16픽셀씩 비교 후 movemask로 묶음
+	void PackBinary(const ImageView& image, BinaryImage& binary, int threshold = 128);
+	// 1비트 -> BGRA (1 = 255, 0 = 0), 알파는 그대로, binary와 image 크기가 같아야 함
+	void UnpackBinary(const BinaryImage& binary, const ImageView& image);
+
+	// kernelWidth x kernelHeight 직사각형 구조 요소 (창 위치는 MorphologyAnchor와 같음)
+	// 가로는 워드 단위 시프트 + OR/AND를 두 배씩 늘려 가며 log(커널) 번, 세로는 van Herk/Gil-Werman
+	// 이미지 밖은 결과에 영향 없는 값, src와 dst가 같아도 됨
+	void BinaryDilate(const BinaryImage& src, BinaryImage& dst, int kernelWidth, int kernelHeight, ScratchPool& scratch);
+	void BinaryErode(const BinaryImage& src, BinaryImage& dst, int kernelWidth, int kernelHeight, ScratchPool& scratch);
+	// 열림 = 침식 후 팽창, 닫힘 = 팽창 후 침식 (두 번째 연산은 뒤집은 구조 요소라 짝수 크기에서도 열림 <= 원본 <= 닫힘)
+	void BinaryOpen(const BinaryImage& src, BinaryImage& dst, int kernelWidth, int kernelHeight, ScratchPool& scratch);
+	void BinaryClose(const BinaryImage& src, BinaryImage& dst, int kernelWidth, int kernelHeight, ScratchPool& scratch);
+}
@@ -0,0 +1,372 @@
+﻿#include <omp.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include "CannyFilter.h"
+#include "GrayPlane.h"
+#include "Simd.h"
+
+using namespace std;
+
+namespace {
+	using NativeEngine::GradientDirection;
+
+	// 에지 평면 값 (히스테리시스 전)
+	constexpr unsigned char edgeNone = 0;
+	constexpr unsigned char edgeWeak = 1;
+	constexpr unsigned char edgeStrong = 2;
+
+	// 블러 탭 고정소수점 (합 1 << blurShift), 누적이 255 * 256 + 128 이하라 16비트 레인에서 넘치지 않음
+	constexpr int blurShift = 8;
+
+	// 대칭 탭 [0..radius], sigma <= 0이면 { 1 << blurShift }
+	std::vector<int> blurTaps(float sigma) {
+		if (!(sigma > 0.0f)) return { 1 << blurShift };
+
+		const int radius = std::clamp(static_cast<int>(std::ceil(3.0f * sigma)), 1, NativeEngine::cannyMaxBlurRadius);
+		std::vector<double> weights(radius + 1);
+		double sum = 0.0;
+		for (int i = 0; i <= radius; i++) {
+			weights[i] = std::exp(-0.5 * i * i / (static_cast<double>(sigma) * sigma));
+			sum += i == 0 ? weights[i] : 2.0 * weights[i];
+		}
+
+		// 반올림 오차는 가운데 탭에 몰아서 합을 정확히 맞춤
+		std::vector<int> taps(radius + 1);
+		int total = 0;
+		for (int i = 1; i <= radius; i++) {
+			taps[i] = static_cast<int>(std::lround(weights[i] / sum * (1 << blurShift)));
+			total += 2 * taps[i];
+		}
+		taps[0] = (1 << blurShift) - total;
+		return taps;
+	}
+
+	// 블러 한 줄: out[x] = taps[0] * center[x] + sum taps[i] * (lower[i][x] + upper[i][x])
+	// 가로 패스는 lower[i] = center - i, 세로 패스는 lower[i] = 위로 i번째 행
+	struct BlurLine {
+		const unsigned char* center;
+		const unsigned char* lower[NativeEngine::cannyMaxBlurRadius + 1];
+		const unsigned char* upper[NativeEngine::cannyMaxBlurRadius + 1];
+		const int* taps;
+		int radius;
+	};
+
+	int blurLineScalar(const BlurLine& line, unsigned char* out, int x, int width) {
+		const int half = 1 << (blurShift - 1);
+		for (; x < width; x++) {
+			int acc = line.taps[0] * line.center[x];
+			for (int i = 1; i <= line.radius; i++) acc += line.taps[i] * (line.lower[i][x] + line.upper[i][x]);
+			out[x] = static_cast<unsigned char>((acc + half) >> blurShift);
+		}
+		return x;
+	}
+
+	// 비최대 억제 한 픽셀 (up/mid/down: 크기 행, dir: 가운데 행 방향)
+	// 한쪽은 >, 다른 쪽은 >= 로 비교해서 크기가 같은 평탄한 에지도 한 픽셀만 남김
+	inline unsigned char suppressPixel(const short* up, const short* mid, const short* down, unsigned char dir,
+		int x, int low, int high)
+	{
+		const int m = mid[x];
+		if (m <= low) return edgeNone;
+
+		int before, after;
+		switch (static_cast<GradientDirection>(dir)) {
+		case GradientDirection::Horizontal: before = mid[x - 1]; after = mid[x + 1]; break;
+		case GradientDirection::DiagonalDown: before = up[x - 1]; after = down[x + 1]; break;
+		case GradientDirection::Vertical: before = up[x]; after = down[x]; break;
+		default: before = up[x + 1]; after = down[x - 1]; break;
+		}
+		return (m > before && m >= after) ? (m > high ? edgeStrong : edgeWeak) : edgeNone;
+	}
+}
+
+#ifdef ENGINE_SSE2
+namespace {
+	// 16비트 레인 하나에 픽셀 하나 (SSE2 8픽셀, AVX2 16픽셀)
+	int blurLineSse2(const BlurLine& line, unsigned char* out, int x, int width) {
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i half = _mm_set1_epi16(1 << (blurShift - 1));
+		auto load = [&](const unsigned char* p) { return _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)), zero); };
+		for (; x + 8 <= width; x += 8) {
+			__m128i acc = _mm_mullo_epi16(load(line.center + x), _mm_set1_epi16(static_cast<short>(line.taps[0])));
+			for (int i = 1; i <= line.radius; i++) {
+				const __m128i pair = _mm_add_epi16(load(line.lower[i] + x), load(line.upper[i] + x));
+				acc = _mm_add_epi16(acc, _mm_mullo_epi16(pair, _mm_set1_epi16(static_cast<short>(line.taps[i]))));
+			}
+			const __m128i result = _mm_srli_epi16(_mm_add_epi16(acc, half), blurShift);
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(out + x), _mm_packus_epi16(result, result));
+		}
+		return x;
+	}
+
+	ENGINE_TARGET_AVX2 int blurLineAvx2(const BlurLine& line, unsigned char* out, int x, int width) {
+		const __m256i half = _mm256_set1_epi16(1 << (blurShift - 1));
+		for (; x + 16 <= width; x += 16) {
+			__m256i acc = _mm256_mullo_epi16(
+				_mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(line.center + x))),
+				_mm256_set1_epi16(static_cast<short>(line.taps[0])));
+			for (int i = 1; i <= line.radius; i++) {
+				const __m256i lower = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(line.lower[i] + x)));
+				const __m256i upper = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(line.upper[i] + x)));
+				acc = _mm256_add_epi16(acc, _mm256_mullo_epi16(_mm256_add_epi16(lower, upper),
+					_mm256_set1_epi16(static_cast<short>(line.taps[i]))));
+			}
+			const __m256i result = _mm256_srli_epi16(_mm256_add_epi16(acc, half), blurShift);
+			const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(result, result), 0x08);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + x), _mm256_castsi256_si128(packed));
+		}
+		return x;
+	}
+
+	// 비최대 억제 8픽셀씩, 방향별 이웃을 모두 읽고 마스크로 선택 (suppressPixel과 같은 판정)
+	// 결과 분류는 keep(1) + strong(1) = 0 / 1 / 2
+	int suppressRowSse2(const short* up, const short* mid, const short* down, const unsigned char* dir,
+		unsigned char* out, int x, int width, int low, int high)
+	{
+		auto load = [](const short* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); };
+		auto select = [](__m128i mask, __m128i a, __m128i b) { return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b)); };
+		const __m128i lowV = _mm_set1_epi16(static_cast<short>(std::clamp(low, -32768, 32767)));
+		const __m128i highV = _mm_set1_epi16(static_cast<short>(std::clamp(high, -32768, 32767)));
+		const __m128i one = _mm_set1_epi16(1);
+
+		for (; x + 8 < width; x += 8) {
+			const __m128i d = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(dir + x)), _mm_setzero_si128());
+			const __m128i isH = _mm_cmpeq_epi16(d, _mm_set1_epi16(static_cast<short>(GradientDirection::Horizontal)));
+			const __m128i isDD = _mm_cmpeq_epi16(d, _mm_set1_epi16(static_cast<short>(GradientDirection::DiagonalDown)));
+			const __m128i isV = _mm_cmpeq_epi16(d, _mm_set1_epi16(static_cast<short>(GradientDirection::Vertical)));
+
+			const __m128i m = load(mid + x);
+			__m128i before = load(up + x + 1);
+			before = select(isV, load(up + x), before);
+			before = select(isDD, load(up + x - 1), before);
+			before = select(isH, load(mid + x - 1), before);
+			__m128i after = load(down + x - 1);
+			after = select(isV, load(down + x), after);
+			after = select(isDD, load(down + x + 1), after);
+			after = select(isH, load(mid + x + 1), after);
+
+			const __m128i keep = _mm_andnot_si128(_mm_cmpgt_epi16(after, m),
+				_mm_and_si128(_mm_cmpgt_epi16(m, before), _mm_cmpgt_epi16(m, lowV)));
+			const __m128i strong = _mm_and_si128(keep, _mm_cmpgt_epi16(m, highV));
+			const __m128i result = _mm_add_epi16(_mm_and_si128(keep, one), _mm_and_si128(strong, one));
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(out + x), _mm_packus_epi16(result, result));
+		}
+		return x;
+	}
+}
+#endif
+
+namespace {
+	void blurLine(const BlurLine& line, unsigned char* out, int width, bool avx2) {
+		int x = 0;
+#ifdef ENGINE_SSE2
+		if (avx2) x = blurLineAvx2(line, out, x, width);
+		x = blurLineSse2(line, out, x, width);
+#else
+		(void)avx2;
+#endif
+		blurLineScalar(line, out, x, width);
+	}
+
+	// 가로 블러, padded는 좌우로 radius 픽셀 복제된 행 (padded[radius + x] = 원본 x)
+	void blurRow(const unsigned char* padded, unsigned char* out, int width, const std::vector<int>& taps, bool avx2) {
+		BlurLine line;
+		line.radius = static_cast<int>(taps.size()) - 1;
+		line.taps = taps.data();
+		line.center = padded + line.radius;
+		for (int i = 1; i <= line.radius; i++) {
+			line.lower[i] = line.center - i;
+			line.upper[i] = line.center + i;
+		}
+		blurLine(line, out, width, avx2);
+	}
+
+	// 세로 블러, rows(j)는 가운데 기준 j번째 행 (-radius..radius)
+	template <typename Rows>
+	void blurColumn(Rows&& rows, unsigned char* out, int width, const std::vector<int>& taps, bool avx2) {
+		BlurLine line;
+		line.radius = static_cast<int>(taps.size()) - 1;
+		line.taps = taps.data();
+		line.center = rows(0);
+		for (int i = 1; i <= line.radius; i++) {
+			line.lower[i] = rows(-i);
+			line.upper[i] = rows(i);
+		}
+		blurLine(line, out, width, avx2);
+	}
+
+	void suppressRow(const short* up, const short* mid, const short* down, const unsigned char* dir,
+		unsigned char* out, int width, int low, int high)
+	{
+		out[0] = edgeNone;
+		out[width - 1] = edgeNone;
+		int x = 1;
+#ifdef ENGINE_SSE2
+		x = suppressRowSse2(up, mid, down, dir, out, x, width, low, high);
+#endif
+		for (; x < width - 1; x++) out[x] = suppressPixel(up, mid, down, dir[x], x, low, high);
+	}
+
+	// 행 [y0, y1) 안에서만 강한 에지를 약한 이웃(8방향)으로 번짐
+	void flood(unsigned char* edges, int width, int y0, int y1, std::vector<int>& stack) {
+		while (!stack.empty()) {
+			const int p = stack.back();
+			stack.pop_back();
+			const int y = p / width;
+			const int x = p - y * width;
+			const int ya = std::max(y0, y - 1), yb = std::min(y1 - 1, y + 1);
+			const int xa = std::max(0, x - 1), xb = std::min(width - 1, x + 1);
+			for (int ny = ya; ny <= yb; ny++) {
+				for (int nx = xa; nx <= xb; nx++) {
+					const int q = ny * width + nx;
+					if (edges[q] == edgeWeak) {
+						edges[q] = edgeStrong;
+						stack.push_back(q);
+					}
+				}
+			}
+		}
+	}
+
+	// 띠 경계 행 y의 약한 에지 중 이웃 띠 행 ny에 강한 이웃이 있는 것 (읽기만)
+	void collectSeeds(const unsigned char* edges, int width, int y, int ny, std::vector<int>& seeds) {
+		const unsigned char* row = edges + static_cast<size_t>(y) * width;
+		const unsigned char* other = edges + static_cast<size_t>(ny) * width;
+		for (int x = 0; x < width; x++) {
+			if (row[x] != edgeWeak) continue;
+			const int xa = std::max(0, x - 1), xb = std::min(width - 1, x + 1);
+			for (int nx = xa; nx <= xb; nx++) {
+				if (other[nx] == edgeStrong) {
+					seeds.push_back(y * width + x);
+					break;
+				}
+			}
+		}
+	}
+}
+
+void NativeEngine::CannyFilter(const ImageView& image, const unsigned char* gray, unsigned char* edges,
+	float sigma, int lowThreshold, int highThreshold, GradientNorm norm, ScratchPool& scratch)
+{
+	const int width = image.width;
+	const int height = image.height;
+	const int low = std::min(lowThreshold, highThreshold);
+	const int high = std::max(lowThreshold, highThreshold);
+	const std::vector<int> taps = blurTaps(sigma);
+	const int radius = static_cast<int>(taps.size()) - 1;
+	const int hRows = 2 * radius + 1;
+	const bool avx2 = CpuHasAvx2();
+
+	auto fetch = [&](int y, unsigned char* dst) {
+		if (gray) memcpy(dst, gray + static_cast<size_t>(y) * width, width);
+		else ConvertRowToGray(image.Row(y), dst, width, image.layout);
+	};
+
+	// 히스테리시스 라운드마다 찾은 씨앗 수 (짝/홀 라운드 번갈아 사용)
+	int seedCounts[2] = { 0, 0 };
+
+#pragma omp parallel
+	{
+		const int threads = omp_get_num_threads();
+		const int strip = (height + threads - 1) / threads;
+		const int y0 = std::min(height, omp_get_thread_num() * strip);
+		const int y1 = std::min(height, y0 + strip);
+
+		// 가로 블러 링 (2 * radius + 1행), 세로 블러 / 크기 / 방향 링 (3행)
+		ScratchBuffer<unsigned char> padded(scratch, static_cast<size_t>(width) + 2 * radius);
+		ScratchBuffer<unsigned char> hRing(scratch, static_cast<size_t>(width) * hRows);
+		ScratchBuffer<unsigned char> bRing(scratch, static_cast<size_t>(width) * 3);
+		ScratchBuffer<short> mRing(scratch, static_cast<size_t>(width) * 3);
+		ScratchBuffer<unsigned char> dRing(scratch, static_cast<size_t>(width) * 3);
+
+		auto slot = [](int y, int count) { return ((y % count) + count) % count; };
+		auto hLine = [&](int y) { return hRing.data() + static_cast<size_t>(slot(y, hRows)) * width; };
+		auto bLine = [&](int y) { return bRing.data() + static_cast<size_t>(slot(y, 3)) * width; };
+		auto mLine = [&](int y) { return mRing.data() + static_cast<size_t>(slot(y, 3)) * width; };
+		auto dLine = [&](int y) { return dRing.data() + static_cast<size_t>(slot(y, 3)) * width; };
+
+		// 1~3단계: 결과 행 [y0, y1)에 필요한 크기 행 [y0 - 1, y1], 블러 행 [y0 - 2, y1 + 1]
+		if (y0 < y1) {
+			// 가로 블러 행 yy (이미지 밖은 가장자리 복제)
+			auto pushRow = [&](int yy) {
+				unsigned char* p = padded.data();
+				fetch(std::clamp(yy, 0, height - 1), p + radius);
+				memset(p, p[radius], radius);
+				memset(p + radius + width, p[radius + width - 1], radius);
+				blurRow(p, hLine(yy), width, taps, avx2);
+			};
+
+			int nextRow = std::max(0, y0 - 2) - radius;
+			int nextBlur = std::max(0, y0 - 2);
+			auto blurUpTo = [&](int y) {
+				for (; nextBlur <= y; nextBlur++) {
+					for (; nextRow <= nextBlur + radius; nextRow++) pushRow(nextRow);
+					const int center = nextBlur;
+					blurColumn([&](int j) -> const unsigned char* { return hLine(center + j); },
+						bLine(center), width, taps, avx2);
+				}
+			};
+
+			for (int ym = std::max(0, y0 - 1); ym <= std::min(height - 1, y1); ym++) {
+				if (ym == 0 || ym == height - 1) {
+					memset(mLine(ym), 0, sizeof(short) * width);
+					memset(dLine(ym), 0, width);
+				}
+				else {
+					blurUpTo(ym + 1);
+					SobelRow(bLine(ym - 1), bLine(ym), bLine(ym + 1), mLine(ym), dLine(ym), width, norm);
+				}
+
+				const int y = ym - 1;
+				if (y < y0) continue;
+				unsigned char* out = edges + static_cast<size_t>(y) * width;
+				if (y == 0) memset(out, edgeNone, width);
+				else suppressRow(mLine(y - 1), mLine(y), mLine(y + 1), dLine(y), out, width, low, high);
+			}
+			if (y1 == height) memset(edges + static_cast<size_t>(height - 1) * width, edgeNone, width);
+		}
+#pragma omp barrier
+
+		// 4단계: 띠 안에서 먼저 번지고, 경계를 넘는 연결은 라운드마다 이어 받음
+		std::vector<int> stack;
+		for (int y = y0; y < y1; y++) {
+			const unsigned char* row = edges + static_cast<size_t>(y) * width;
+			for (int x = 0; x < width; x++) {
+				if (row[x] == edgeStrong) stack.push_back(y * width + x);
+			}
+		}
+		flood(edges, width, y0, y1, stack);
+
+		for (int round = 0; ; round++) {
+#pragma omp barrier
+			// 이웃 띠는 이 단계에서 읽기만 하므로 경계 행을 안전하게 비교
+			std::vector<int> seeds;
+			if (y0 < y1) {
+				if (y0 > 0) collectSeeds(edges, width, y0, y0 - 1, seeds);
+				if (y1 < height) collectSeeds(edges, width, y1 - 1, y1, seeds);
+			}
+#pragma omp atomic
+			seedCounts[round & 1] += static_cast<int>(seeds.size());
+#pragma omp barrier
+			const int found = seedCounts[round & 1];
+			if (omp_get_thread_num() == 0) seedCounts[(round + 1) & 1] = 0;
+			if (found == 0) break;
+
+			for (int p : seeds) {
+				if (edges[p] == edgeWeak) {
+					edges[p] = edgeStrong;
+					stack.push_back(p);
+				}
+			}
+			flood(edges, width, y0, y1, stack);
+		}
+
+		for (int y = y0; y < y1; y++) {
+			unsigned char* row = edges + static_cast<size_t>(y) * width;
+			for (int x = 0; x < width; x++) row[x] = row[x] == edgeStrong ? 255 : 0;
+			WriteGrayRow(row, image.Row(y), width);
+		}
+	}
+}
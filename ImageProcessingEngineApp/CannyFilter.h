@@ -0,0 +1,21 @@
+﻿#pragma once
+
+#include "ImageView.h"
+#include "ScratchPool.h"
+#include "SobelFilter.h"
+
+namespace NativeEngine {
+	// 블러 반경 상한 (ceil(3 * sigma), sigma 8까지)
+	constexpr int cannyMaxBlurRadius = 24;
+
+	// Canny 에지 검출, 결과는 0 / 255
+	// 1~3단계 (가우시안 -> 소벨 크기/방향 -> 비최대 억제)는 스레드별 가로 띠에서 행 단위로 이어서 처리
+	//   블러/크기/방향은 링 버퍼에만 있고, 띠 경계 주변 행은 띠마다 다시 계산 (단계 사이 동기화 없음)
+	// 4단계 히스테리시스: 띠마다 강한 에지에서 약한 에지로 번진 뒤, 띠 경계에서 새로 이어진 곳이 없을 때까지
+	//   경계 씨앗 찾기 -> 띠 안에서 번지기를 반복 (모든 스레드가 같이 진행, 단일 스레드 채우기 없음)
+	// sigma <= 0이면 블러 생략, 임계값은 소벨 크기 단위 (크기 > high: 강한 에지, > low: 약한 에지)
+	// gray: width * height 휘도 평면 (nullptr이면 image에서 행마다 변환)
+	// edges: width * height 결과 평면 (gray와 다른 버퍼), 결과는 image B/G/R에도 씀 (알파 유지)
+	void CannyFilter(const ImageView& image, const unsigned char* gray, unsigned char* edges,
+		float sigma, int lowThreshold, int highThreshold, GradientNorm norm, ScratchPool& scratch);
+}
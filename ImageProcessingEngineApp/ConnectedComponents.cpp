@@ -0,0 +1,235 @@
+﻿#include <omp.h>
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include "ConnectedComponents.h"
+
+using namespace std;
+
+namespace {
+	using namespace NativeEngine;
+
+	// 띠 경계 이후 단계는 다른 스레드의 트리를 읽으므로 원자적 접근 (relaxed라 일반 load/store와 같은 코드)
+	inline int load(int* parent, int i) {
+		return std::atomic_ref<int>(parent[i]).load(std::memory_order_relaxed);
+	}
+
+	inline void store(int* parent, int i, int value) {
+		std::atomic_ref<int>(parent[i]).store(value, std::memory_order_relaxed);
+	}
+
+	// 띠 안 (한 스레드만 만지는 트리), 경로 절반 압축
+	inline int findLocal(int* parent, int i) {
+		while (parent[i] != i) {
+			parent[i] = parent[parent[i]];
+			i = parent[i];
+		}
+		return i;
+	}
+
+	inline void uniteLocal(int* parent, int a, int b) {
+		a = findLocal(parent, a);
+		b = findLocal(parent, b);
+		if (a < b) parent[b] = a;
+		else if (b < a) parent[a] = b;
+	}
+
+	inline int findShared(int* parent, int i) {
+		int next = load(parent, i);
+		while (next != i) {
+			i = next;
+			next = load(parent, i);
+		}
+		return i;
+	}
+
+	// 큰 루트가 아직 루트일 때만 작은 루트에 붙임, 다른 스레드가 먼저 바꿨으면 다시 찾음
+	void uniteShared(int* parent, int a, int b) {
+		while (true) {
+			a = findShared(parent, a);
+			b = findShared(parent, b);
+			if (a == b) return;
+			if (a < b) std::swap(a, b);
+			int expected = a;
+			if (std::atomic_ref<int>(parent[a]).compare_exchange_strong(expected, b, std::memory_order_relaxed)) return;
+		}
+	}
+
+	void atomicMin(int& target, int value) {
+		std::atomic_ref<int> ref(target);
+		int current = ref.load(std::memory_order_relaxed);
+		while (value < current && !ref.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+	}
+
+	void atomicMax(int& target, int value) {
+		std::atomic_ref<int> ref(target);
+		int current = ref.load(std::memory_order_relaxed);
+		while (value > current && !ref.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+	}
+
+	// 요소별 누적 (여러 띠가 같은 요소를 더하므로 원자적)
+	struct BlobSums {
+		long long area = 0;
+		long long sumX = 0;
+		long long sumY = 0;
+		int left = INT_MAX;
+		int top = INT_MAX;
+		int right = -1;
+		int bottom = -1;
+	};
+
+	// 한 행에서 같은 라벨이 이어진 구간 [x0, x1]을 한 번에 반영
+	void addRun(BlobSums& sums, int x0, int x1, int y) {
+		const long long n = x1 - x0 + 1;
+		std::atomic_ref<long long>(sums.area).fetch_add(n, std::memory_order_relaxed);
+		std::atomic_ref<long long>(sums.sumX).fetch_add(n * (x0 + x1) / 2, std::memory_order_relaxed);
+		std::atomic_ref<long long>(sums.sumY).fetch_add(n * y, std::memory_order_relaxed);
+		atomicMin(sums.left, x0);
+		atomicMax(sums.right, x1);
+		atomicMin(sums.top, y);
+		atomicMax(sums.bottom, y);
+	}
+}
+
+int NativeEngine::LabelComponents(const unsigned char* plane, int width, int height, unsigned char threshold, Connectivity connectivity,
+	int* labels, std::vector<Blob>& blobs, ScratchPool& scratch)
+{
+	blobs.clear();
+	if (plane == nullptr || width <= 0 || height <= 0) return 0;
+
+	// 라벨 평면을 union-find 부모 배열로 같이 씀 (배경 -1)
+	const size_t pixelNum = static_cast<size_t>(width) * height;
+	ScratchBuffer<int> parentStorage;
+	if (labels == nullptr) {
+		parentStorage = ScratchBuffer<int>(scratch, pixelNum);
+		labels = parentStorage.data();
+	}
+	int* parent = labels;
+	const bool eight = connectivity == Connectivity::Eight;
+
+	const int maxThreads = omp_get_max_threads();
+	std::vector<int> rootBase(static_cast<size_t>(maxThreads) + 1, 0);
+	std::vector<BlobSums> sums;
+	int count = 0;
+
+#pragma omp parallel
+	{
+		const int threads = omp_get_num_threads();
+		const int thread = omp_get_thread_num();
+		const int strip = (height + threads - 1) / threads;
+		const int y0 = std::min(height, thread * strip);
+		const int y1 = std::min(height, y0 + strip);
+
+		// 1. 띠 안 라벨링 (위 행은 띠 첫 행이면 보지 않음)
+		for (int y = y0; y < y1; y++) {
+			const unsigned char* row = plane + static_cast<size_t>(y) * width;
+			const unsigned char* above = y > y0 ? row - width : nullptr;
+			const int base = y * width;
+			for (int x = 0; x < width; x++) {
+				const int i = base + x;
+				if (row[x] < threshold) {
+					parent[i] = -1;
+					continue;
+				}
+				parent[i] = i;
+				if (x > 0 && row[x - 1] >= threshold) uniteLocal(parent, i, i - 1);
+				if (above) {
+					if (above[x] >= threshold) uniteLocal(parent, i, i - width);
+					else if (eight) {
+						// 바로 위가 전경이면 대각선 이웃은 이미 그 위 픽셀과 같은 요소
+						if (x > 0 && above[x - 1] >= threshold) uniteLocal(parent, i, i - width - 1);
+						if (x + 1 < width && above[x + 1] >= threshold) uniteLocal(parent, i, i - width + 1);
+					}
+				}
+			}
+		}
+#pragma omp barrier
+
+		// 2. 띠 첫 행과 위 띠 마지막 행 잇기
+		if (y0 > 0 && y0 < y1) {
+			const unsigned char* row = plane + static_cast<size_t>(y0) * width;
+			const unsigned char* above = row - width;
+			const int base = y0 * width;
+			for (int x = 0; x < width; x++) {
+				if (row[x] < threshold) continue;
+				const int i = base + x;
+				if (above[x] >= threshold) uniteShared(parent, i, i - width);
+				else if (eight) {
+					if (x > 0 && above[x - 1] >= threshold) uniteShared(parent, i, i - width - 1);
+					if (x + 1 < width && above[x + 1] >= threshold) uniteShared(parent, i, i - width + 1);
+				}
+			}
+		}
+#pragma omp barrier
+
+		// 3. 경로 펴기 + 띠별 루트 수
+		int roots = 0;
+		for (int i = y0 * width; i < y1 * width; i++) {
+			const int p = load(parent, i);
+			if (p < 0) continue;
+			if (p == i) roots++;
+			else store(parent, i, findShared(parent, p));
+		}
+		rootBase[thread + 1] = roots;
+#pragma omp barrier
+
+#pragma omp single
+		{
+			for (int t = 0; t < threads; t++) rootBase[t + 1] += rootBase[t];
+			count = rootBase[threads];
+			sums.assign(count, BlobSums());
+		}
+
+		// 루트 자리에 -(라벨) - 1 (배경 -1과 구분), 래스터 순서라 위 띠 요소가 앞 번호
+		int next = rootBase[thread];
+		for (int i = y0 * width; i < y1 * width; i++) {
+			if (load(parent, i) == i) store(parent, i, -(++next) - 1);
+		}
+#pragma omp barrier
+
+		// 4. 라벨 쓰기 + 행 구간 단위 통계 (루트는 아직 음수로 두고 다음 단계에서 뒤집음)
+		for (int y = y0; y < y1; y++) {
+			int* row = parent + static_cast<size_t>(y) * width;
+			int runLabel = 0;
+			int runStart = 0;
+			for (int x = 0; x <= width; x++) {
+				int label = 0;
+				if (x < width) {
+					const int p = row[x];
+					if (p < -1) label = -p - 1;
+					else if (p >= 0) {
+						label = -load(parent, p) - 1;
+						row[x] = label;
+					}
+					else row[x] = 0;
+				}
+				if (label != runLabel) {
+					if (runLabel > 0) addRun(sums[runLabel - 1], runStart, x - 1, y);
+					runLabel = label;
+					runStart = x;
+				}
+			}
+		}
+#pragma omp barrier
+
+		for (int i = y0 * width; i < y1 * width; i++) {
+			if (parent[i] < 0) parent[i] = -parent[i] - 1;
+		}
+	}
+
+	blobs.resize(count);
+#pragma omp parallel for schedule(static)
+	for (int k = 0; k < count; k++) {
+		const BlobSums& s = sums[k];
+		Blob& blob = blobs[k];
+		blob.label = k + 1;
+		blob.area = static_cast<int>(s.area);
+		blob.left = s.left;
+		blob.top = s.top;
+		blob.right = s.right;
+		blob.bottom = s.bottom;
+		blob.centroidX = static_cast<double>(s.sumX) / static_cast<double>(s.area);
+		blob.centroidY = static_cast<double>(s.sumY) / static_cast<double>(s.area);
+	}
+	return count;
+}
@@ -0,0 +1,32 @@
+﻿#pragma once
+
+#include <vector>
+#include "ScratchPool.h"
+
+namespace NativeEngine {
+	enum class Connectivity {
+		Four, // 상하좌우
+		Eight // 대각선 포함
+	};
+
+	// 연결 요소 하나
+	struct Blob {
+		int label = 0;  // 라벨 평면 값 (1부터, 첫 픽셀의 래스터 순서)
+		int area = 0;   // 픽셀 수
+		int left = 0;   // 경계 상자 (양 끝 포함)
+		int top = 0;
+		int right = 0;
+		int bottom = 0;
+		double centroidX = 0.0;
+		double centroidY = 0.0;
+	};
+
+	// 값 >= threshold인 픽셀의 연결 요소 라벨링 + 요소별 통계, 반환은 요소 수
+	// 1. 스레드 띠마다 띠 안에서만 union-find (루트는 항상 집합의 가장 작은 픽셀 번호)
+	// 2. 띠 경계 행을 위 띠와 잇기 (여러 띠가 같은 트리를 건드리므로 CAS로 큰 루트를 작은 루트에 붙임, 잠금 없음)
+	// 3. 경로를 펴고 루트에 띠별 누적 번호를 매긴 뒤, 같은 패스에서 라벨을 쓰면서 행 구간 단위로 통계 누적
+	// labels: width * height (0 = 배경, 1 ~ 요소 수), nullptr이면 임시 버퍼 (통계만)
+	// blobs: 라벨 순서대로 요소 수만큼
+	int LabelComponents(const unsigned char* plane, int width, int height, unsigned char threshold, Connectivity connectivity,
+		int* labels, std::vector<Blob>& blobs, ScratchPool& scratch);
+}
@@ -0,0 +1,177 @@
+﻿#include <omp.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "DistanceTransform.h"
+#include "SeparableFilter.h"
+
+namespace {
+	using NativeEngine::BinaryImage;
+	using NativeEngine::DistanceTarget;
+	using NativeEngine::ScratchBuffer;
+	using NativeEngine::ScratchPool;
+	using Word = BinaryImage::Word;
+	constexpr int wordBits = BinaryImage::wordBits;
+
+	// 세로 패스 열 묶음 (픽셀), 행마다 1KB 연속 읽기/쓰기
+	constexpr int distanceColumnBlock = 256;
+
+	// 1단계: g[y][x] = 열 x에서 가장 가까운 대상까지 세로 거리 (없으면 infinite)
+	// 아래로 한 번, 위로 한 번 훑고, 한 행 안에서는 열 묶음 전체를 같이 갱신
+	void verticalDistances(const BinaryImage& binary, bool targetBit, unsigned int* g, unsigned int infinite) {
+		const int width = binary.width;
+		const int height = binary.height;
+		const Word flip = targetBit ? Word(0) : ~Word(0);
+
+		NativeEngine::ForEachColumnBlock(width, distanceColumnBlock, [&](int x0, int pixels) {
+			const int x1 = x0 + pixels;
+			for (int y = 0; y < height; y++) {
+				const Word* bits = binary.Row(y);
+				unsigned int* row = g + static_cast<size_t>(y) * width;
+				const unsigned int* above = y > 0 ? row - width : nullptr;
+				for (int x = x0; x < x1; x++) {
+					const bool hit = ((bits[x / wordBits] ^ flip) >> (x % wordBits)) & 1;
+					const unsigned int carried = above ? std::min(above[x] + 1, infinite) : infinite;
+					row[x] = hit ? 0 : carried;
+				}
+			}
+			for (int y = height - 2; y >= 0; y--) {
+				unsigned int* row = g + static_cast<size_t>(y) * width;
+				const unsigned int* below = row + width;
+				for (int x = x0; x < x1; x++) row[x] = std::min(row[x], below[x] + 1);
+			}
+		});
+	}
+
+	// 음수도 아래로 내림하는 나눗셈 (divisor > 0)
+	long long floorDiv(long long value, long long divisor) {
+		const long long q = value / divisor;
+		return (value % divisor != 0 && value < 0) ? q - 1 : q;
+	}
+
+	// 2단계 한 행: d2[x] = min_i (x - i)^2 + g[i]^2
+	// sites: 포락선을 이루는 포물선 꼭짓점, starts: 그 포물선이 최소가 되기 시작하는 x
+	void rowEnvelope(const unsigned int* g, long long* d2, int width, int* sites, int* starts) {
+		auto f = [g](long long x, int i) { return (x - i) * (x - i) + static_cast<long long>(g[i]) * g[i]; };
+		// 포물선 i와 u (i < u)가 만나는 x (이 x 이하는 i가 더 작거나 같음)
+		auto separation = [g](int i, int u) {
+			const long long gi = g[i], gu = g[u];
+			return floorDiv(static_cast<long long>(u) * u - static_cast<long long>(i) * i + gu * gu - gi * gi,
+				2ll * (u - i));
+		};
+
+		int q = 0;
+		sites[0] = 0;
+		starts[0] = 0;
+		for (int u = 1; u < width; u++) {
+			while (q >= 0 && f(starts[q], sites[q]) > f(starts[q], u)) q--;
+			if (q < 0) {
+				q = 0;
+				sites[0] = u;
+			}
+			else {
+				const long long w = 1 + separation(sites[q], u);
+				if (w < width) {
+					q++;
+					sites[q] = u;
+					starts[q] = static_cast<int>(w);
+				}
+			}
+		}
+		for (int u = width - 1; u >= 0; u--) {
+			d2[u] = f(u, sites[q]);
+			if (u == starts[q]) q--;
+		}
+	}
+
+	// 거리 제곱을 행 단위로 store(y, d2, infinite2)에 넘김 (d2 >= infinite2면 대상 없음)
+	template <typename StoreRow>
+	void squaredDistances(const BinaryImage& binary, DistanceTarget target, ScratchPool& scratch, StoreRow&& store) {
+		const int width = binary.width;
+		const int height = binary.height;
+		if (width <= 0 || height <= 0) return;
+
+		// 실제 거리 제곱은 (width - 1)^2 + (height - 1)^2 이하라 (width + height)^2와 겹치지 않음
+		const unsigned int infinite = static_cast<unsigned int>(width) + static_cast<unsigned int>(height);
+		const long long infinite2 = static_cast<long long>(infinite) * infinite;
+
+		ScratchBuffer<unsigned int> g(scratch, static_cast<size_t>(width) * height);
+		verticalDistances(binary, target == DistanceTarget::Foreground, g.data(), infinite);
+
+#pragma omp parallel
+		{
+			ScratchBuffer<int> sites(scratch, width);
+			ScratchBuffer<int> starts(scratch, width);
+			ScratchBuffer<long long> d2(scratch, width);
+
+#pragma omp for schedule(static)
+			for (int y = 0; y < height; y++) {
+				rowEnvelope(g.data() + static_cast<size_t>(y) * width, d2.data(), width, sites.data(), starts.data());
+				store(y, d2.data(), infinite2);
+			}
+		}
+	}
+
+	// 원판 안 = 거리 제곱 <= radius^2 (거리 제곱이 정수라 radius^2 내림과 비교해도 같음)
+	long long diskLimit(float radius) {
+		const double r = std::max(0.0, static_cast<double>(radius));
+		return static_cast<long long>(std::floor(r * r));
+	}
+
+	// dst 비트 = inside(d2) (d2는 target 기준 거리 제곱)
+	template <typename Inside>
+	void thresholdDistances(const BinaryImage& src, BinaryImage& dst, DistanceTarget target, ScratchPool& scratch, Inside inside) {
+		const int width = src.width;
+		const int height = src.height;
+		// src 읽기는 1단계에서 끝나므로 src == dst여도 됨
+		if (&dst != &src) dst.Resize(width, height);
+
+		squaredDistances(src, target, scratch, [&](int y, const long long* d2, long long infinite2) {
+			Word* row = dst.Row(y);
+			for (int w = 0; w < dst.wordsPerRow; w++) {
+				const int x0 = w * wordBits;
+				const int count = std::min(wordBits, width - x0);
+				Word bits = 0;
+				for (int i = 0; i < count; i++) {
+					if (inside(d2[x0 + i], infinite2)) bits |= Word(1) << i;
+				}
+				row[w] = bits;
+			}
+		});
+	}
+}
+
+void NativeEngine::DistanceTransform(const BinaryImage& binary, DistanceTarget target, float* distances, ScratchPool& scratch) {
+	const int width = binary.width;
+	squaredDistances(binary, target, scratch, [&](int y, const long long* d2, long long infinite2) {
+		float* out = distances + static_cast<size_t>(y) * width;
+		for (int x = 0; x < width; x++) {
+			out[x] = d2[x] >= infinite2 ? std::numeric_limits<float>::infinity()
+				: static_cast<float>(std::sqrt(static_cast<double>(d2[x])));
+		}
+	});
+}
+
+void NativeEngine::DistanceTransform(const BinaryImage& binary, DistanceTarget target, unsigned short* distances, ScratchPool& scratch) {
+	const int width = binary.width;
+	const long long saturated = 65535ll * 65535ll;
+	squaredDistances(binary, target, scratch, [&](int y, const long long* d2, long long infinite2) {
+		unsigned short* out = distances + static_cast<size_t>(y) * width;
+		for (int x = 0; x < width; x++) {
+			out[x] = (d2[x] >= infinite2 || d2[x] >= saturated) ? 65535
+				: static_cast<unsigned short>(std::lround(std::sqrt(static_cast<double>(d2[x]))));
+		}
+	});
+}
+
+void NativeEngine::BinaryDilateDisk(const BinaryImage& src, BinaryImage& dst, float radius, ScratchPool& scratch) {
+	const long long limit = diskLimit(radius);
+	thresholdDistances(src, dst, DistanceTarget::Foreground, scratch,
+		[limit](long long d2, long long infinite2) { return d2 < infinite2 && d2 <= limit; });
+}
+
+void NativeEngine::BinaryErodeDisk(const BinaryImage& src, BinaryImage& dst, float radius, ScratchPool& scratch) {
+	const long long limit = diskLimit(radius);
+	thresholdDistances(src, dst, DistanceTarget::Background, scratch,
+		[limit](long long d2, long long) { return d2 > limit; });
+}
@@ -0,0 +1,27 @@
+﻿#pragma once
+
+#include "BinaryImage.h"
+#include "ScratchPool.h"
+
+namespace NativeEngine {
+	// 거리를 잴 대상 픽셀
+	enum class DistanceTarget {
+		Background, // 가장 가까운 0 픽셀까지 (전경 안쪽 깊이, 0 픽셀 자신은 0)
+		Foreground  // 가장 가까운 1 픽셀까지
+	};
+
+	// 정확한 유클리드 거리 변환 (Meijster, 반지름/이미지 내용과 무관하게 픽셀당 일정 비용)
+	// 1단계: 열마다 위/아래로 가장 가까운 대상까지 세로 거리 (행 순서로 열 묶음을 한꺼번에 갱신)
+	// 2단계: 행마다 포물선 (x - i)^2 + g(i)^2 의 하한 포락선으로 최솟값 (행 병렬)
+	// 이미지 밖은 대상이 아님, 대상이 하나도 없으면 무한대 (float: infinity, uint16: 65535)
+	// distances는 width * height 빽빽한 배열
+	void DistanceTransform(const BinaryImage& binary, DistanceTarget target, float* distances, ScratchPool& scratch);
+	// 반올림, 65535에서 포화
+	void DistanceTransform(const BinaryImage& binary, DistanceTarget target, unsigned short* distances, ScratchPool& scratch);
+
+	// 원판 구조 요소 (|p - q| <= radius인 모든 q), 거리 제곱을 radius^2와 비교
+	// 팽창: 가장 가까운 1까지 거리 <= radius / 침식: 가장 가까운 0까지 거리 > radius
+	// 이미지 밖은 결과에 영향 없는 값, src와 dst가 같아도 됨
+	void BinaryDilateDisk(const BinaryImage& src, BinaryImage& dst, float radius, ScratchPool& scratch);
+	void BinaryErodeDisk(const BinaryImage& src, BinaryImage& dst, float radius, ScratchPool& scratch);
+}
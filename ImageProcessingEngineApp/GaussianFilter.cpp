@@ -0,0 +1,381 @@
+﻿#include <omp.h>
+#include <cmath>
+#include <complex>
+#include <cstring>
+#include <algorithm>
+#include "GaussianFilter.h"
+#include "SeparableFilter.h"
+#include "Simd.h"
+
+using namespace std;
+
+namespace {
+	// 세로 패스 열 묶음 폭, 16픽셀(64바이트 = 캐시 라인 하나) x 높이 만큼 float 버퍼
+	constexpr int columnBlock = 16;
+	// 양 끝 여유 (재귀 필터 3개, 탭 필터 radius개)
+	constexpr int pad = NativeEngine::gaussianMaxTapRadius > 3 ? NativeEngine::gaussianMaxTapRadius : 3;
+
+	// van Vliet, Young & Verbeek (1998) sigma 2 극점 (L2 최적), 극점 d를 d^(1 / q)로 옮기면 폭이 q배쯤
+	const std::complex<double> recursivePole(1.41650, 1.00829); // 켤레 쌍
+	constexpr double recursiveRealPole = 1.86543;
+
+	std::complex<double> scaledPole(double q) {
+		return std::polar(pow(std::abs(recursivePole), 1.0 / q), std::arg(recursivePole) / q);
+	}
+
+	// q로 옮긴 극점의 정방향 + 역방향 분산: sum 2 d / (d - 1)^2
+	double recursiveVariance(double q) {
+		const std::complex<double> d = scaledPole(q);
+		const double r = pow(recursiveRealPole, 1.0 / q);
+		return 2.0 * (2.0 * d / ((d - 1.0) * (d - 1.0))).real() + 2.0 * r / ((r - 1.0) * (r - 1.0));
+	}
+
+	// dst[i] = B * src[i] + c1 * p1[i] + c2 * p2[i] + c3 * p3[i], n은 4의 배수
+	// dst == src 제자리 계산 가능
+	inline void iirStep(float* dst, const float* src, const float* p1, const float* p2, const float* p3,
+		int n, const NativeEngine::GaussianKernel& k)
+	{
+#ifdef ENGINE_SSE2
+		const __m128 vB = _mm_set1_ps(k.B);
+		const __m128 v1 = _mm_set1_ps(k.c1);
+		const __m128 v2 = _mm_set1_ps(k.c2);
+		const __m128 v3 = _mm_set1_ps(k.c3);
+		for (int i = 0; i < n; i += 4) {
+			__m128 acc = _mm_mul_ps(vB, _mm_loadu_ps(src + i));
+			acc = _mm_add_ps(acc, _mm_mul_ps(v1, _mm_loadu_ps(p1 + i)));
+			acc = _mm_add_ps(acc, _mm_mul_ps(v2, _mm_loadu_ps(p2 + i)));
+			acc = _mm_add_ps(acc, _mm_mul_ps(v3, _mm_loadu_ps(p3 + i)));
+			_mm_storeu_ps(dst + i, acc);
+		}
+#else
+		for (int i = 0; i < n; i++) {
+			dst[i] = k.B * src[i] + k.c1 * p1[i] + k.c2 * p2[i] + k.c3 * p3[i];
+		}
+#endif
+	}
+
+	// dst[i] = taps[0] * src[i] + sum(taps[r] * (src[i - r*n] + src[i + r*n]))
+	inline void tapStep(float* dst, const float* src, int n, const NativeEngine::GaussianKernel& k) {
+#ifdef ENGINE_SSE2
+		for (int i = 0; i < n; i += 4) {
+			__m128 acc = _mm_mul_ps(_mm_set1_ps(k.taps[0]), _mm_loadu_ps(src + i));
+			for (int r = 1; r <= k.radius; r++) {
+				const __m128 pair = _mm_add_ps(_mm_loadu_ps(src + i - r * n), _mm_loadu_ps(src + i + r * n));
+				acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(k.taps[r]), pair));
+			}
+			_mm_storeu_ps(dst + i, acc);
+		}
+#else
+		for (int i = 0; i < n; i++) {
+			float acc = k.taps[0] * src[i];
+			for (int r = 1; r <= k.radius; r++) acc += k.taps[r] * (src[i - r * n] + src[i + r * n]);
+			dst[i] = acc;
+		}
+#endif
+	}
+
+	// buf: 앞뒤로 pad개 원소(각 n개) 여유가 있는 count개 원소, tmp: count개 원소
+	// 결과 위치를 돌려줌 (재귀는 buf 제자리, 탭은 tmp)
+	float* filterLine(float* buf, float* tmp, int count, int n, const NativeEngine::GaussianKernel& k) {
+		float* first = buf + pad * n;
+		float* last = first + static_cast<size_t>(count - 1) * n;
+
+		if (k.radius > 0) {
+			for (int i = 1; i <= k.radius; i++) {
+				memcpy(first - i * n, first, sizeof(float) * n);
+				memcpy(last + i * n, last, sizeof(float) * n);
+			}
+			for (int i = 0; i < count; i++) {
+				tapStep(tmp + static_cast<size_t>(i) * n, first + static_cast<size_t>(i) * n, n, k);
+			}
+			return tmp;
+		}
+
+		// 정방향, 앞쪽은 첫 값이 계속되는 것으로 (정상 상태), 마지막 입력은 역방향 시작값용으로 보관
+		memcpy(tmp, last, sizeof(float) * n);
+		for (int i = 1; i <= 3; i++) memcpy(first - i * n, first, sizeof(float) * n);
+		for (int i = 0; i < count; i++) {
+			float* cur = first + static_cast<size_t>(i) * n;
+			iirStep(cur, cur, cur - n, cur - 2 * n, cur - 3 * n, n, k);
+		}
+
+		// 역방향 시작값 (정방향 결과는 아직 입력을 따라가는 중이라 마지막 값 복제는 정상 상태가 아님)
+		// 정방향 전에 tmp에 둔 마지막 입력 u 기준으로 Triggs-Sdika 행렬 적용
+		const float* input = tmp;
+		for (int j = 0; j < n; j++) {
+			const float u = input[j];
+			const float d0 = last[j] - u;
+			const float d1 = last[j - n] - u;
+			const float d2 = last[j - 2 * n] - u;
+			for (int i = 0; i < 3; i++) {
+				last[(i + 1) * n + j] = u + k.boundary[i][0] * d0 + k.boundary[i][1] * d1 + k.boundary[i][2] * d2;
+			}
+		}
+		for (int i = count - 1; i >= 0; i--) {
+			float* cur = first + static_cast<size_t>(i) * n;
+			iirStep(cur, cur, cur + n, cur + 2 * n, cur + 3 * n, n, k);
+		}
+		return first;
+	}
+
+	inline void loadPixels(const unsigned char* src, float* dst, int pixels) {
+		for (int i = 0; i < pixels * 4; i++) dst[i] = src[i];
+	}
+
+	// 반올림해서 BGR만 저장 (알파 유지)
+	inline void storePixels(const float* src, unsigned char* dst, int pixels) {
+		for (int x = 0; x < pixels; x++) {
+			for (int c = 0; c < 3; c++) {
+				dst[x * 4 + c] = static_cast<unsigned char>(std::clamp(src[x * 4 + c] + 0.5f, 0.0f, 255.0f));
+			}
+		}
+	}
+}
+
+NativeEngine::GaussianKernel NativeEngine::ComputeGaussianKernel(float sigma, ScratchPool& scratch) {
+	GaussianKernel k;
+
+	if (sigma < gaussianRecursiveMinSigma) {
+		k.radius = std::clamp(static_cast<int>(ceil(sigma * 3.0f)), 1, gaussianMaxTapRadius);
+		double sum = 0.0;
+		double weights[gaussianMaxTapRadius + 1];
+		for (int r = 0; r <= k.radius; r++) {
+			weights[r] = exp(-0.5 * (r * r) / (static_cast<double>(sigma) * sigma));
+			sum += r == 0 ? weights[r] : 2.0 * weights[r];
+		}
+		for (int r = 0; r <= k.radius; r++) k.taps[r] = static_cast<float>(weights[r] / sum);
+		return k;
+	}
+
+	// 분산이 sigma^2가 되는 q (분산은 q에 대해 증가, q = sigma면 이미 넘음)
+	const double s = sigma;
+	double lower = 0.5;
+	double upper = s;
+	for (int i = 0; i < 50; i++) {
+		const double middle = 0.5 * (lower + upper);
+		if (recursiveVariance(middle) < s * s) lower = middle;
+		else upper = middle;
+	}
+	const double q = 0.5 * (lower + upper);
+
+	// 1 / ((1 - d1 / z)(1 - d2 / z)(1 - d3 / z)) 전개
+	const std::complex<double> inverse = 1.0 / scaledPole(q);
+	const double inverseReal = 1.0 / pow(recursiveRealPole, 1.0 / q);
+	const double pairSum = 2.0 * inverse.real();
+	const double pairProduct = std::norm(inverse);
+	const double c[3] = { pairSum + inverseReal, -(pairProduct + pairSum * inverseReal), pairProduct * inverseReal };
+
+	k.c1 = static_cast<float>(c[0]);
+	k.c2 = static_cast<float>(c[1]);
+	k.c3 = static_cast<float>(c[2]);
+	k.B = 1.0f - (k.c1 + k.c2 + k.c3); // 계수 합 1 (밝기 보존)
+
+	// 역방향 시작값 행렬: 끝에서 정방향 편차 (w[N-1-j] - u)가 단위값일 때
+	// 상수 입력으로 정방향을 충분히 이어 간 뒤 (편차는 동차 점화식으로 줄어듦) 역방향으로 되돌아온 v[N + i] - u
+	// 편차는 sigma 몇 배 안에 사라지므로 10 * sigma + 32 스텝이면 float 정밀도로 수렴
+	const double gain = 1.0 - (c[0] + c[1] + c[2]);
+	const int steps = static_cast<int>(10.0 * ceil(s)) + 32;
+	ScratchBuffer<double> forward(scratch, static_cast<size_t>(steps) + 3);
+	ScratchBuffer<double> backward(scratch, static_cast<size_t>(steps) + 6);
+	for (int j = 0; j < 3; j++) {
+		// forward[2 - m] = w[N - 1 - m] 편차, forward[3 + t] = w[N + t] 편차
+		std::fill_n(forward.data(), forward.size(), 0.0);
+		std::fill_n(backward.data(), backward.size(), 0.0);
+		forward[2 - j] = 1.0;
+		for (int t = 3; t < steps + 3; t++) forward[t] = c[0] * forward[t - 1] + c[1] * forward[t - 2] + c[2] * forward[t - 3];
+		for (int t = steps + 2; t >= 3; t--) backward[t] = gain * forward[t] + c[0] * backward[t + 1] + c[1] * backward[t + 2] + c[2] * backward[t + 3];
+		for (int i = 0; i < 3; i++) k.boundary[i][j] = static_cast<float>(backward[3 + i]);
+	}
+	return k;
+}
+
+void NativeEngine::GaussianRows(const ImageView& image, const GaussianKernel& kernel, ScratchPool& scratch) {
+	const int width = image.width;
+	const int height = image.height;
+
+#pragma omp parallel
+	{
+		// 행 버퍼는 스레드당 한 번만
+		ScratchBuffer<float> line(scratch, static_cast<size_t>(width + 2 * pad) * 4);
+		ScratchBuffer<float> tmp(scratch, static_cast<size_t>(width) * 4);
+		float* first = line.data() + pad * 4;
+
+#pragma omp for schedule(static)
+		for (int y = 0; y < height; y++) {
+			unsigned char* row = image.Row(y);
+			loadPixels(row, first, width);
+			storePixels(filterLine(line.data(), tmp.data(), width, 4, kernel), row, width);
+		}
+	}
+}
+
+void NativeEngine::GaussianColumns(const ImageView& image, const GaussianKernel& kernel, ScratchPool& scratch) {
+	const int height = image.height;
+
+	ForEachColumnBlock(image.width, columnBlock, [&](int x0, int pixels) {
+		// 열 묶음 하나를 행 순서로 읽어서 전부 버퍼에 (재귀 필터는 양방향이라 열 전체가 필요)
+		const int n = pixels * 4;
+		ScratchBuffer<float> block(scratch, static_cast<size_t>(height + 2 * pad) * n);
+		ScratchBuffer<float> tmp(scratch, static_cast<size_t>(height) * n);
+		float* first = block.data() + pad * n;
+
+		for (int y = 0; y < height; y++) {
+			loadPixels(image.Pixel(x0, y), first + static_cast<size_t>(y) * n, pixels);
+		}
+		const float* result = filterLine(block.data(), tmp.data(), height, n, kernel);
+		for (int y = 0; y < height; y++) {
+			storePixels(result + static_cast<size_t>(y) * n, image.Pixel(x0, y), pixels);
+		}
+	});
+}
+
+namespace {
+	// dst[x] = taps[0] * rows[0][x] + sum taps[r] * (lower[r][x] + upper[r][x])
+	// 가로는 lower[r] = center - r, 세로는 위로 r번째 행
+#ifdef ENGINE_SSE2
+	ENGINE_TARGET_AVX2 int tapLineAvx2(const float* center, const float* const* lower, const float* const* upper,
+		float* dst, int width, const NativeEngine::GaussianKernel& k)
+	{
+		int x = 0;
+		for (; x + 8 <= width; x += 8) {
+			__m256 acc = _mm256_mul_ps(_mm256_set1_ps(k.taps[0]), _mm256_loadu_ps(center + x));
+			for (int r = 1; r <= k.radius; r++) {
+				const __m256 pair = _mm256_add_ps(_mm256_loadu_ps(lower[r] + x), _mm256_loadu_ps(upper[r] + x));
+				acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_set1_ps(k.taps[r]), pair));
+			}
+			_mm256_storeu_ps(dst + x, acc);
+		}
+		return x;
+	}
+#endif
+
+	void tapLine(const float* center, const float* const* lower, const float* const* upper,
+		float* dst, int width, const NativeEngine::GaussianKernel& k, bool avx2)
+	{
+		int x = 0;
+#ifdef ENGINE_SSE2
+		if (avx2) x = tapLineAvx2(center, lower, upper, dst, width, k);
+		for (; x + 4 <= width; x += 4) {
+			__m128 acc = _mm_mul_ps(_mm_set1_ps(k.taps[0]), _mm_loadu_ps(center + x));
+			for (int r = 1; r <= k.radius; r++) {
+				const __m128 pair = _mm_add_ps(_mm_loadu_ps(lower[r] + x), _mm_loadu_ps(upper[r] + x));
+				acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(k.taps[r]), pair));
+			}
+			_mm_storeu_ps(dst + x, acc);
+		}
+#else
+		(void)avx2;
+#endif
+		for (; x < width; x++) {
+			float acc = k.taps[0] * center[x];
+			for (int r = 1; r <= k.radius; r++) acc += k.taps[r] * (lower[r][x] + upper[r][x]);
+			dst[x] = acc;
+		}
+	}
+
+	// 재귀 커널용 제자리 평면 필터
+	void recursivePlane(float* plane, int width, int height, const NativeEngine::GaussianKernel& kernel,
+		NativeEngine::ScratchPool& scratch)
+	{
+		const int groups = (height + 3) / 4;
+
+		// 가로: 4행을 x마다 엮어서 (x * 4 + 행), 모자라는 행은 마지막 행 반복 (저장 안 함)
+#pragma omp parallel
+		{
+			NativeEngine::ScratchBuffer<float> line(scratch, static_cast<size_t>(width + 2 * pad) * 4);
+			NativeEngine::ScratchBuffer<float> tmp(scratch, static_cast<size_t>(width) * 4);
+			float* first = line.data() + pad * 4;
+
+#pragma omp for schedule(static)
+			for (int g = 0; g < groups; g++) {
+				const int y0 = g * 4;
+				const int rows = std::min(4, height - y0);
+				for (int r = 0; r < 4; r++) {
+					const float* src = plane + static_cast<size_t>(y0 + std::min(r, rows - 1)) * width;
+					for (int x = 0; x < width; x++) first[x * 4 + r] = src[x];
+				}
+				const float* result = filterLine(line.data(), tmp.data(), width, 4, kernel);
+				for (int r = 0; r < rows; r++) {
+					float* dst = plane + static_cast<size_t>(y0 + r) * width;
+					for (int x = 0; x < width; x++) dst[x] = result[x * 4 + r];
+				}
+			}
+		}
+
+		// 세로: 열 묶음 폭을 4의 배수로 맞춤 (남는 칸은 계산만 하고 버림)
+		NativeEngine::ForEachColumnBlock(width, columnBlock, [&](int x0, int pixels) {
+			const int n = (pixels + 3) & ~3;
+			NativeEngine::ScratchBuffer<float> block(scratch, static_cast<size_t>(height + 2 * pad) * n);
+			NativeEngine::ScratchBuffer<float> tmp(scratch, static_cast<size_t>(height) * n);
+			float* first = block.data() + pad * n;
+
+			for (int y = 0; y < height; y++) {
+				float* dst = first + static_cast<size_t>(y) * n;
+				memcpy(dst, plane + static_cast<size_t>(y) * width + x0, sizeof(float) * pixels);
+				for (int i = pixels; i < n; i++) dst[i] = 0.0f;
+			}
+			const float* result = filterLine(block.data(), tmp.data(), height, n, kernel);
+			for (int y = 0; y < height; y++) {
+				memcpy(plane + static_cast<size_t>(y) * width + x0, result + static_cast<size_t>(y) * n, sizeof(float) * pixels);
+			}
+		});
+	}
+}
+
+void NativeEngine::GaussianPlane(const float* src, float* dst, int width, int height, const GaussianKernel& kernel, ScratchPool& scratch) {
+	if (width <= 0 || height <= 0) return;
+
+	if (kernel.radius == 0) {
+		memcpy(dst, src, sizeof(float) * width * height);
+		recursivePlane(dst, width, height, kernel, scratch);
+		return;
+	}
+
+	const int radius = kernel.radius;
+	const int ringRows = 2 * radius + 1;
+	const bool avx2 = CpuHasAvx2();
+
+#pragma omp parallel
+	{
+		// 스레드마다 연속된 행 띠 하나, 띠 경계 위아래 radius행은 띠마다 다시 가로 블러
+		const int threads = omp_get_num_threads();
+		const int strip = (height + threads - 1) / threads;
+		const int y0 = std::min(height, omp_get_thread_num() * strip);
+		const int y1 = std::min(height, y0 + strip);
+
+		ScratchBuffer<float> ring(scratch, static_cast<size_t>(ringRows) * width);
+		ScratchBuffer<float> padded(scratch, static_cast<size_t>(width) + 2 * radius);
+		auto ringLine = [&](int y) { return ring.data() + static_cast<size_t>((y - y0 + ringRows * 2) % ringRows) * width; };
+
+		const float* lower[gaussianMaxTapRadius + 1];
+		const float* upper[gaussianMaxTapRadius + 1];
+
+		// 가로 블러 한 행 (위아래 범위 밖은 가장자리 행 복제)
+		auto horizontal = [&](int y) {
+			const float* row = src + static_cast<size_t>(std::clamp(y, 0, height - 1)) * width;
+			float* p = padded.data() + radius;
+			memcpy(p, row, sizeof(float) * width);
+			for (int i = 1; i <= radius; i++) {
+				p[-i] = row[0];
+				p[width - 1 + i] = row[width - 1];
+			}
+			for (int r = 1; r <= radius; r++) {
+				lower[r] = p - r;
+				upper[r] = p + r;
+			}
+			tapLine(p, lower, upper, ringLine(y), width, kernel, avx2);
+		};
+
+		if (y0 < y1) {
+			for (int y = y0 - radius; y < y0 + radius; y++) horizontal(y);
+		}
+		for (int y = y0; y < y1; y++) {
+			horizontal(y + radius);
+			for (int r = 1; r <= radius; r++) {
+				lower[r] = ringLine(y - r);
+				upper[r] = ringLine(y + r);
+			}
+			tapLine(ringLine(y), lower, upper, dst + static_cast<size_t>(y) * width, width, kernel, avx2);
+		}
+	}
+}
@@ -0,0 +1,40 @@
+﻿#pragma once
+
+#include "ImageView.h"
+#include "ScratchPool.h"
+
+namespace NativeEngine {
+	// sigma 2 미만은 재귀 근사 오차가 커서 직접 컨볼루션 (최대 13탭)
+	constexpr float gaussianRecursiveMinSigma = 2.0f;
+	constexpr int gaussianMaxTapRadius = 6;
+
+	// 가우시안 한 방향 필터
+	// 작은 sigma: 대칭 탭 (radius > 0)
+	// 큰 sigma: 3차 재귀(IIR), w[n] = B * x[n] + c1 * w[n-1] + c2 * w[n-2] + c3 * w[n-3]
+	//           극점은 van Vliet, Young & Verbeek (1998), 분산이 정확히 sigma^2가 되게 옮김 (계단 오차 1단계 미만)
+	//           정방향 후 역방향 한 번 더
+	//           역방향 시작값은 Triggs & Sdika (2006): 끝 뒤 입력이 마지막 값으로 계속된다고 보고
+	//           v[N + i] = u + sum boundary[i][j] * (w[N - 1 - j] - u) (u: 마지막 입력, w: 정방향 결과)
+	struct GaussianKernel {
+		int radius = 0;
+		float taps[gaussianMaxTapRadius + 1] = {};
+		float B = 1.0f;
+		float c1 = 0.0f;
+		float c2 = 0.0f;
+		float c3 = 0.0f;
+		float boundary[3][3] = {};
+	};
+
+	// sigma 0.5 미만은 근사식 범위 밖 (호출 쪽에서 건너뜀), 시작값 계산 버퍼는 scratch에서
+	GaussianKernel ComputeGaussianKernel(float sigma, ScratchPool& scratch);
+
+	// 가로 / 세로 한 방향씩, 픽셀당 연산량은 sigma와 무관
+	// 4채널을 함께 계산하고 알파는 그대로 둠, 가장자리는 복제
+	void GaussianRows(const ImageView& image, const GaussianKernel& kernel, ScratchPool& scratch);
+	void GaussianColumns(const ImageView& image, const GaussianKernel& kernel, ScratchPool& scratch);
+
+	// float 한 채널 평면 (width * height) 가로 + 세로, 가장자리 복제, src와 dst는 달라야 함
+	// 탭 커널: 스레드별 가로 띠에서 가로 블러한 행을 링 버퍼에 두고 바로 세로 합 (중간 평면 없음)
+	// 재귀 커널: dst에 복사한 뒤 가로는 4행을 4채널처럼 엮어서, 세로는 열 묶음으로 (BGRA 패스와 같은 필터 코드)
+	void GaussianPlane(const float* src, float* dst, int width, int height, const GaussianKernel& kernel, ScratchPool& scratch);
+}
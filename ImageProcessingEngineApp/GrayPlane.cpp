@@ -0,0 +1,135 @@
+﻿#include <omp.h>
+#include "GrayPlane.h"
+#include "Simd.h"
+
+using namespace std;
+
+namespace {
+	// madd_epi16 한 번에 (byte0, byte2) 채널, 또 한 번에 (byte1) 채널
+	// BGRA: byte0 = B, byte2 = R / RGBA: byte0 = R, byte2 = B
+	inline int lowWeight(NativeEngine::PixelLayout layout) {
+		return layout == NativeEngine::PixelLayout::Bgra32 ? NativeEngine::grayWeightB : NativeEngine::grayWeightR;
+	}
+
+	inline int highWeight(NativeEngine::PixelLayout layout) {
+		return layout == NativeEngine::PixelLayout::Bgra32 ? NativeEngine::grayWeightR : NativeEngine::grayWeightB;
+	}
+
+	int convertScalar(const unsigned char* src, unsigned char* dst, int start, int width, int w0, int w2) {
+		for (int x = start; x < width; x++) {
+			const unsigned char* p = src + x * 4;
+			dst[x] = static_cast<unsigned char>((p[0] * w0 + p[1] * NativeEngine::grayWeightG + p[2] * w2) >> NativeEngine::grayShift);
+		}
+		return width;
+	}
+
+#ifdef ENGINE_SSE2
+	inline __m128i gray4(__m128i px, __m128i mask, __m128i w02, __m128i w1) {
+		const __m128i br = _mm_and_si128(px, mask);
+		const __m128i ga = _mm_and_si128(_mm_srli_epi32(px, 8), mask);
+		const __m128i sum = _mm_add_epi32(_mm_madd_epi16(br, w02), _mm_madd_epi16(ga, w1));
+		return _mm_srli_epi32(sum, NativeEngine::grayShift);
+	}
+
+	// 16픽셀씩
+	int convertSse2(const unsigned char* src, unsigned char* dst, int width, int w0, int w2) {
+		const __m128i mask = _mm_set1_epi32(0x00FF00FF);
+		const __m128i w02 = _mm_set1_epi32((w2 << 16) | w0);
+		const __m128i w1 = _mm_set1_epi32(NativeEngine::grayWeightG);
+
+		int x = 0;
+		for (; x + 16 <= width; x += 16) {
+			const __m128i* p = reinterpret_cast<const __m128i*>(src + x * 4);
+			const __m128i g0 = gray4(_mm_loadu_si128(p + 0), mask, w02, w1);
+			const __m128i g1 = gray4(_mm_loadu_si128(p + 1), mask, w02, w1);
+			const __m128i g2 = gray4(_mm_loadu_si128(p + 2), mask, w02, w1);
+			const __m128i g3 = gray4(_mm_loadu_si128(p + 3), mask, w02, w1);
+			const __m128i packed = _mm_packus_epi16(_mm_packs_epi32(g0, g1), _mm_packs_epi32(g2, g3));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), packed);
+		}
+		return x;
+	}
+#endif
+
+#ifdef ENGINE_X86
+	ENGINE_TARGET_AVX2
+	inline __m256i gray8(__m256i px, __m256i mask, __m256i w02, __m256i w1) {
+		const __m256i br = _mm256_and_si256(px, mask);
+		const __m256i ga = _mm256_and_si256(_mm256_srli_epi32(px, 8), mask);
+		const __m256i sum = _mm256_add_epi32(_mm256_madd_epi16(br, w02), _mm256_madd_epi16(ga, w1));
+		return _mm256_srli_epi32(sum, NativeEngine::grayShift);
+	}
+
+	// 32픽셀씩, pack이 128비트 레인 단위라 마지막에 순서 복원
+	ENGINE_TARGET_AVX2
+	int convertAvx2(const unsigned char* src, unsigned char* dst, int width, int w0, int w2) {
+		const __m256i mask = _mm256_set1_epi32(0x00FF00FF);
+		const __m256i w02 = _mm256_set1_epi32((w2 << 16) | w0);
+		const __m256i w1 = _mm256_set1_epi32(NativeEngine::grayWeightG);
+		const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+		int x = 0;
+		for (; x + 32 <= width; x += 32) {
+			const __m256i* p = reinterpret_cast<const __m256i*>(src + x * 4);
+			const __m256i g0 = gray8(_mm256_loadu_si256(p + 0), mask, w02, w1);
+			const __m256i g1 = gray8(_mm256_loadu_si256(p + 1), mask, w02, w1);
+			const __m256i g2 = gray8(_mm256_loadu_si256(p + 2), mask, w02, w1);
+			const __m256i g3 = gray8(_mm256_loadu_si256(p + 3), mask, w02, w1);
+			const __m256i packed = _mm256_packus_epi16(_mm256_packs_epi32(g0, g1), _mm256_packs_epi32(g2, g3));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + x), _mm256_permutevar8x32_epi32(packed, order));
+		}
+		return x;
+	}
+#endif
+}
+
+void NativeEngine::ConvertRowToGray(const unsigned char* src, unsigned char* dst, int width, PixelLayout layout) {
+	const int w0 = lowWeight(layout);
+	const int w2 = highWeight(layout);
+	int x = 0;
+
+#ifdef ENGINE_X86
+	if (CpuHasAvx2()) x = convertAvx2(src, dst, width, w0, w2);
+#endif
+#ifdef ENGINE_SSE2
+	x += convertSse2(src + x * 4, dst + x, width - x, w0, w2);
+#endif
+	convertScalar(src, dst, x, width, w0, w2);
+}
+
+void NativeEngine::ConvertToGray(const ImageView& image, unsigned char* gray) {
+	const int width = image.width;
+	const int height = image.height;
+
+#pragma omp parallel for schedule(static)
+	for (int y = 0; y < height; y++) {
+		ConvertRowToGray(image.Row(y), gray + static_cast<size_t>(y) * width, width, image.layout);
+	}
+}
+
+void NativeEngine::WriteGrayRow(const unsigned char* gray, unsigned char* dst, int width) {
+	int x = 0;
+#ifdef ENGINE_SSE2
+	const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+	for (; x + 16 <= width; x += 16) {
+		const __m128i g = _mm_loadu_si128(reinterpret_cast<const __m128i*>(gray + x));
+		const __m128i lo = _mm_unpacklo_epi8(g, g);
+		const __m128i hi = _mm_unpackhi_epi8(g, g);
+		const __m128i quads[4] = {
+			_mm_unpacklo_epi16(lo, lo), _mm_unpackhi_epi16(lo, lo),
+			_mm_unpacklo_epi16(hi, hi), _mm_unpackhi_epi16(hi, hi)
+		};
+		__m128i* p = reinterpret_cast<__m128i*>(dst + x * 4);
+		for (int i = 0; i < 4; i++) {
+			const __m128i original = _mm_loadu_si128(p + i);
+			_mm_storeu_si128(p + i, _mm_or_si128(_mm_andnot_si128(alpha, quads[i]), _mm_and_si128(alpha, original)));
+		}
+	}
+#endif
+	for (; x < width; x++) {
+		unsigned char* p = dst + x * 4;
+		p[0] = gray[x];
+		p[1] = gray[x];
+		p[2] = gray[x];
+	}
+}
@@ -0,0 +1,24 @@
+﻿#pragma once
+
+#include "ImageView.h"
+
+namespace NativeEngine {
+	// 휘도 가중치 0.114B + 0.587G + 0.299R (15비트 고정소수점, 합 32768)
+	constexpr int grayWeightB = 3735;
+	constexpr int grayWeightG = 19235;
+	constexpr int grayWeightR = 9798;
+	constexpr int grayShift = 15;
+
+	inline unsigned char GrayOf(int b, int g, int r) {
+		return static_cast<unsigned char>((b * grayWeightB + g * grayWeightG + r * grayWeightR) >> grayShift);
+	}
+
+	// 한 행 변환 (AVX2 / SSE2 / 스칼라 자동 선택)
+	void ConvertRowToGray(const unsigned char* src, unsigned char* dst, int width, PixelLayout layout);
+
+	// 전체 이미지 -> width * height 빽빽한 8비트 평면 (행 병렬)
+	void ConvertToGray(const ImageView& image, unsigned char* gray);
+
+	// 휘도 한 행 -> 픽셀 B/G/R (알파 유지, 채널 순서와 무관, SSE2 16픽셀씩)
+	void WriteGrayRow(const unsigned char* gray, unsigned char* dst, int width);
+}
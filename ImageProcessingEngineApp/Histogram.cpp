@@ -0,0 +1,350 @@
+﻿#include <omp.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include "Histogram.h"
+#include "GrayPlane.h"
+
+using namespace std;
+
+namespace {
+	using namespace NativeEngine;
+
+	constexpr int banks = 4;
+
+	// 스레드별 뱅크 (4KB씩, 캐시 라인 정렬이라 다른 스레드와 줄을 나눠 쓰지 않음)
+	struct alignas(64) BankedHistogram {
+		unsigned int bank[banks][histogramBins];
+
+		void Clear() { memset(bank, 0, sizeof(bank)); }
+
+		// 8바이트씩 읽어 바이트마다 다른 뱅크로
+		void CountRow(const unsigned char* row, int width) {
+			int x = 0;
+			for (; x + 8 <= width; x += 8) {
+				unsigned long long v;
+				memcpy(&v, row + x, sizeof(v));
+				bank[0][v & 0xFF]++;
+				bank[1][(v >> 8) & 0xFF]++;
+				bank[2][(v >> 16) & 0xFF]++;
+				bank[3][(v >> 24) & 0xFF]++;
+				bank[0][(v >> 32) & 0xFF]++;
+				bank[1][(v >> 40) & 0xFF]++;
+				bank[2][(v >> 48) & 0xFF]++;
+				bank[3][v >> 56]++;
+			}
+			for (; x < width; x++) bank[x & (banks - 1)][row[x]]++;
+		}
+
+		void AddTo(unsigned int* counts) const {
+			for (int i = 0; i < histogramBins; i++) counts[i] += bank[0][i] + bank[1][i] + bank[2][i] + bank[3][i];
+		}
+	};
+
+	// 스레드 사본 threads개 -> 결과 (칸 범위를 스레드끼리 나눔, 병렬 구역 안에서 호출)
+	void mergeCopies(const unsigned int* copies, int threads, unsigned int* counts) {
+#pragma omp for schedule(static)
+		for (int i = 0; i < histogramBins; i++) {
+			unsigned int sum = 0;
+			for (int t = 0; t < threads; t++) sum += copies[static_cast<size_t>(t) * histogramBins + i];
+			counts[i] = sum;
+		}
+	}
+}
+
+void NativeEngine::AccumulateHistogram(const unsigned char* plane, int width, int height, size_t stride, Histogram& histogram) {
+	BankedHistogram local;
+	local.Clear();
+	for (int y = 0; y < height; y++) local.CountRow(plane + y * stride, width);
+	local.AddTo(histogram.counts);
+}
+
+void NativeEngine::ComputeHistogram(const unsigned char* plane, int width, int height, size_t stride, Histogram& histogram) {
+	std::fill(histogram.counts, histogram.counts + histogramBins, 0u);
+	if (plane == nullptr || width <= 0 || height <= 0) return;
+
+	const int maxThreads = omp_get_max_threads();
+	std::vector<Histogram> copies(maxThreads);
+
+#pragma omp parallel
+	{
+		const int threads = omp_get_num_threads();
+		BankedHistogram local;
+		local.Clear();
+
+#pragma omp for schedule(static)
+		for (int y = 0; y < height; y++) local.CountRow(plane + y * stride, width);
+
+		local.AddTo(copies[omp_get_thread_num()].counts);
+#pragma omp barrier
+		mergeCopies(copies[0].counts, threads, histogram.counts);
+	}
+}
+
+void NativeEngine::ComputeHistograms(const ImageView& image, ImageHistograms& histograms, ScratchPool& scratch) {
+	histograms = ImageHistograms();
+	if (!image.IsValid()) return;
+
+	const int width = image.width;
+	const int height = image.height;
+	const int maxThreads = omp_get_max_threads();
+	// 스레드마다 B, G, R, A, 휘도 사본
+	std::vector<Histogram> copies(static_cast<size_t>(maxThreads) * 5);
+
+#pragma omp parallel
+	{
+		const int threads = omp_get_num_threads();
+		const int thread = omp_get_thread_num();
+		ScratchBuffer<unsigned char> line(scratch, width);
+
+		// 채널마다 뱅크 2개 (이웃 픽셀이 다른 뱅크), 휘도는 4개
+		BankedHistogram channelLocal[2];
+		BankedHistogram luminanceLocal;
+		channelLocal[0].Clear();
+		channelLocal[1].Clear();
+		luminanceLocal.Clear();
+
+#pragma omp for schedule(static)
+		for (int y = 0; y < height; y++) {
+			const unsigned char* row = image.Row(y);
+			int x = 0;
+			for (; x + 2 <= width; x += 2) {
+				unsigned long long v;
+				memcpy(&v, row + x * 4, sizeof(v));
+				channelLocal[0].bank[0][v & 0xFF]++;
+				channelLocal[0].bank[1][(v >> 8) & 0xFF]++;
+				channelLocal[0].bank[2][(v >> 16) & 0xFF]++;
+				channelLocal[0].bank[3][(v >> 24) & 0xFF]++;
+				channelLocal[1].bank[0][(v >> 32) & 0xFF]++;
+				channelLocal[1].bank[1][(v >> 40) & 0xFF]++;
+				channelLocal[1].bank[2][(v >> 48) & 0xFF]++;
+				channelLocal[1].bank[3][v >> 56]++;
+			}
+			for (; x < width; x++) {
+				for (int c = 0; c < 4; c++) channelLocal[0].bank[c][row[x * 4 + c]]++;
+			}
+
+			ConvertRowToGray(row, line.data(), width, image.layout);
+			luminanceLocal.CountRow(line.data(), width);
+		}
+
+		// 뱅크 c = 바이트 c (레이아웃에 따라 B/R 자리가 바뀜)
+		Histogram* mine = copies.data() + static_cast<size_t>(thread) * 5;
+		const int byteOf[4] = { image.BlueOffset(), 1, image.RedOffset(), 3 };
+		for (int c = 0; c < 4; c++) {
+			unsigned int* counts = mine[c].counts;
+			const int b = byteOf[c];
+			for (int i = 0; i < histogramBins; i++) counts[i] = channelLocal[0].bank[b][i] + channelLocal[1].bank[b][i];
+		}
+		luminanceLocal.AddTo(mine[4].counts);
+#pragma omp barrier
+
+		// 사본 [스레드][5] -> 결과 5개 (칸 범위 병렬)
+		Histogram* results[5] = { &histograms.blue, &histograms.green, &histograms.red, &histograms.alpha, &histograms.luminance };
+#pragma omp for schedule(static)
+		for (int i = 0; i < 5 * histogramBins; i++) {
+			const int kind = i / histogramBins;
+			const int bin = i % histogramBins;
+			unsigned int sum = 0;
+			for (int t = 0; t < threads; t++) sum += copies[static_cast<size_t>(t) * 5 + kind].counts[bin];
+			results[kind]->counts[bin] = sum;
+		}
+	}
+}
+
+void NativeEngine::EqualizationTable(const Histogram& histogram, unsigned char* table) {
+	const unsigned long long total = histogram.Total();
+	int first = 0;
+	while (first < histogramBins && histogram.counts[first] == 0) first++;
+
+	const unsigned long long lowest = first < histogramBins ? histogram.counts[first] : 0;
+	if (total == lowest) {
+		for (int i = 0; i < histogramBins; i++) table[i] = static_cast<unsigned char>(i);
+		return;
+	}
+
+	// (cdf - cdf(first)) * 255 / (total - cdf(first)), 반올림
+	const unsigned long long range = total - lowest;
+	unsigned long long cdf = 0;
+	for (int i = 0; i < histogramBins; i++) {
+		cdf += histogram.counts[i];
+		const unsigned long long above = cdf > lowest ? cdf - lowest : 0;
+		table[i] = static_cast<unsigned char>((above * 255 + range / 2) / range);
+	}
+}
+
+void NativeEngine::ApplyLookupTable(const unsigned char* src, unsigned char* dst, size_t count, const unsigned char* table) {
+	const long long n = static_cast<long long>(count);
+#pragma omp parallel for schedule(static)
+	for (long long i = 0; i < n; i++) dst[i] = table[src[i]];
+}
+
+int NativeEngine::MultiOtsuThresholds(const Histogram& histogram, int classes, int* thresholds, ScratchPool& scratch) {
+	classes = std::clamp(classes, 2, multiOtsuMaxClasses);
+	constexpr int n = histogramBins;
+
+	// 누적 0차/1차 모멘트 (앞에 0 한 칸, P[i + 1]은 0 ~ i 합)
+	double P[n + 1] = {};
+	double S[n + 1] = {};
+	for (int i = 0; i < n; i++) {
+		P[i + 1] = P[i] + histogram.counts[i];
+		S[i + 1] = S[i] + static_cast<double>(i) * histogram.counts[i];
+	}
+
+	// between[a * n + b] = 구간 [a, b]의 S^2 / P (빈 구간은 0, a > b 칸은 읽지 않음)
+	ScratchBuffer<double> between(scratch, static_cast<size_t>(n) * n);
+	for (int a = 0; a < n; a++) {
+		for (int b = a; b < n; b++) {
+			const double weight = P[b + 1] - P[a];
+			const double moment = S[b + 1] - S[a];
+			between[static_cast<size_t>(a) * n + b] = weight > 0.0 ? moment * moment / weight : 0.0;
+		}
+	}
+
+	// best[m][j]: 0 ~ j를 m + 1 클래스로 나눴을 때 최대, from[m][j]: 마지막 클래스 직전 끝 (j >= m 칸만 씀)
+	ScratchBuffer<double> best(scratch, static_cast<size_t>(classes) * n);
+	ScratchBuffer<int> from(scratch, static_cast<size_t>(classes) * n);
+	for (int j = 0; j < n; j++) best[j] = between[j];
+	for (int m = 1; m < classes; m++) {
+		const double* previous = best.data() + static_cast<size_t>(m - 1) * n;
+		double* current = best.data() + static_cast<size_t>(m) * n;
+		int* origin = from.data() + static_cast<size_t>(m) * n;
+		for (int j = m; j < n; j++) {
+			double top = -1.0;
+			int arg = m - 1;
+			for (int i = m - 1; i < j; i++) {
+				const double value = previous[i] + between[static_cast<size_t>(i + 1) * n + j];
+				if (value > top) {
+					top = value;
+					arg = i;
+				}
+			}
+			current[j] = top;
+			origin[j] = arg;
+		}
+	}
+
+	// 뒤에서부터 경계 복원
+	int end = n - 1;
+	for (int m = classes - 1; m >= 1; m--) {
+		end = from[static_cast<size_t>(m) * n + end];
+		thresholds[m - 1] = end;
+	}
+	return classes - 1;
+}
+
+namespace {
+	// 칸 상한을 넘친 만큼 모아서 모든 칸에 고르게 (나머지는 간격을 두고 한 개씩)
+	void clipHistogram(unsigned int* counts, unsigned int limit) {
+		unsigned long long excess = 0;
+		for (int i = 0; i < histogramBins; i++) {
+			if (counts[i] > limit) {
+				excess += counts[i] - limit;
+				counts[i] = limit;
+			}
+		}
+		const unsigned int share = static_cast<unsigned int>(excess / histogramBins);
+		const int residual = static_cast<int>(excess % histogramBins);
+		for (int i = 0; i < histogramBins; i++) counts[i] += share;
+		if (residual > 0) {
+			const int step = std::max(1, histogramBins / residual);
+			for (int i = 0, left = residual; i < histogramBins && left > 0; i += step, left--) counts[i]++;
+		}
+	}
+
+	// 타일 중심 기준 보간 위치 (한 축), 이웃 타일 두 개와 뒤쪽 가중치 (0~256)
+	struct TileWeight {
+		int first;
+		int second;
+		int weight;
+	};
+
+	// 타일 t는 [t * length / tiles, (t + 1) * length / tiles) (tiles <= length라 빈 타일 없음)
+	int tileStart(int tile, int length, int tiles) {
+		return static_cast<int>(static_cast<long long>(tile) * length / tiles);
+	}
+
+	float tileCenter(int tile, int length, int tiles) {
+		return 0.5f * static_cast<float>(tileStart(tile, length, tiles) + tileStart(tile + 1, length, tiles));
+	}
+
+	void tileWeights(TileWeight* weights, int length, int tiles) {
+		int first = 0;
+		for (int i = 0; i < length; i++) {
+			const float position = static_cast<float>(i) + 0.5f;
+			while (first + 1 < tiles && tileCenter(first + 1, length, tiles) <= position) first++;
+			const float center = tileCenter(first, length, tiles);
+			if (first + 1 == tiles || position <= center) {
+				// 첫 타일 중심 앞, 마지막 타일 중심 뒤는 한 타일만
+				weights[i] = { first, first, 0 };
+				continue;
+			}
+			const float next = tileCenter(first + 1, length, tiles);
+			const int weight = static_cast<int>((position - center) / (next - center) * 256.0f + 0.5f);
+			weights[i] = { first, first + 1, weight };
+		}
+	}
+}
+
+void NativeEngine::Clahe(const unsigned char* gray, unsigned char* dst, int width, int height, const ClaheOptions& options, ScratchPool& scratch) {
+	if (gray == nullptr || dst == nullptr || width <= 0 || height <= 0) return;
+
+	const int tilesX = std::clamp(options.tilesX, 1, width);
+	const int tilesY = std::clamp(options.tilesY, 1, height);
+	const int tileCount = tilesX * tilesY;
+
+	// 1. 타일별 히스토그램 -> 자르기 -> 표 (타일 단위 병렬)
+	ScratchBuffer<unsigned char> tables(scratch, static_cast<size_t>(tileCount) * histogramBins);
+#pragma omp parallel for schedule(dynamic)
+	for (int tile = 0; tile < tileCount; tile++) {
+		const int x0 = tileStart(tile % tilesX, width, tilesX);
+		const int y0 = tileStart(tile / tilesX, height, tilesY);
+		const int w = tileStart(tile % tilesX + 1, width, tilesX) - x0;
+		const int h = tileStart(tile / tilesX + 1, height, tilesY) - y0;
+		unsigned char* table = tables.data() + static_cast<size_t>(tile) * histogramBins;
+
+		Histogram histogram;
+		AccumulateHistogram(gray + static_cast<size_t>(y0) * width + x0, w, h, width, histogram);
+		const unsigned int area = static_cast<unsigned int>(w) * h;
+		if (options.clipLimit > 0.0f) {
+			const float limit = options.clipLimit * static_cast<float>(area) / histogramBins;
+			clipHistogram(histogram.counts, std::max(1u, static_cast<unsigned int>(limit)));
+		}
+
+		// 누적 분포 * 255 / 넓이 (반올림)
+		unsigned long long cdf = 0;
+		for (int i = 0; i < histogramBins; i++) {
+			cdf += histogram.counts[i];
+			table[i] = static_cast<unsigned char>(std::min<unsigned long long>(255, (cdf * 255 + area / 2) / area));
+		}
+	}
+
+	// 2. 픽셀마다 주변 4타일 표를 쌍선형 보간 (가중치 8비트 고정소수점)
+	ScratchBuffer<TileWeight> columns(scratch, width);
+	ScratchBuffer<TileWeight> rows(scratch, height);
+	tileWeights(columns.data(), width, tilesX);
+	tileWeights(rows.data(), height, tilesY);
+	const unsigned char* lut = tables.data();
+
+#pragma omp parallel for schedule(static)
+	for (int y = 0; y < height; y++) {
+		const TileWeight& row = rows[y];
+		const unsigned char* topTables = lut + static_cast<size_t>(row.first) * tilesX * histogramBins;
+		const unsigned char* bottomTables = lut + static_cast<size_t>(row.second) * tilesX * histogramBins;
+		const int wy = row.weight;
+		const unsigned char* in = gray + static_cast<size_t>(y) * width;
+		unsigned char* out = dst + static_cast<size_t>(y) * width;
+
+		for (int x = 0; x < width; x++) {
+			const TileWeight& column = columns[x];
+			const int v = in[x];
+			const size_t left = static_cast<size_t>(column.first) * histogramBins + v;
+			const size_t right = static_cast<size_t>(column.second) * histogramBins + v;
+			const int wx = column.weight;
+			const int top = (256 - wx) * topTables[left] + wx * topTables[right];
+			const int bottom = (256 - wx) * bottomTables[left] + wx * bottomTables[right];
+			out[x] = static_cast<unsigned char>(((256 - wy) * top + wy * bottom + 32768) >> 16);
+		}
+	}
+}
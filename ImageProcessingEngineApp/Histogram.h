@@ -0,0 +1,71 @@
+﻿#pragma once
+
+#include <cstddef>
+#include "ImageView.h"
+#include "ScratchPool.h"
+
+namespace NativeEngine {
+	constexpr int histogramBins = 256;
+
+	struct Histogram {
+		unsigned int counts[histogramBins] = {};
+
+		unsigned long long Total() const {
+			unsigned long long total = 0;
+			for (int i = 0; i < histogramBins; i++) total += counts[i];
+			return total;
+		}
+	};
+
+	// 채널별 + 휘도 (채널 이름은 레이아웃과 무관하게 실제 색)
+	struct ImageHistograms {
+		Histogram blue;
+		Histogram green;
+		Histogram red;
+		Histogram alpha;
+		Histogram luminance;
+	};
+
+	// 세기는 스레드별 사본 (캐시 라인 정렬)에 4개 뱅크를 번갈아 써서 같은 값이 이어져도 증가가 서로 기다리지 않음
+	// 합치기는 스레드 사본을 칸 범위별로 나눠 병렬로 (임계 구역 없음)
+
+	// 8비트 평면 width x height, 행 간격 stride 바이트 (ROI는 시작 포인터와 stride로)
+	void ComputeHistogram(const unsigned char* plane, int width, int height, size_t stride, Histogram& histogram);
+
+	// 한 스레드에서 (타일처럼 작은 영역을 여러 개 병렬로 셀 때), histogram에 더함
+	void AccumulateHistogram(const unsigned char* plane, int width, int height, size_t stride, Histogram& histogram);
+
+	// BGRA/RGBA 뷰 (ROI는 SubView), 휘도는 스레드별 한 행씩 변환해서 셈
+	void ComputeHistograms(const ImageView& image, ImageHistograms& histograms, ScratchPool& scratch);
+
+	// 평활화 표 (누적 분포를 0~255로 펼침, 가장 어두운 값이 0), 한 값만 있으면 항등
+	void EqualizationTable(const Histogram& histogram, unsigned char* table);
+
+	// 8비트 평면에 표 적용 (src와 dst는 같아도 됨)
+	void ApplyLookupTable(const unsigned char* src, unsigned char* dst, size_t count, const unsigned char* table);
+
+	// 다중 Otsu 클래스 수 상한
+	constexpr int multiOtsuMaxClasses = 8;
+
+	// 클래스 간 분산 최대가 되는 임계값 classes - 1개 (오름차순, 값 > thresholds[i]면 i + 1 클래스 이상)
+	// 누적 표 P(i) = 칸 수 합, S(i) = 값 * 칸 수 합으로 구간 [a, b]의 S^2 / P를 256 x 256 표로 한 번 만들고
+	// 클래스를 하나씩 늘리는 동적 계획법으로 찾음 (classes * 256^2, 전수 조합과 같은 답)
+	// classes는 2 ~ multiOtsuMaxClasses로 잘림, 반환값은 임계값 수, 표는 scratch에서 빌림
+	int MultiOtsuThresholds(const Histogram& histogram, int classes, int* thresholds, ScratchPool& scratch);
+
+	// 다중 Otsu 결과 표현
+	enum class MultiOtsuOutput {
+		Levels, // 클래스 k -> k * 255 / (classes - 1) 회색 (보기용)
+		Labels  // 클래스 번호 0 ~ classes - 1 그대로 (분할 후처리용)
+	};
+
+	struct ClaheOptions {
+		int tilesX = 8;         // 가로 타일 수
+		int tilesY = 8;         // 세로 타일 수
+		float clipLimit = 2.0f; // 칸 상한 = clipLimit * 타일 픽셀 수 / 256 (넘친 만큼은 모든 칸에 고르게), 0 이하면 자르지 않음
+	};
+
+	// 타일별 히스토그램을 병렬로 세고 잘라서 표를 만든 뒤, 픽셀은 가까운 타일 중심 4개의 표를 쌍선형 보간
+	// gray와 dst는 width * height, 같은 버퍼여도 됨
+	void Clahe(const unsigned char* gray, unsigned char* dst, int width, int height, const ClaheOptions& options, ScratchPool& scratch);
+}
@@ -10,8 +10,23 @@
 #include <omp.h>
 #include <fstream>
 #include <cstdio>
+#include "ImageView.h"
+#include "ScratchPool.h"
+#include "Morphology.h"
+#include "DistanceTransform.h"
+#include "SobelFilter.h"
+#include "CannyFilter.h"
+#include "StencilFilter.h"
+#include "ScaleSpace.h"
+#include "AdaptiveThreshold.h"
+#include "Histogram.h"
+#include "ConnectedComponents.h"
+#include "TemplateMatch.h"
 
-#ifdef IMAGEPROCESSINGENGINEAPP_EXPORTS
+//  ҽ  ũϴ (ġ CLI, ġũ,  ) export 
+#if defined(IMAGEPROCESSINGENGINE_STATIC) || !defined(_WIN32)
+#define ENGINE_API
+#elif defined(IMAGEPROCESSINGENGINEAPP_EXPORTS)
 #define ENGINE_API __declspec(dllexport)
 #else
 #define ENGINE_API __declspec(dllimport)
@@ -26,26 +41,131 @@ namespace NativeEngine {
 		//Ӽ
 		std::vector<std::vector<std::complex<double>>> _fftData;
 		std::vector<std::vector<std::complex<double>>> _fftDataBackup;
+		ScratchPool _scratch; // Ŀ ӽ 
 		void fftShift();
+
+		// ֵ  ĳ (Sobel -> ȭ  üο 纯ȯ )
+		std::vector<unsigned char> _grayPlane;
+		ImageView _grayPlaneKey;
+		bool _grayPlaneValid = false;
+		unsigned char* grayPlane(const ImageView& image, ScratchBuffer<unsigned char>& storage);
+		bool hasGrayPlane(const ImageView& image) const;
+		void storeGrayPlane(const ImageView& image, const unsigned char* plane);
+		void invalidateGrayPlane(const ImageView& image);
+
+		BinaryImage _binary; // Ÿ ȯ /   1Ʈ  (ũⰡ  ȣ⸶ )
+
+		void applyMorphology(const ImageView& image, int kernelWidth, int kernelHeight, MorphologyOp op, MorphologyChannels channels);
+		void extractMorphologyPlane(const ImageView& image, unsigned char* plane, int planeChannels);
+		template <typename Distance>
+		void distanceTransform(const ImageView& image, Distance* distances);
+		void applyDiskMorphology(const ImageView& image, float radius, bool dilate);
 		//
 		//ۺ ޼
 	public:
 		void ApplyGrayscale(unsigned char* data, int width, int height);
-		//void ApplyGaussianBlur(unsigned char* data, int width, int height, float sigma);
+		// þ ( sigma  , ū sigma  Ͷ ӵ sigma )
+		void ApplyGaussianBlur(unsigned char* data, int width, int height, float sigma);
+		// ڽ  ( ݰ)
 		void ApplyGaussianBlur(unsigned char* data, int width, int height, int radius);
 
 		void ApplyMedian(unsigned char* data, int width, int height, int kernelSize);
 		void ApplyBinarization(unsigned char* data, int width, int height);
+		// ȭ   (Otsu /  Ӱ谪 / Bradley, Sauvola  Ӱ谪)
+		void ApplyBinarization(unsigned char* data, int width, int height, const BinarizationOptions& options);
+		//  Otsu (classes Ŭ,  ȸ ܰ Ǵ Ŭ ȣ), thresholds: classes - 1 (nullptr )
+		void ApplyMultiOtsu(unsigned char* data, int width, int height, int classes,
+			MultiOtsuOutput output = MultiOtsuOutput::Levels, int* thresholds = nullptr);
 		void ApplyDilation(unsigned char* data, int width, int height);
 		void ApplyErosion(unsigned char* data, int width, int height);
+		// B, G, R, A, ֵ ׷ (̹ ״)
+		void ComputeHistograms(unsigned char* data, int width, int height, ImageHistograms& histograms);
+		// ֵ Ȱȭ ( ȸ)
+		void ApplyHistogramEqualization(unsigned char* data, int width, int height);
+		// ŸϺ   Ȱȭ ( ȸ)
+		void ApplyClahe(unsigned char* data, int width, int height, const ClaheOptions& options);
+		// 簢 kernelSize x kernelSize   (ũ ϰ ȼ  )
+		void ApplyDilation(unsigned char* data, int width, int height, int kernelSize);
+		void ApplyErosion(unsigned char* data, int width, int height, int kernelSize);
+		// //׷̵Ʈ/   (ħ, â  θ ͺ ̹ պ )
+		void ApplyMorphology(unsigned char* data, int width, int height, CompoundMorphology op, int kernelSize);
+		// Ŭ Ÿ ȯ (ȭ  , ֵ 128 ̻ )
+		//  ȼ    ȼ Ÿ,  0 (distances width * height)
+		void ApplyDistanceTransform(unsigned char* data, int width, int height, float* distances);
+		void ApplyDistanceTransform(unsigned char* data, int width, int height, unsigned short* distances);
+		//    â/ħ (ȭ ,  0/255),  ϰ ȼ  
+		void ApplyDiskDilation(unsigned char* data, int width, int height, float radius);
+		void ApplyDiskErosion(unsigned char* data, int width, int height, float radius);
+		//   󺧸 (ֵ 128 ̻ , ̹ ״), ȯ  
+		// labels: width * height (0 = , 1 ~  , nullptr ), blobs:   Һ / /߽
+		int LabelComponents(unsigned char* data, int width, int height, Connectivity connectivity, int* labels, std::vector<Blob>& blobs);
 		void ApplySobel(unsigned char* pixels, int width, int height);
+		// ũ   +   (width * height, GradientDirection , nullptr̸ )
+		void ApplySobel(unsigned char* pixels, int width, int height, GradientNorm norm, unsigned char* directions);
+		// Canny  (þ sigma, Һ ũ  Ӱ谪),  0/255  
+		void ApplyCanny(unsigned char* pixels, int width, int height, float sigma, int lowThreshold, int highThreshold);
 		void ApplyLaplacian(unsigned char* pixels, int width, int height);
-		void ApplyTemplateMatch(unsigned char* originalPixels, int width, int height, unsigned char* templatePixels, int templateWidth, int templateHeight, int* matchX, int* matchY);
+		// öþ Ŀ  (Laplacian4 / Laplacian8)
+		// Normalized: ִ  0~255 ȭ / Fixed: || 255 ڸ (ū ̹ ߰ ޸ )
+		void ApplyLaplacian(unsigned char* pixels, int width, int height, StencilOperator kernel,
+			LaplacianScale scale = LaplacianScale::Normalized);
+		// 3x3 ٽ  (öþ ApplyLaplacian  ȭ,  0~255 ڸ)
+		void ApplyStencil(unsigned char* pixels, int width, int height, StencilOperator op);
+		// DoG/LoG   Ƕ̵ (ֵ , ̹ ״),  space.arena  
+		void BuildScaleSpace(unsigned char* pixels, int width, int height, const ScaleSpaceOptions& options, ScaleSpace& space);
+		// ֵ SAD ּ ġ, Pyramid  ܰ迡  ĺ ֺ   ٽ Ž
+		void ApplyTemplateMatch(unsigned char* originalPixels, int width, int height, unsigned char* templatePixels, int templateWidth, int templateHeight, int* matchX, int* matchY,
+			const TemplateMatchOptions& options = TemplateMatchOptions());
 		bool ApplyFFT(unsigned char* data, int width, int height);
 		bool ApplyIFFT(unsigned char* data, int width, int height);
 		void ClearFFTData();
 		bool HasFFTData();
 
+		// ̹   (stride, ROI, ä   ,   ڸ ó)
+		void ApplyGrayscale(const ImageView& image);
+		void ApplyGaussianBlur(const ImageView& image, float sigma);
+		void ApplyGaussianBlur(const ImageView& image, int radius);
+		void ApplyMedian(const ImageView& image, int kernelSize);
+		void ApplyBinarization(const ImageView& image);
+		void ApplyBinarization(const ImageView& image, const BinarizationOptions& options);
+		void ApplyMultiOtsu(const ImageView& image, int classes, MultiOtsuOutput output = MultiOtsuOutput::Levels, int* thresholds = nullptr);
+		void ApplyDilation(const ImageView& image);
+		void ApplyErosion(const ImageView& image);
+		// ROI  SubView
+		void ComputeHistograms(const ImageView& image, ImageHistograms& histograms);
+		void ApplyHistogramEqualization(const ImageView& image);
+		void ApplyClahe(const ImageView& image, const ClaheOptions& options);
+		// 簢  ,  1 ָ / 
+		// ⺻ äκ (Gray B ä   B, G, R  )
+		void ApplyDilation(const ImageView& image, int kernelWidth, int kernelHeight, MorphologyChannels channels = MorphologyChannels::Color);
+		void ApplyErosion(const ImageView& image, int kernelWidth, int kernelHeight, MorphologyChannels channels = MorphologyChannels::Color);
+		void ApplyMorphology(const ImageView& image, CompoundMorphology op, int kernelWidth, int kernelHeight,
+			MorphologyChannels channels = MorphologyChannels::Color);
+		void ApplyDistanceTransform(const ImageView& image, float* distances);
+		void ApplyDistanceTransform(const ImageView& image, unsigned short* distances);
+		void ApplyDiskDilation(const ImageView& image, float radius);
+		void ApplyDiskErosion(const ImageView& image, float radius);
+		int LabelComponents(const ImageView& image, Connectivity connectivity, int* labels, std::vector<Blob>& blobs);
+		void ApplySobel(const ImageView& image, GradientNorm norm = GradientNorm::L2, unsigned char* directions = nullptr);
+		void ApplyCanny(const ImageView& image, float sigma, int lowThreshold, int highThreshold, GradientNorm norm = GradientNorm::L2);
+		void ApplyLaplacian(const ImageView& image, StencilOperator kernel = StencilOperator::Laplacian8,
+			LaplacianScale scale = LaplacianScale::Normalized);
+		void ApplyStencil(const ImageView& image, StencilOperator op);
+		void BuildScaleSpace(const ImageView& image, const ScaleSpaceOptions& options, ScaleSpace& space);
+		void ApplyTemplateMatch(const ImageView& original, const ImageView& templ, int* matchX, int* matchY,
+			const TemplateMatchOptions& options = TemplateMatchOptions());
+		bool ApplyFFT(const ImageView& image);
+		bool ApplyIFFT(const ImageView& image);
+
+		// ӽ  Ǯ  (Ʈ)
+		size_t GetScratchHighWaterMark();
+		size_t GetScratchReservedBytes();
+		size_t GetScratchHeapAllocations();
+		void TrimScratch();
+
+		// ֵ  ĳ 
+		void ClearGrayPlaneCache();
+
 		//Ʈ, ̺ ޼
 		//ø Ŭ
 	};
@@ -0,0 +1,58 @@
+﻿#pragma once
+
+#include <algorithm>
+
+namespace NativeEngine {
+	// 픽셀 배치 (모두 4바이트 픽셀, 채널 순서만 다름)
+	enum class PixelLayout {
+		Bgra32, // WPF Bgra32, 엔진 기본
+		Rgba32
+	};
+
+	// 외부 버퍼를 복사 없이 가리키는 이미지 뷰
+	// stride는 바이트 단위, 패딩/정렬된 버퍼나 원본 이미지의 일부 영역(ROI)도 그대로 처리
+	struct ImageView {
+		unsigned char* data = nullptr;
+		int width = 0;
+		int height = 0;
+		int stride = 0;
+		PixelLayout layout = PixelLayout::Bgra32;
+
+		// 버퍼 내용 버전, 0이 아니면 엔진이 휘도 평면을 캐시해서 재사용 (0이면 캐시 안 함, 포인터 API는 항상 0)
+		// 엔진이 버퍼를 고치는 동안은 같은 값 그대로, 엔진 밖에서 버퍼를 고치면 값을 바꿔야 함
+		// 배치 CLI는 파일마다, 래퍼 ImageEngine은 관리 배열마다 새 값을 줌
+		unsigned long long generation = 0;
+
+		static constexpr int channels = 4;
+
+		ImageView() = default;
+
+		// 기존 (data, width, height) 호출과 같은 빽빽한 BGRA 버퍼
+		ImageView(unsigned char* data, int width, int height)
+			: data(data), width(width), height(height), stride(width * channels) {}
+
+		ImageView(unsigned char* data, int width, int height, int stride, PixelLayout layout = PixelLayout::Bgra32)
+			: data(data), width(width), height(height), stride(stride), layout(layout) {}
+
+		unsigned char* Row(int y) const { return data + static_cast<long long>(y) * stride; }
+		unsigned char* Pixel(int x, int y) const { return Row(y) + x * channels; }
+
+		bool IsValid() const { return data != nullptr && width > 0 && height > 0 && stride >= width * channels; }
+		bool IsContiguous() const { return stride == width * channels; }
+
+		// 채널 순서 (그레이스케일 가중치 계산용)
+		int BlueOffset() const { return layout == PixelLayout::Bgra32 ? 0 : 2; }
+		int RedOffset() const { return layout == PixelLayout::Bgra32 ? 2 : 0; }
+
+		// 영역 잘라내기, 이미지 밖은 잘림
+		ImageView SubView(int x, int y, int w, int h) const {
+			const int x0 = std::clamp(x, 0, width);
+			const int y0 = std::clamp(y, 0, height);
+			const int x1 = std::clamp(x + w, x0, width);
+			const int y1 = std::clamp(y + h, y0, height);
+			ImageView view(Pixel(x0, y0), x1 - x0, y1 - y0, stride, layout);
+			view.generation = generation;
+			return view;
+		}
+	};
+}
@@ -0,0 +1,146 @@
+﻿#include <omp.h>
+#include <algorithm>
+#include "IntegralImage.h"
+
+using namespace std;
+
+namespace {
+	template <typename T, bool squared>
+	inline T term(unsigned char v) {
+		if constexpr (squared) return static_cast<T>(static_cast<unsigned int>(v) * v);
+		else return static_cast<T>(v);
+	}
+
+	// 표 하나 두 단계 누적 (가로 누적은 직렬, 위 행 더하기는 벡터화되도록 따로 돎)
+	template <typename T, bool squared>
+	void buildTable(const unsigned char* gray, int width, int height, T* table) {
+		const size_t stride = static_cast<size_t>(width) + 1;
+		int threads = 1;
+
+#pragma omp parallel
+		{
+#pragma omp single
+			threads = omp_get_num_threads();
+
+			const int strip = (height + threads - 1) / threads;
+			const int y0 = std::min(height, omp_get_thread_num() * strip);
+			const int y1 = std::min(height, y0 + strip);
+
+			if (omp_get_thread_num() == 0) std::fill(table, table + stride, T(0));
+			for (int y = y0; y < y1; y++) {
+				const unsigned char* row = gray + static_cast<size_t>(y) * width;
+				T* out = table + (y + 1) * stride;
+				T running = 0;
+				out[0] = 0;
+				for (int x = 0; x < width; x++) {
+					running += term<T, squared>(row[x]);
+					out[x + 1] = running;
+				}
+				if (y > y0) {
+					const T* above = out - stride;
+					for (size_t x = 1; x < stride; x++) out[x] += above[x];
+				}
+			}
+#pragma omp barrier
+
+			// 띠 마지막 행 (표 행 y1)을 위에서부터 차례로 완성
+#pragma omp single
+			for (int t = 1; t < threads; t++) {
+				const int top = std::min(height, t * strip);
+				const int bottom = std::min(height, top + strip);
+				if (top >= bottom) break;
+				T* last = table + bottom * stride;
+				const T* offset = table + top * stride;
+				for (size_t x = 1; x < stride; x++) last[x] += offset[x];
+			}
+
+			// 나머지 행에 앞 띠 마지막 행 (표 행 y0)을 더함
+			if (y0 > 0) {
+				const T* offset = table + y0 * stride;
+				for (int r = y0 + 1; r < y1; r++) {
+					T* out = table + r * stride;
+					for (size_t x = 1; x < stride; x++) out[x] += offset[x];
+				}
+			}
+		}
+	}
+
+	// 크기가 모자랄 때만 다시 빌림
+	template <typename T>
+	void reserveTable(NativeEngine::ScratchBuffer<T>& buffer, NativeEngine::ScratchPool& scratch, size_t count) {
+		if (buffer.data() == nullptr || buffer.size() < count) buffer = NativeEngine::ScratchBuffer<T>(scratch, count);
+	}
+
+	// 이미지 전체 합이 32비트에 들어가는지
+	bool needsWide(int width, int height, unsigned long long maxTerm) {
+		return static_cast<unsigned long long>(width) * height * maxTerm > 0xFFFFFFFFull;
+	}
+}
+
+void NativeEngine::IntegralImage::Build(const unsigned char* gray, int width, int height, bool squares) {
+	_width = 0;
+	_height = 0;
+	_hasSquares = false;
+	if (gray == nullptr || width <= 0 || height <= 0) return;
+
+	_width = width;
+	_height = height;
+	_hasSquares = squares;
+	_wideSum = needsWide(width, height, 255);
+	_wideSquares = needsWide(width, height, 255 * 255);
+
+	const size_t tableSize = (static_cast<size_t>(width) + 1) * (static_cast<size_t>(height) + 1);
+
+	if (_wideSum) {
+		reserveTable(_sum64, *_scratch, tableSize);
+		buildTable<unsigned long long, false>(gray, width, height, _sum64.data());
+	}
+	else {
+		reserveTable(_sum32, *_scratch, tableSize);
+		buildTable<unsigned int, false>(gray, width, height, _sum32.data());
+	}
+	if (!squares) return;
+	if (_wideSquares) {
+		reserveTable(_squares64, *_scratch, tableSize);
+		buildTable<unsigned long long, true>(gray, width, height, _squares64.data());
+	}
+	else {
+		reserveTable(_squares32, *_scratch, tableSize);
+		buildTable<unsigned int, true>(gray, width, height, _squares32.data());
+	}
+}
+
+bool NativeEngine::IntegralImage::clip(int& x0, int& y0, int& x1, int& y1) const {
+	x0 = std::clamp(x0, 0, _width);
+	x1 = std::clamp(x1, 0, _width);
+	y0 = std::clamp(y0, 0, _height);
+	y1 = std::clamp(y1, 0, _height);
+	return x0 < x1 && y0 < y1;
+}
+
+unsigned long long NativeEngine::IntegralImage::Sum(int x0, int y0, int x1, int y1) const {
+	if (!clip(x0, y0, x1, y1)) return 0;
+	unsigned long long result = 0;
+	VisitSum([&](const auto& sum) { result = sum.Sum(x0, y0, x1, y1); });
+	return result;
+}
+
+unsigned long long NativeEngine::IntegralImage::SquareSum(int x0, int y0, int x1, int y1) const {
+	if (!_hasSquares || !clip(x0, y0, x1, y1)) return 0;
+	unsigned long long result = 0;
+	Visit([&](const auto&, const auto& squares) { result = squares.Sum(x0, y0, x1, y1); });
+	return result;
+}
+
+double NativeEngine::IntegralImage::Mean(int x0, int y0, int x1, int y1) const {
+	if (!clip(x0, y0, x1, y1)) return 0.0;
+	const double area = static_cast<double>(x1 - x0) * (y1 - y0);
+	return static_cast<double>(Sum(x0, y0, x1, y1)) / area;
+}
+
+double NativeEngine::IntegralImage::Variance(int x0, int y0, int x1, int y1) const {
+	if (!_hasSquares || !clip(x0, y0, x1, y1)) return 0.0;
+	const double area = static_cast<double>(x1 - x0) * (y1 - y0);
+	const double mean = static_cast<double>(Sum(x0, y0, x1, y1)) / area;
+	return std::max(0.0, static_cast<double>(SquareSum(x0, y0, x1, y1)) / area - mean * mean);
+}
@@ -0,0 +1,82 @@
+﻿#pragma once
+
+#include <algorithm>
+#include "ScratchPool.h"
+
+namespace NativeEngine {
+	// 적분 영상 한 장 (width + 1) x (height + 1), 0행/0열은 0, (x, y)는 휘도 [0, x) x [0, y) 누적
+	template <typename T>
+	struct IntegralTable {
+		const T* data = nullptr;
+		size_t stride = 0;
+
+		const T* Row(int y) const { return data + static_cast<size_t>(y) * stride; }
+
+		// [x0, x1) x [y0, y1) 합, 범위 검사 없음 (픽셀 루프용)
+		T Sum(int x0, int y0, int x1, int y1) const {
+			const T* top = Row(y0);
+			const T* bottom = Row(y1);
+			return bottom[x1] - bottom[x0] - top[x1] + top[x0];
+		}
+	};
+
+	// 휘도 합 / 휘도 제곱 합 적분 영상 (창 합, 평균, 분산을 창 크기와 무관하게 모서리 네 개로)
+	// 누적 폭은 이미지 크기로 정함: 전체 합이 2^32 미만이면 32비트 (합은 16843009픽셀, 제곱 합은 66051픽셀까지), 아니면 64비트
+	// 만들기는 두 단계: 스레드 띠마다 띠 안에서 누적 -> 띠 마지막 행을 위에서부터 이어 붙이고 나머지 행에 앞 띠 값을 더함
+	// 표는 생성자에 준 풀에서 빌림 (객체가 사라질 때 반납)
+	class IntegralImage {
+	public:
+		explicit IntegralImage(ScratchPool& scratch) : _scratch(&scratch) {}
+
+		// gray: width * height 휘도, squares가 false면 제곱 합 표는 만들지 않음
+		void Build(const unsigned char* gray, int width, int height, bool squares = false);
+
+		int Width() const { return _width; }
+		int Height() const { return _height; }
+		bool HasSquares() const { return _hasSquares; }
+		bool WideSum() const { return _wideSum; }
+		bool WideSquares() const { return _wideSquares; }
+
+		// 사각형 [x0, x1) x [y0, y1) 질의, 좌표는 이미지 안으로 잘림 (빈 사각형은 0)
+		unsigned long long Sum(int x0, int y0, int x1, int y1) const;
+		unsigned long long SquareSum(int x0, int y0, int x1, int y1) const;
+		double Mean(int x0, int y0, int x1, int y1) const;
+		double Variance(int x0, int y0, int x1, int y1) const;
+
+		// 누적 폭이 정해진 표로 f 호출 (픽셀 루프 안에서 폭 분기 없이)
+		// VisitSum: f(sumTable), Visit: f(sumTable, squareTable) (HasSquares일 때만)
+		template <class F>
+		void VisitSum(F&& f) const {
+			if (_wideSum) f(table(_sum64));
+			else f(table(_sum32));
+		}
+
+		template <class F>
+		void Visit(F&& f) const {
+			VisitSum([&](const auto& sum) {
+				if (_wideSquares) f(sum, table(_squares64));
+				else f(sum, table(_squares32));
+			});
+		}
+
+	private:
+		template <typename T>
+		IntegralTable<T> table(const ScratchBuffer<T>& buffer) const {
+			return { buffer.data(), static_cast<size_t>(_width) + 1 };
+		}
+
+		// 잘린 사각형이 비었으면 false
+		bool clip(int& x0, int& y0, int& x1, int& y1) const;
+
+		ScratchPool* _scratch;
+		int _width = 0;
+		int _height = 0;
+		bool _hasSquares = false;
+		bool _wideSum = false;
+		bool _wideSquares = false;
+		ScratchBuffer<unsigned int> _sum32;
+		ScratchBuffer<unsigned long long> _sum64;
+		ScratchBuffer<unsigned int> _squares32;
+		ScratchBuffer<unsigned long long> _squares64;
+	};
+}
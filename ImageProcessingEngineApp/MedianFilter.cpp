@@ -0,0 +1,360 @@
+﻿#include <omp.h>
+#include <algorithm>
+#include <cstring>
+#include "MedianFilter.h"
+#include "Simd.h"
+
+using namespace std;
+
+namespace {
+	constexpr int coarseBins = 16;
+	constexpr int fineBins = 256;
+
+	// 열 히스토그램 (채널 하나), 개수는 창 높이 이하라 16비트로 충분
+	struct ColumnHistograms {
+		unsigned short* coarse; // [x][16]
+		unsigned short* fine;   // [x][256] = [x][coarse][16]
+
+		void Add(int x, unsigned char v) {
+			coarse[x * coarseBins + (v >> 4)]++;
+			fine[x * fineBins + v]++;
+		}
+
+		void Remove(int x, unsigned char v) {
+			coarse[x * coarseBins + (v >> 4)]--;
+			fine[x * fineBins + v]--;
+		}
+	};
+
+	inline void addBins(unsigned short* dst, const unsigned short* src) {
+		for (int i = 0; i < 16; i++) dst[i] += src[i];
+	}
+
+	inline void subBins(unsigned short* dst, const unsigned short* src) {
+		for (int i = 0; i < 16; i++) dst[i] -= src[i];
+	}
+
+	// 띠 [y0, y1) 채널 하나
+	void medianStripChannel(const NativeEngine::ImageView& src, const NativeEngine::ImageView& dst,
+		int channel, int radius, int rank, int y0, int y1, ColumnHistograms cols)
+	{
+		const int width = src.width;
+		const int height = src.height;
+		const int window = 2 * radius + 1;
+		auto clampX = [&](int x) { return std::clamp(x, 0, width - 1); };
+		auto clampY = [&](int y) { return std::clamp(y, 0, height - 1); };
+
+		// 첫 행의 창 높이만큼 열 히스토그램 채우기
+		memset(cols.coarse, 0, sizeof(unsigned short) * coarseBins * width);
+		memset(cols.fine, 0, sizeof(unsigned short) * fineBins * width);
+		for (int ky = -radius; ky <= radius; ky++) {
+			const unsigned char* row = src.Row(clampY(y0 + ky));
+			for (int x = 0; x < width; x++) cols.Add(x, row[x * 4 + channel]);
+		}
+
+		for (int y = y0; y < y1; y++) {
+			// 한 행 내려가기: 맨 위 행 빼고 새 행 더하기
+			if (y > y0) {
+				const unsigned char* oldRow = src.Row(clampY(y - radius - 1));
+				const unsigned char* newRow = src.Row(clampY(y + radius));
+				for (int x = 0; x < width; x++) {
+					cols.Remove(x, oldRow[x * 4 + channel]);
+					cols.Add(x, newRow[x * 4 + channel]);
+				}
+			}
+
+			// 창 coarse 히스토그램은 매 열 갱신, fine은 필요한 칸만 늦게 따라잡음
+			alignas(16) unsigned short coarse[coarseBins] = { 0 };
+			alignas(16) unsigned short fine[coarseBins][16] = { { 0 } };
+			int lastUpdated[coarseBins];
+			for (int k = 0; k < coarseBins; k++) lastUpdated[k] = -window - 1; // 아직 안 채움
+
+			for (int kx = -radius; kx <= radius; kx++) addBins(coarse, cols.coarse + clampX(kx) * coarseBins);
+
+			unsigned char* out = dst.Row(y);
+			for (int x = 0; x < width; x++) {
+				if (x > 0) {
+					subBins(coarse, cols.coarse + clampX(x - radius - 1) * coarseBins);
+					addBins(coarse, cols.coarse + clampX(x + radius) * coarseBins);
+				}
+
+				// coarse에서 중앙값이 든 칸 찾기
+				int k = 0;
+				int count = 0;
+				while (k < coarseBins - 1 && count + coarse[k] <= rank) count += coarse[k++];
+
+				// 그 칸의 fine 히스토그램을 현재 x까지 맞춤
+				unsigned short* bins = fine[k];
+				if (x - lastUpdated[k] >= window) {
+					memset(bins, 0, sizeof(unsigned short) * 16);
+					for (int kx = -radius; kx <= radius; kx++) {
+						addBins(bins, cols.fine + clampX(x + kx) * fineBins + k * 16);
+					}
+				}
+				else {
+					for (int j = lastUpdated[k] + 1; j <= x; j++) {
+						subBins(bins, cols.fine + clampX(j - radius - 1) * fineBins + k * 16);
+						addBins(bins, cols.fine + clampX(j + radius) * fineBins + k * 16);
+					}
+				}
+				lastUpdated[k] = x;
+
+				int v = 0;
+				while (v < 15 && count + bins[v] <= rank) count += bins[v++];
+				out[x * 4 + channel] = static_cast<unsigned char>(k * 16 + v);
+			}
+		}
+	}
+}
+
+void NativeEngine::MedianHistogram(const ImageView& src, const ImageView& dst, int radius, int rank, ScratchPool& scratch) {
+	const int width = src.width;
+	const int height = src.height;
+
+#pragma omp parallel
+	{
+		// 스레드마다 연속된 행 띠 하나 (띠 시작마다 열 히스토그램을 새로 채우므로 띠는 크게)
+		const int threads = omp_get_num_threads();
+		const int strip = (height + threads - 1) / threads;
+		const int y0 = std::min(height, omp_get_thread_num() * strip);
+		const int y1 = std::min(height, y0 + strip);
+
+		if (y0 < y1) {
+			ScratchBuffer<unsigned short> coarse(scratch, static_cast<size_t>(width) * coarseBins);
+			ScratchBuffer<unsigned short> fine(scratch, static_cast<size_t>(width) * fineBins);
+			const ColumnHistograms cols{ coarse.data(), fine.data() };
+
+			for (int c = 0; c < 3; c++) {
+				medianStripChannel(src, dst, c, radius, rank, y0, y1, cols);
+			}
+			for (int y = y0; y < y1; y++) {
+				const unsigned char* in = src.Row(y);
+				unsigned char* out = dst.Row(y);
+				for (int x = 0; x < width; x++) out[x * 4 + 3] = in[x * 4 + 3]; // 알파 유지
+			}
+		}
+	}
+}
+
+// ---------------------------------------------------------------------------
+// 3x3, 5x5 정렬 네트워크
+// ---------------------------------------------------------------------------
+
+#ifdef ENGINE_SSE2
+namespace {
+	// 바이트 레인마다 독립적인 min/max (BGRA 채널이 레인 하나씩이라 채널 구분 없이 처리)
+	// 멤버는 일반 inline (GCC는 강제 인라인 시 대상 ISA가 다른 호출부를 거부), 네트워크를 강제 인라인해 AVX2 함수 안에서 펼침
+	struct Sse2Ops {
+		using V = __m128i;
+		static constexpr int bytes = 16;
+
+		static void Load(V& v, const unsigned char* p) { v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+		static void Store(unsigned char* p, const V& v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+		static void Sort2(V& a, V& b) { const V t = _mm_min_epu8(a, b); b = _mm_max_epu8(a, b); a = t; }
+		static void KeepMin(V& a, const V& b) { a = _mm_min_epu8(a, b); }
+		static void KeepMax(V& a, const V& b) { a = _mm_max_epu8(a, b); }
+
+		// 알파 바이트는 원본 값
+		static void KeepAlpha(V& v, const V& original) {
+			const V alpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+			v = _mm_or_si128(_mm_andnot_si128(alpha, v), _mm_and_si128(alpha, original));
+		}
+	};
+
+	struct Avx2Ops {
+		using V = __m256i;
+		static constexpr int bytes = 32;
+
+		static ENGINE_TARGET_AVX2 void Load(V& v, const unsigned char* p) { v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+		static ENGINE_TARGET_AVX2 void Store(unsigned char* p, const V& v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+		static ENGINE_TARGET_AVX2 void Sort2(V& a, V& b) { const V t = _mm256_min_epu8(a, b); b = _mm256_max_epu8(a, b); a = t; }
+		static ENGINE_TARGET_AVX2 void KeepMin(V& a, const V& b) { a = _mm256_min_epu8(a, b); }
+		static ENGINE_TARGET_AVX2 void KeepMax(V& a, const V& b) { a = _mm256_max_epu8(a, b); }
+
+		static ENGINE_TARGET_AVX2 void KeepAlpha(V& v, const V& original) {
+			const V alpha = _mm256_set1_epi32(static_cast<int>(0xFF000000u));
+			v = _mm256_or_si256(_mm256_andnot_si256(alpha, v), _mm256_and_si256(alpha, original));
+		}
+	};
+
+	// 창 값 배치: v[열 * Size + 행], 각 열은 SortColumn으로 먼저 오름차순 정렬된 상태
+	// Select 후 중앙값은 v[center]
+	// Select는 정렬된 열을 전제로 불필요한 비교를 뺀 네트워크 (0-1 원리로 모든 경우 확인)
+	template <int Size>
+	struct MedianNetwork;
+
+	template <>
+	struct MedianNetwork<3> {
+		static constexpr int center = 4;
+
+		template <class Ops>
+		static ENGINE_FORCEINLINE void SortColumn(typename Ops::V* v) {
+			Ops::Sort2(v[0], v[1]); Ops::Sort2(v[1], v[2]); Ops::Sort2(v[0], v[1]);
+		}
+
+		// 최솟값들의 최대, 중간값들의 중앙, 최댓값들의 최소 -> 셋의 중앙
+		template <class Ops>
+		static ENGINE_FORCEINLINE void Select(typename Ops::V* v) {
+			Ops::KeepMax(v[3], v[0]); Ops::KeepMax(v[6], v[3]);
+			Ops::KeepMin(v[2], v[5]); Ops::KeepMin(v[2], v[8]);
+			Ops::Sort2(v[1], v[4]); Ops::KeepMin(v[4], v[7]); Ops::KeepMax(v[4], v[1]);
+			Ops::Sort2(v[2], v[4]); Ops::KeepMin(v[4], v[6]); Ops::KeepMax(v[4], v[2]);
+		}
+	};
+
+	template <>
+	struct MedianNetwork<5> {
+		static constexpr int center = 12;
+
+		template <class Ops>
+		static ENGINE_FORCEINLINE void SortColumn(typename Ops::V* v) {
+			Ops::Sort2(v[0], v[1]); Ops::Sort2(v[3], v[4]); Ops::Sort2(v[2], v[4]);
+			Ops::Sort2(v[2], v[3]); Ops::Sort2(v[0], v[3]); Ops::Sort2(v[0], v[2]);
+			Ops::Sort2(v[1], v[4]); Ops::Sort2(v[1], v[3]); Ops::Sort2(v[1], v[2]);
+		}
+
+		// 106 min/max (전체 정렬 기반 네트워크에서 가지치기)
+		template <class Ops>
+		static ENGINE_FORCEINLINE void Select(typename Ops::V* v) {
+			Ops::Sort2(v[0], v[5]); Ops::Sort2(v[10], v[15]); Ops::KeepMax(v[15], v[0]); Ops::Sort2(v[5], v[15]);
+			Ops::Sort2(v[1], v[6]); Ops::Sort2(v[16], v[21]); Ops::Sort2(v[11], v[21]); Ops::Sort2(v[11], v[16]);
+			Ops::KeepMax(v[16], v[1]); Ops::Sort2(v[6], v[21]); Ops::Sort2(v[6], v[16]); Ops::Sort2(v[2], v[7]);
+			Ops::Sort2(v[17], v[22]); Ops::Sort2(v[12], v[17]); Ops::Sort2(v[2], v[17]); Ops::KeepMax(v[12], v[2]);
+			Ops::Sort2(v[7], v[22]); Ops::Sort2(v[7], v[17]); Ops::Sort2(v[7], v[12]); Ops::Sort2(v[3], v[8]);
+			Ops::Sort2(v[18], v[23]); Ops::Sort2(v[13], v[23]); Ops::Sort2(v[13], v[18]); Ops::Sort2(v[3], v[13]);
+			Ops::Sort2(v[8], v[18]); Ops::Sort2(v[8], v[13]); Ops::Sort2(v[19], v[24]); Ops::Sort2(v[14], v[19]);
+			Ops::KeepMin(v[4], v[19]); Ops::KeepMin(v[9], v[24]); Ops::Sort2(v[4], v[5]); Ops::Sort2(v[14], v[15]);
+			Ops::KeepMin(v[22], v[23]); Ops::KeepMax(v[6], v[4]); Ops::Sort2(v[5], v[7]); Ops::Sort2(v[9], v[11]);
+			Ops::Sort2(v[12], v[14]); Ops::KeepMin(v[13], v[15]); Ops::Sort2(v[13], v[14]); Ops::KeepMin(v[21], v[22]);
+			Ops::Sort2(v[8], v[12]); Ops::Sort2(v[16], v[20]); Ops::KeepMin(v[17], v[21]); Ops::KeepMax(v[5], v[3]);
+			Ops::Sort2(v[11], v[13]); Ops::KeepMin(v[18], v[20]); Ops::Sort2(v[11], v[12]); Ops::KeepMin(v[13], v[14]);
+			Ops::Sort2(v[17], v[18]); Ops::KeepMax(v[9], v[5]); Ops::KeepMax(v[10], v[6]); Ops::Sort2(v[7], v[11]);
+			Ops::Sort2(v[7], v[9]); Ops::Sort2(v[10], v[12]); Ops::Sort2(v[11], v[13]); Ops::KeepMax(v[8], v[7]);
+			Ops::KeepMax(v[10], v[9]); Ops::Sort2(v[11], v[12]); Ops::KeepMax(v[16], v[8]); Ops::KeepMin(v[10], v[18]);
+			Ops::KeepMin(v[12], v[16]); Ops::KeepMin(v[13], v[17]); Ops::KeepMax(v[12], v[10]); Ops::KeepMin(v[11], v[13]);
+			Ops::KeepMax(v[12], v[11]);
+		}
+	};
+
+	// 행 버퍼 한 줄: 좌우로 radius 픽셀 복제 + 벡터 한 개 여유
+	struct NetworkLines {
+		unsigned char* ring;   // 원본 행 Size개 (행 번호 % Size 위치)
+		unsigned char* sorted; // 열 정렬 결과 Size개 (순위별)
+		size_t lineBytes;
+	};
+
+	template <int Size>
+	void fillLine(unsigned char* line, const unsigned char* row, int width) {
+		constexpr int radius = Size / 2;
+		memcpy(line + radius * 4, row, static_cast<size_t>(width) * 4);
+		for (int i = 0; i < radius; i++) {
+			memcpy(line + i * 4, row, 4);
+			memcpy(line + (radius + width + i) * 4, row + (width - 1) * 4, 4);
+		}
+	}
+
+	// 띠 [y0, y1) 처리, 열 정렬은 행마다 한 번만 하고 가로로 이웃한 Size개 창이 공유
+	template <class Ops, int Size>
+	ENGINE_FORCEINLINE void medianNetworkRows(const NativeEngine::ImageView& src, const NativeEngine::ImageView& dst,
+		int y0, int y1, const NetworkLines& lines)
+	{
+		using V = typename Ops::V;
+		using Network = MedianNetwork<Size>;
+		constexpr int radius = Size / 2;
+		const int width = src.width;
+		const int height = src.height;
+		const int paddedBytes = (width + 2 * radius) * 4;
+		const int rowBytes = width * 4;
+
+		auto ringLine = [&](int y) { return lines.ring + static_cast<size_t>(((y % Size) + Size) % Size) * lines.lineBytes; };
+		auto fill = [&](int y) { fillLine<Size>(ringLine(y), src.Row(std::clamp(y, 0, height - 1)), width); };
+
+		for (int y = y0 - radius; y < y0 + radius; y++) fill(y);
+
+		for (int y = y0; y < y1; y++) {
+			fill(y + radius);
+
+			// 1. 열 정렬 (패딩 포함 전체 폭)
+			for (int pos = 0; pos < paddedBytes; pos += Ops::bytes) {
+				V v[Size];
+				for (int r = 0; r < Size; r++) Ops::Load(v[r], ringLine(y - radius + r) + pos);
+				Network::template SortColumn<Ops>(v);
+				for (int r = 0; r < Size; r++) Ops::Store(lines.sorted + r * lines.lineBytes + pos, v[r]);
+			}
+
+			// 2. 창마다 정렬된 열 Size개로 중앙값 선택
+			const unsigned char* center = ringLine(y) + radius * 4;
+			unsigned char* out = dst.Row(y);
+			for (int xb = 0; xb < rowBytes; xb += Ops::bytes) {
+				V v[Size * Size];
+				for (int c = 0; c < Size; c++) {
+					for (int r = 0; r < Size; r++) Ops::Load(v[c * Size + r], lines.sorted + r * lines.lineBytes + xb + c * 4);
+				}
+				Network::template Select<Ops>(v);
+
+				V original;
+				Ops::Load(original, center + xb);
+				Ops::KeepAlpha(v[Network::center], original);
+
+				if (xb + Ops::bytes <= rowBytes) {
+					Ops::Store(out + xb, v[Network::center]);
+				}
+				else {
+					alignas(32) unsigned char tail[Ops::bytes];
+					Ops::Store(tail, v[Network::center]);
+					memcpy(out + xb, tail, rowBytes - xb);
+				}
+			}
+		}
+	}
+
+	template <int Size>
+	void medianNetworkStripSse2(const NativeEngine::ImageView& src, const NativeEngine::ImageView& dst, int y0, int y1, const NetworkLines& lines) {
+		medianNetworkRows<Sse2Ops, Size>(src, dst, y0, y1, lines);
+	}
+
+	template <int Size>
+	ENGINE_TARGET_AVX2 void medianNetworkStripAvx2(const NativeEngine::ImageView& src, const NativeEngine::ImageView& dst, int y0, int y1, const NetworkLines& lines) {
+		medianNetworkRows<Avx2Ops, Size>(src, dst, y0, y1, lines);
+	}
+
+	template <int Size>
+	void medianNetwork(const NativeEngine::ImageView& src, const NativeEngine::ImageView& dst, NativeEngine::ScratchPool& scratch) {
+		const bool avx2 = NativeEngine::CpuHasAvx2();
+		const int height = src.height;
+		const size_t lineBytes = static_cast<size_t>(src.width + Size) * 4 + 32;
+
+#pragma omp parallel
+		{
+			// 스레드마다 연속된 행 띠 하나 (행 버퍼를 이어서 사용)
+			const int threads = omp_get_num_threads();
+			const int strip = (height + threads - 1) / threads;
+			const int y0 = std::min(height, omp_get_thread_num() * strip);
+			const int y1 = std::min(height, y0 + strip);
+
+			if (y0 < y1) {
+				NativeEngine::ScratchBuffer<unsigned char> ring(scratch, lineBytes * Size);
+				NativeEngine::ScratchBuffer<unsigned char> sorted(scratch, lineBytes * Size);
+				memset(ring.data(), 0, ring.size()); // 여유 영역도 정의된 값으로
+				const NetworkLines lines{ ring.data(), sorted.data(), lineBytes };
+
+				if (avx2) medianNetworkStripAvx2<Size>(src, dst, y0, y1, lines);
+				else medianNetworkStripSse2<Size>(src, dst, y0, y1, lines);
+			}
+		}
+	}
+}
+#endif
+
+bool NativeEngine::MedianSortingNetwork(const ImageView& src, const ImageView& dst, int kernelSize, ScratchPool& scratch) {
+#ifdef ENGINE_SSE2
+	switch (kernelSize) {
+	case 3: medianNetwork<3>(src, dst, scratch); return true;
+	case 5: medianNetwork<5>(src, dst, scratch); return true;
+	default: return false;
+	}
+#else
+	(void)src; (void)dst; (void)kernelSize; (void)scratch;
+	return false;
+#endif
+}
@@ -0,0 +1,22 @@
+﻿#pragma once
+
+#include "ImageView.h"
+#include "ScratchPool.h"
+
+namespace NativeEngine {
+	// 이 반경부터 상수 시간 히스토그램 중앙값 사용 (3x3에서도 픽셀별 히스토그램보다 2배 빠름)
+	constexpr int medianConstantTimeMinRadius = 1;
+
+	// Perreault-Hebert 상수 시간 중앙값
+	// 열마다 히스토그램(16칸 coarse + 256칸 fine)을 두고 창을 옮길 때 열 하나씩 더하고 빼므로
+	// 픽셀당 비용이 반경과 무관. 가로 띠로 나눠 스레드별로 처리
+	// 창은 (2 * radius + 1)^2 (가장자리 복제), 누적 개수가 rank를 넘는 첫 값을 선택
+	// src와 dst는 크기가 같고 겹치지 않아야 함, dst 알파는 src 알파 그대로
+	void MedianHistogram(const ImageView& src, const ImageView& dst, int radius, int rank, ScratchPool& scratch);
+
+	// 3x3, 5x5 전용 정렬 네트워크 중앙값 (결과는 히스토그램 방식과 동일)
+	// 바이트 레인별 SIMD min/max로 BGRA 4픽셀(SSE2) / 8픽셀(AVX2)씩, AVX2는 실행 시 선택
+	// 행마다 열을 한 번 정렬해 두고 가로로 이웃한 창들이 공유, 커널 크기별로 컴파일 시점 특수화
+	// 지원하지 않는 크기나 x86이 아니면 false (호출 쪽에서 히스토그램 방식 사용)
+	bool MedianSortingNetwork(const ImageView& src, const ImageView& dst, int kernelSize, ScratchPool& scratch);
+}
@@ -0,0 +1,477 @@
+﻿#include <omp.h>
+#include <algorithm>
+#include <cstring>
+#include "Morphology.h"
+#include "SeparableFilter.h"
+#include "Simd.h"
+
+namespace {
+	using NativeEngine::ScratchBuffer;
+	using NativeEngine::ScratchPool;
+
+	// 바이트 단위 최댓값/최솟값 (SIMD 버전은 16/32바이트 = BGRA 4/8픽셀 한꺼번에)
+	struct MaxOp {
+		static constexpr unsigned char neutral = 0;
+		static unsigned char Apply(unsigned char a, unsigned char b) { return a > b ? a : b; }
+#ifdef ENGINE_SSE2
+		static __m128i Sse2(__m128i a, __m128i b) { return _mm_max_epu8(a, b); }
+		static ENGINE_TARGET_AVX2 __m256i Avx2(__m256i a, __m256i b) { return _mm256_max_epu8(a, b); }
+#endif
+	};
+
+	struct MinOp {
+		static constexpr unsigned char neutral = 255;
+		static unsigned char Apply(unsigned char a, unsigned char b) { return a < b ? a : b; }
+#ifdef ENGINE_SSE2
+		static __m128i Sse2(__m128i a, __m128i b) { return _mm_min_epu8(a, b); }
+		static ENGINE_TARGET_AVX2 __m256i Avx2(__m256i a, __m256i b) { return _mm256_min_epu8(a, b); }
+#endif
+	};
+
+	// 세로 패스 열 묶음 폭 (바이트)
+	constexpr int morphologyColumnBlock = 1024;
+	// 복합 연산 스트리밍 띠 폭 (픽셀)
+	constexpr int morphologyStreamBlock = 512;
+
+#ifdef ENGINE_SSE2
+	template <class Op>
+	int combineSse2(unsigned char* out, const unsigned char* a, const unsigned char* b, int count) {
+		int i = 0;
+		for (; i + 16 <= count; i += 16) {
+			const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+			const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), Op::Sse2(va, vb));
+		}
+		return i;
+	}
+
+	template <class Op>
+	ENGINE_TARGET_AVX2 int combineAvx2(unsigned char* out, const unsigned char* a, const unsigned char* b, int count) {
+		int i = 0;
+		for (; i + 32 <= count; i += 32) {
+			const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+			const __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), Op::Avx2(va, vb));
+		}
+		return i;
+	}
+
+	inline __m128i loadPixel(const unsigned char* p) {
+		int v;
+		memcpy(&v, p, 4);
+		return _mm_cvtsi32_si128(v);
+	}
+
+	inline void storePixel(unsigned char* p, __m128i v) {
+		const int x = _mm_cvtsi128_si32(v);
+		memcpy(p, &x, 4);
+	}
+#endif
+
+	// out[i] = Op(a[i], b[i]), 바이트 레인이라 채널 수와 무관 (out은 a 또는 b와 같아도 됨)
+	template <class Op>
+	void combineLanes(unsigned char* out, const unsigned char* a, const unsigned char* b, int count) {
+		int i = 0;
+#ifdef ENGINE_SSE2
+		i = NativeEngine::CpuHasAvx2() ? combineAvx2<Op>(out, a, b, count) : combineSse2<Op>(out, a, b, count);
+#endif
+		for (; i < count; i++) out[i] = Op::Apply(a[i], b[i]);
+	}
+
+	// 선을 kernelSize 픽셀 구간으로 나눠 구간 시작부터(forward) / 끝부터(backward) 누적
+	// length는 픽셀 수 (kernelSize 배수), BGRA는 픽셀 하나(4바이트)를 SSE 레지스터 하나로 누적
+	template <class Op>
+	void scanSegments(const unsigned char* line, unsigned char* forward, unsigned char* backward,
+		int length, int kernelSize, int channels)
+	{
+#ifdef ENGINE_SSE2
+		if (channels == 4) {
+			for (int s = 0; s < length; s += kernelSize) {
+				__m128i acc = loadPixel(line + s * 4);
+				storePixel(forward + s * 4, acc);
+				for (int i = s + 1; i < s + kernelSize; i++) {
+					acc = Op::Sse2(acc, loadPixel(line + i * 4));
+					storePixel(forward + i * 4, acc);
+				}
+				acc = loadPixel(line + (s + kernelSize - 1) * 4);
+				storePixel(backward + (s + kernelSize - 1) * 4, acc);
+				for (int i = s + kernelSize - 2; i >= s; i--) {
+					acc = Op::Sse2(acc, loadPixel(line + i * 4));
+					storePixel(backward + i * 4, acc);
+				}
+			}
+			return;
+		}
+#endif
+		const int step = channels;
+		const int segmentBytes = kernelSize * step;
+		for (int s = 0; s < length * step; s += segmentBytes) {
+			for (int c = 0; c < step; c++) forward[s + c] = line[s + c];
+			for (int i = s + step; i < s + segmentBytes; i++) forward[i] = Op::Apply(forward[i - step], line[i]);
+			const int last = s + segmentBytes - step;
+			for (int c = 0; c < step; c++) backward[last + c] = line[last + c];
+			for (int i = last - 1; i >= s; i--) backward[i] = Op::Apply(backward[i + step], line[i]);
+		}
+	}
+
+	template <class Op>
+	void morphologyRows(const unsigned char* src, unsigned char* dst, int width, int height, int channels,
+		int kernelSize, ScratchPool& scratch)
+	{
+		const int anchor = NativeEngine::MorphologyAnchor(kernelSize);
+		// 양쪽을 neutral로 채운 선, 길이는 kernelSize 배수로 올림
+		const int padded = width + kernelSize - 1;
+		const int length = (padded + kernelSize - 1) / kernelSize * kernelSize;
+		const size_t lineBytes = static_cast<size_t>(length) * channels;
+		const size_t rowBytes = static_cast<size_t>(width) * channels;
+
+#pragma omp parallel
+		{
+			ScratchBuffer<unsigned char> buffer(scratch, lineBytes * 3);
+			unsigned char* line = buffer.data();
+			unsigned char* forward = line + lineBytes;  // 구간 시작부터 누적
+			unsigned char* backward = forward + lineBytes; // 구간 끝부터 누적
+			memset(line, Op::neutral, static_cast<size_t>(anchor) * channels);
+			memset(line + anchor * channels + rowBytes, Op::neutral, lineBytes - anchor * channels - rowBytes);
+
+#pragma omp for schedule(static)
+			for (int y = 0; y < height; y++) {
+				memcpy(line + anchor * channels, src + y * rowBytes, rowBytes);
+				scanSegments<Op>(line, forward, backward, length, kernelSize, channels);
+
+				// 창 [x, x + kernelSize - 1]은 많아야 구간 두 개에 걸침
+				combineLanes<Op>(dst + y * rowBytes, backward, forward + (kernelSize - 1) * channels, static_cast<int>(rowBytes));
+			}
+		}
+	}
+
+	// rowBytes 폭 바이트 평면의 세로 방향 (채널 구분 없이 바이트 레인 단위)
+	template <class Op>
+	void morphologyColumns(const unsigned char* src, unsigned char* dst, int rowBytes, int height, int kernelSize, ScratchPool& scratch) {
+		const int anchor = NativeEngine::MorphologyAnchor(kernelSize);
+		const int threadBlocks = omp_get_max_threads() * 4;
+		const int blockBytes = std::clamp((rowBytes / threadBlocks) & ~63, 64, morphologyColumnBlock);
+
+		NativeEngine::ForEachColumnBlock(rowBytes, blockBytes, [&](int x0, int lanes) {
+			// 구간 하나 분량의 뒤쪽 누적과 다음 구간의 앞쪽 누적만 유지
+			ScratchBuffer<unsigned char> buffer(scratch, static_cast<size_t>(lanes) * (kernelSize * 2 + 1));
+			unsigned char* backward = buffer.data();
+			unsigned char* forward = backward + static_cast<size_t>(lanes) * kernelSize;
+			unsigned char* outside = forward + static_cast<size_t>(lanes) * kernelSize;
+			memset(outside, Op::neutral, lanes);
+
+			// 패딩된 선의 i번째 행
+			auto row = [&](int i) -> const unsigned char* {
+				const int y = i - anchor;
+				return (y < 0 || y >= height) ? outside : src + static_cast<size_t>(y) * rowBytes + x0;
+			};
+			auto lane = [&](unsigned char* base, int j) { return base + static_cast<size_t>(j) * lanes; };
+
+			for (int s = 0; s < height; s += kernelSize) {
+				memcpy(lane(backward, kernelSize - 1), row(s + kernelSize - 1), lanes);
+				for (int j = kernelSize - 2; j >= 0; j--) {
+					combineLanes<Op>(lane(backward, j), lane(backward, j + 1), row(s + j), lanes);
+				}
+
+				const int rows = std::min(kernelSize, height - s);
+				if (rows > 1) {
+					memcpy(forward, row(s + kernelSize), lanes);
+					for (int j = 1; j < rows - 1; j++) {
+						combineLanes<Op>(lane(forward, j), lane(forward, j - 1), row(s + kernelSize + j), lanes);
+					}
+				}
+
+				// 출력 행 s + j의 창 = 이 구간의 j번째 뒤쪽 누적 + 다음 구간의 j - 1번째 앞쪽 누적
+				memcpy(dst + static_cast<size_t>(s) * rowBytes + x0, backward, lanes);
+				for (int j = 1; j < rows; j++) {
+					combineLanes<Op>(dst + static_cast<size_t>(s + j) * rowBytes + x0, lane(backward, j), lane(forward, j - 1), lanes);
+				}
+			}
+		});
+	}
+}
+
+void NativeEngine::MorphologyRows(const unsigned char* src, unsigned char* dst, int width, int height, int channels,
+	int kernelSize, MorphologyOp op, ScratchPool& scratch)
+{
+	if (kernelSize <= 1) {
+		memcpy(dst, src, static_cast<size_t>(width) * height * channels);
+	}
+	else if (op == MorphologyOp::Dilate) {
+		morphologyRows<MaxOp>(src, dst, width, height, channels, kernelSize, scratch);
+	}
+	else {
+		morphologyRows<MinOp>(src, dst, width, height, channels, kernelSize, scratch);
+	}
+}
+
+void NativeEngine::MorphologyColumns(const unsigned char* src, unsigned char* dst, int width, int height, int channels,
+	int kernelSize, MorphologyOp op, ScratchPool& scratch)
+{
+	if (kernelSize <= 1) {
+		memcpy(dst, src, static_cast<size_t>(width) * height * channels);
+	}
+	else if (op == MorphologyOp::Dilate) {
+		morphologyColumns<MaxOp>(src, dst, width * channels, height, kernelSize, scratch);
+	}
+	else {
+		morphologyColumns<MinOp>(src, dst, width * channels, height, kernelSize, scratch);
+	}
+}
+
+// ---------------------------------------------------------------------------
+// 복합 연산 스트리밍
+// ---------------------------------------------------------------------------
+
+namespace {
+	// 2차원 직사각형 최댓값/최솟값 한 단계, 출력 행을 위에서부터 하나씩 내줌
+	// 입력 행은 source(y)로 한 번씩만 당겨 옴 (열 [InputX0(), InputX1()) 구간, InputX0() 픽셀 기준 포인터)
+	// 세로는 van Herk/Gil-Werman 구간 단위: 구간 s의 출력에는 구간 s와 s + 1의 가로 결과만 필요하므로
+	// 가로 결과는 2 * kernelHeight 행 링 버퍼로 충분
+	// anchorX/anchorY: 창 위치 (출력 x의 창은 [x - anchorX, x - anchorX + kernelWidth))
+	template <class Op, class Source>
+	class MorphologyStage {
+	public:
+		MorphologyStage(int width, int height, int channels, int outX0, int outX1, int kernelWidth, int kernelHeight,
+			int anchorX, int anchorY, Source source, ScratchPool& scratch)
+			: _height(height), _channels(channels), _outX0(outX0), _lanes((outX1 - outX0) * channels),
+			_kernelWidth(kernelWidth), _kernelHeight(kernelHeight), _anchorX(anchorX), _anchorY(anchorY),
+			_source(source)
+		{
+			_inX0 = std::max(0, outX0 - _anchorX);
+			_inX1 = std::min(width, outX1 + kernelWidth - 1 - _anchorX);
+
+			const int padded = (outX1 - outX0) + kernelWidth - 1;
+			_lineLength = (padded + kernelWidth - 1) / kernelWidth * kernelWidth;
+			const size_t lineBytes = static_cast<size_t>(_lineLength) * channels;
+			const size_t lanes = static_cast<size_t>(_lanes);
+			_buffer = ScratchBuffer<unsigned char>(scratch, lineBytes * 3 + lanes * (static_cast<size_t>(kernelHeight) * 4 + 2));
+
+			_line = _buffer.data();
+			_forwardLine = _line + lineBytes;
+			_backwardLine = _forwardLine + lineBytes;
+			_ring = _backwardLine + lineBytes;
+			_backward = _ring + lanes * kernelHeight * 2;
+			_forward = _backward + lanes * kernelHeight;
+			_outside = _forward + lanes * kernelHeight;
+			_output = _outside + lanes;
+			memset(_outside, Op::neutral, lanes);
+		}
+
+		int InputX0() const { return _inX0; }
+		int InputX1() const { return _inX1; }
+
+		// y는 0부터 1씩 증가하며 호출
+		const unsigned char* Row(int y) {
+			if (_kernelHeight == 1) return filtered(y);
+
+			const int segment = y / _kernelHeight;
+			const int j = y % _kernelHeight;
+			if (segment != _segment) loadSegment(segment);
+			if (j == 0) return _backward;
+
+			combineLanes<Op>(_output, lane(_backward, j), lane(_forward, j - 1), _lanes);
+			return _output;
+		}
+
+	private:
+		int _height, _channels, _outX0, _lanes, _kernelWidth, _kernelHeight, _anchorX, _anchorY;
+		int _inX0 = 0, _inX1 = 0, _lineLength = 0;
+		int _segment = -1;
+		int _pulled = 0; // 다음에 가로 필터할 패딩 행 번호
+		Source _source;
+		ScratchBuffer<unsigned char> _buffer;
+		unsigned char* _line;
+		unsigned char* _forwardLine;
+		unsigned char* _backwardLine;
+		unsigned char* _ring;
+		unsigned char* _backward;
+		unsigned char* _forward;
+		unsigned char* _outside;
+		unsigned char* _output;
+
+		unsigned char* lane(unsigned char* base, int j) const { return base + static_cast<size_t>(j) * _lanes; }
+
+		// 패딩 행 i (이미지 행 i - anchorY)의 가로 결과
+		const unsigned char* filtered(int i) {
+			const int y = i - _anchorY;
+			if (y < 0 || y >= _height) return _outside;
+
+			unsigned char* slot = lane(_ring, i % (_kernelHeight * 2));
+			while (_pulled <= i) {
+				const int py = _pulled - _anchorY;
+				if (py >= 0 && py < _height) filterRow(py, lane(_ring, _pulled % (_kernelHeight * 2)));
+				_pulled++;
+			}
+			return slot;
+		}
+
+		void filterRow(int y, unsigned char* out) {
+			const unsigned char* in = _source(y);
+			const int channels = _channels;
+			if (_kernelWidth == 1) {
+				memcpy(out, in + (_outX0 - _inX0) * channels, _lanes);
+				return;
+			}
+
+			// 선 위치 p = 이미지 열 outX0 - anchorX + p, 이미지 밖은 neutral
+			const int lead = (_inX0 - (_outX0 - _anchorX)) * channels;
+			const int count = (_inX1 - _inX0) * channels;
+			const int lineBytes = _lineLength * channels;
+			memset(_line, Op::neutral, lead);
+			memcpy(_line + lead, in, count);
+			memset(_line + lead + count, Op::neutral, lineBytes - lead - count);
+
+			scanSegments<Op>(_line, _forwardLine, _backwardLine, _lineLength, _kernelWidth, channels);
+			combineLanes<Op>(out, _backwardLine, _forwardLine + (_kernelWidth - 1) * channels, _lanes);
+		}
+
+		// 구간 segment의 뒤쪽 누적과 다음 구간의 앞쪽 누적
+		void loadSegment(int segment) {
+			const int k = _kernelHeight;
+			const int s = segment * k;
+			_segment = segment;
+
+			memcpy(lane(_backward, k - 1), filtered(s + k - 1), _lanes);
+			for (int j = k - 2; j >= 0; j--) {
+				combineLanes<Op>(lane(_backward, j), lane(_backward, j + 1), filtered(s + j), _lanes);
+			}
+
+			memcpy(_forward, filtered(s + k), _lanes);
+			for (int j = 1; j < k - 1; j++) {
+				combineLanes<Op>(lane(_forward, j), lane(_forward, j - 1), filtered(s + k + j), _lanes);
+			}
+		}
+	};
+
+	template <class Op, class Source>
+	MorphologyStage<Op, Source> makeStage(int width, int height, int channels, int outX0, int outX1,
+		int kernelWidth, int kernelHeight, int anchorX, int anchorY, Source source, ScratchPool& scratch)
+	{
+		return MorphologyStage<Op, Source>(width, height, channels, outX0, outX1, kernelWidth, kernelHeight,
+			anchorX, anchorY, source, scratch);
+	}
+
+	// 평면 src의 열 [x0, ...) 행 포인터
+	struct PlaneSource {
+		const unsigned char* plane;
+		size_t rowBytes;
+		int offset; // x0 * channels
+		const unsigned char* operator()(int y) const { return plane + y * rowBytes + offset; }
+	};
+
+	// 결과를 B, G, R에 (단일 채널은 셋에 같은 값), 알파는 그대로
+	void writeRow(const NativeEngine::ImageView& dst, int y, int x0, int pixels, int channels, const unsigned char* values) {
+		unsigned char* row = dst.Pixel(x0, y);
+		if (channels == 1) {
+			for (int x = 0; x < pixels; x++) {
+				row[x * 4 + 0] = values[x];
+				row[x * 4 + 1] = values[x];
+				row[x * 4 + 2] = values[x];
+			}
+			return;
+		}
+		for (int x = 0; x < pixels; x++) {
+			row[x * 4 + 0] = values[x * 4 + 0];
+			row[x * 4 + 1] = values[x * 4 + 1];
+			row[x * 4 + 2] = values[x * 4 + 2];
+		}
+	}
+
+	struct BlockContext {
+		const unsigned char* src;
+		const NativeEngine::ImageView& dst;
+		int channels;
+		int kernelWidth;
+		int kernelHeight;
+		ScratchPool& scratch;
+	};
+
+	// First 단계 -> Second 단계 (뒤집은 구조 요소), combine(원본, 결과)로 최종 값
+	template <class First, class Second, class Combine>
+	void chainedBlock(const BlockContext& context, int x0, int pixels, Combine combine, unsigned char* values) {
+		const int width = context.dst.width;
+		const int height = context.dst.height;
+		const int channels = context.channels;
+		const size_t rowBytes = static_cast<size_t>(width) * channels;
+		const int anchorX = NativeEngine::MorphologyAnchor(context.kernelWidth);
+		const int anchorY = NativeEngine::MorphologyAnchor(context.kernelHeight);
+		const int reflectedX = NativeEngine::MorphologyReflectedAnchor(context.kernelWidth);
+		const int reflectedY = NativeEngine::MorphologyReflectedAnchor(context.kernelHeight);
+
+		// 두 번째 단계 입력 구간 = 첫 번째 단계 출력 구간
+		const int midX0 = std::max(0, x0 - reflectedX);
+		const int midX1 = std::min(width, x0 + pixels + context.kernelWidth - 1 - reflectedX);
+
+		auto first = makeStage<First>(width, height, channels, midX0, midX1, context.kernelWidth, context.kernelHeight,
+			anchorX, anchorY, PlaneSource{ context.src, rowBytes, std::max(0, midX0 - anchorX) * channels }, context.scratch);
+		auto second = makeStage<Second>(width, height, channels, x0, x0 + pixels, context.kernelWidth, context.kernelHeight,
+			reflectedX, reflectedY, [&first](int y) { return first.Row(y); }, context.scratch);
+
+		const int lanes = pixels * channels;
+		for (int y = 0; y < height; y++) {
+			const unsigned char* result = second.Row(y);
+			const unsigned char* original = context.src + y * rowBytes + x0 * channels;
+			for (int l = 0; l < lanes; l++) values[l] = combine(original[l], result[l]);
+			writeRow(context.dst, y, x0, pixels, channels, values);
+		}
+	}
+
+	void gradientBlock(const BlockContext& context, int x0, int pixels, unsigned char* values) {
+		const int width = context.dst.width;
+		const int height = context.dst.height;
+		const int channels = context.channels;
+		const int anchorX = NativeEngine::MorphologyAnchor(context.kernelWidth);
+		const int anchorY = NativeEngine::MorphologyAnchor(context.kernelHeight);
+		const PlaneSource source{ context.src, static_cast<size_t>(width) * channels, std::max(0, x0 - anchorX) * channels };
+		auto dilate = makeStage<MaxOp>(width, height, channels, x0, x0 + pixels, context.kernelWidth, context.kernelHeight,
+			anchorX, anchorY, source, context.scratch);
+		auto erode = makeStage<MinOp>(width, height, channels, x0, x0 + pixels, context.kernelWidth, context.kernelHeight,
+			anchorX, anchorY, source, context.scratch);
+
+		const int lanes = pixels * channels;
+		for (int y = 0; y < height; y++) {
+			const unsigned char* high = dilate.Row(y);
+			const unsigned char* low = erode.Row(y);
+			for (int l = 0; l < lanes; l++) values[l] = static_cast<unsigned char>(high[l] - low[l]);
+			writeRow(context.dst, y, x0, pixels, channels, values);
+		}
+	}
+}
+
+void NativeEngine::MorphologyCompound(const unsigned char* src, const ImageView& dst, int channels,
+	int kernelWidth, int kernelHeight, CompoundMorphology op, ScratchPool& scratch)
+{
+	kernelWidth = std::max(kernelWidth, 1);
+	kernelHeight = std::max(kernelHeight, 1);
+	const BlockContext context{ src, dst, channels, kernelWidth, kernelHeight, scratch };
+
+	// 단계별 버퍼(커널 높이 4배 행)가 캐시에 남도록 띠 폭 제한
+	// 띠가 좁으면 양옆 겹침 계산 비율이 커지므로 커널 폭의 4배 이상
+	const int blockPixels = std::max(morphologyStreamBlock, kernelWidth * 4);
+
+	ForEachColumnBlock(dst.width, blockPixels, [&](int x0, int pixels) {
+		ScratchBuffer<unsigned char> values(scratch, static_cast<size_t>(pixels) * channels);
+		auto keep = [](unsigned char, unsigned char result) { return result; };
+		auto fromOriginal = [](unsigned char original, unsigned char opened) { return static_cast<unsigned char>(original - opened); };
+		auto toOriginal = [](unsigned char original, unsigned char closed) { return static_cast<unsigned char>(closed - original); };
+
+		switch (op) {
+		case CompoundMorphology::Opening:
+			chainedBlock<MinOp, MaxOp>(context, x0, pixels, keep, values.data());
+			break;
+		case CompoundMorphology::Closing:
+			chainedBlock<MaxOp, MinOp>(context, x0, pixels, keep, values.data());
+			break;
+		case CompoundMorphology::Gradient:
+			gradientBlock(context, x0, pixels, values.data());
+			break;
+		case CompoundMorphology::TopHat:
+			chainedBlock<MinOp, MaxOp>(context, x0, pixels, fromOriginal, values.data());
+			break;
+		case CompoundMorphology::BlackHat:
+			chainedBlock<MaxOp, MinOp>(context, x0, pixels, toOriginal, values.data());
+			break;
+		}
+	});
+}
@@ -0,0 +1,52 @@
+﻿#pragma once
+
+#include "ImageView.h"
+#include "ScratchPool.h"
+
+namespace NativeEngine {
+	enum class MorphologyOp {
+		Dilate, // 창 최댓값
+		Erode   // 창 최솟값
+	};
+
+	// 컬러 이미지 처리 방식
+	enum class MorphologyChannels {
+		Color, // B, G, R 채널별로 따로 (알파 그대로)
+		Gray   // B 채널 기준 값을 B, G, R에 같이 씀 (이진화/그레이스케일 결과용)
+	};
+
+	// 복합 연산 (열림, 닫힘, 그레이디언트, 톱햇)
+	enum class CompoundMorphology {
+		Opening,  // 침식 후 팽창 (작은 밝은 점 제거)
+		Closing,  // 팽창 후 침식 (작은 어두운 구멍 메움)
+		Gradient, // 팽창 - 침식 (윤곽)
+		TopHat,   // 원본 - 열림 (배경보다 밝은 작은 구조)
+		BlackHat  // 닫힘 - 원본 (배경보다 어두운 작은 구조)
+	};
+
+	// 구조 요소 width x height 직사각형의 창 위치 (크기가 짝수면 중심이 왼쪽/위로 치우침)
+	inline int MorphologyAnchor(int kernelSize) { return kernelSize / 2; }
+	// 좌우/위아래를 뒤집은 구조 요소의 창 위치 (열림/닫힘 두 번째 단계, 짝수 크기에서도 열림 <= 원본 <= 닫힘)
+	inline int MorphologyReflectedAnchor(int kernelSize) { return kernelSize - 1 - kernelSize / 2; }
+
+	// van Herk/Gil-Werman 1차원 최댓값/최솟값 필터
+	// 버퍼는 픽셀당 channels(1 또는 4)바이트 빽빽한 평면 (stride = width * channels), 채널마다 따로 계산
+	// 선을 kernelSize 길이 구간으로 나눠 구간별 앞쪽/뒤쪽 누적값을 구해 두면
+	// 어떤 창이든 두 값의 비교 한 번으로 끝나므로 픽셀당 비용이 커널 크기와 무관
+	// 이미지 밖은 결과에 영향 없는 값(팽창 0, 침식 255)으로 취급 (가장자리 복제와 같은 결과)
+	// kernelSize 1 이하는 그대로 복사, src와 dst는 겹치지 않아야 함
+	void MorphologyRows(const unsigned char* src, unsigned char* dst, int width, int height, int channels,
+		int kernelSize, MorphologyOp op, ScratchPool& scratch);
+	// 세로 방향은 열 묶음 단위로 행 전체를 바이트 레인째 갱신 (AVX2 32바이트 / SSE2 16바이트 min/max)
+	void MorphologyColumns(const unsigned char* src, unsigned char* dst, int width, int height, int channels,
+		int kernelSize, MorphologyOp op, ScratchPool& scratch);
+
+	// 복합 연산을 한 번의 위->아래 스트리밍으로 처리 (중간 결과 이미지 없음)
+	// 각 단계는 가로 필터 결과를 커널 높이 2배만큼의 행 링 버퍼에만 두고, 다음 단계가 행 단위로 바로 소비
+	// 열 띠로 나눠 병렬 처리 (띠 양옆은 커널 폭만큼 겹쳐 계산)
+	// 열림/닫힘(톱햇/블랙햇 포함)의 두 번째 단계는 뒤집은 구조 요소 (MorphologyReflectedAnchor)
+	// src는 dst 크기의 빽빽한 평면 (channels 1: 결과를 B, G, R에 같이 씀 / 4: 채널별), dst 알파는 그대로
+	// src는 dst와 다른 버퍼여야 함
+	void MorphologyCompound(const unsigned char* src, const ImageView& dst, int channels,
+		int kernelWidth, int kernelHeight, CompoundMorphology op, ScratchPool& scratch);
+}
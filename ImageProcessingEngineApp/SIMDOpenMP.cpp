@@ -1,522 +1,730 @@
 #include <omp.h>
-#include <windows.h>
+#include <array>
 #include <string>
+#if defined(_WIN32) && defined(_DEBUG)
+#include <windows.h>
+#endif
 #include "ImageProcessingEngineApp.h"
+#include "ScratchPool.h"
+#include "GrayPlane.h"
+#include "GaussianFilter.h"
+#include "SeparableFilter.h"
+#include "MedianFilter.h"
+#include "Morphology.h"
+#include "SobelFilter.h"
+#include "CannyFilter.h"
+#include "StencilFilter.h"
+#include "ScaleSpace.h"
+#include "AdaptiveThreshold.h"
+#include "Histogram.h"
 
 using namespace std;
 
 void NativeEngine::ImageProcessingEngine::ApplyGrayscale(unsigned char* pixels, int width, int height) {
-	//  ũ⸦ ȮѴ -> Ű 
+	ApplyGrayscale(ImageView(pixels, width, height));
+}
+
+void NativeEngine::ImageProcessingEngine::ApplyGrayscale(const ImageView& image) {
+	if (!image.IsValid()) return;
+	invalidateGrayPlane(image);
+
+	//  ũ⸦ ȮѴ ->  
 	//  ȼ RGB  Ѵ
+	const int width = image.width;
+	const int height = image.height;
 	unsigned int avg = 0;
 	unsigned int red, blue, green;
 
 #pragma omp parallel for private(red, green, blue, avg)
-	for (int i = 0; i < width * height; i++) {
-		red = pixels[i * 4 + 0];
-		green = pixels[i * 4 + 1];
-		blue = pixels[i * 4 + 2];
-		avg = (red + green + blue) / 3;
-		pixels[i * 4 + 0] = avg;
-		pixels[i * 4 + 1] = avg;
-		pixels[i * 4 + 2] = avg;
-
-		if (i < 20) {
-			std::string msg = "Pixel " + std::to_string(i) +
-				" processed by thread " + std::to_string(omp_get_thread_num()) + "\n";
-			OutputDebugStringA(msg.c_str());
+	for (int y = 0; y < height; y++) {
+		unsigned char* row = image.Row(y);
+		for (int x = 0; x < width; x++) {
+			unsigned char* p = row + x * 4;
+			red = p[0];
+			green = p[1];
+			blue = p[2];
+			avg = (red + green + blue) / 3;
+			p[0] = avg;
+			p[1] = avg;
+			p[2] = avg;
+
+#if defined(_WIN32) && defined(_DEBUG)
+			if (y == 0 && x < 20) {
+				std::string msg = "Pixel " + std::to_string(x) +
+					" processed by thread " + std::to_string(omp_get_thread_num()) + "\n";
+				OutputDebugStringA(msg.c_str());
+			}
+#endif
 		}
 	}
 }
 
 void NativeEngine::ImageProcessingEngine::ApplyGaussianBlur(
-	unsigned char* pixels, int width, int height, int radius)
+	unsigned char* pixels, int width, int height, float sigma)
 {
-	const int channels = 4;
-	const int stride = width * channels;
-	const int dataSize = stride * height;
-	const int kernelSize = (radius * 2) + 1;
-
-	// ޸ Ҵ  
-	std::vector<unsigned char> tempBuffer(dataSize);
-
-	// ݺ ּȭ (3 -> 1)
-	// ---------------------
-	// 1.   ( ó)
-	// ---------------------
-#pragma omp parallel for schedule(static)
-	for (int y = 0; y < height; ++y) {
-		int sumB = 0, sumG = 0, sumR = 0;
-		const int row_offset = y * stride;
-
-		// ù  հ  ȭ
-		for (int i = -radius; i <= radius; ++i) {
-			const int xi = std::clamp(i, 0, width - 1);
-			const int idx = row_offset + xi * channels;
-			sumB += pixels[idx];
-			sumG += pixels[idx + 1];
-			sumR += pixels[idx + 2];
-		}
+	ApplyGaussianBlur(ImageView(pixels, width, height), sigma);
+}
 
-		for (int x = 0; x < width; ++x) {
-			const int out_idx = row_offset + x * channels;
-
-			//   ȭ
-			tempBuffer[out_idx] = sumB / kernelSize;
-			tempBuffer[out_idx + 1] = sumG / kernelSize;
-			tempBuffer[out_idx + 2] = sumR / kernelSize;
-			tempBuffer[out_idx + 3] = pixels[out_idx + 3];
-
-			// ̵  Ʈ
-			const int old_x = std::clamp(x - radius, 0, width - 1);
-			const int new_x = std::clamp(x + radius + 1, 0, width - 1);
-			const int old_idx = row_offset + old_x * channels;
-			const int new_idx = row_offset + new_x * channels;
-
-			sumB += pixels[new_idx] - pixels[old_idx];
-			sumG += pixels[new_idx + 1] - pixels[old_idx + 1];
-			sumR += pixels[new_idx + 2] - pixels[old_idx + 2];
-		}
-	}
+void NativeEngine::ImageProcessingEngine::ApplyGaussianBlur(const ImageView& image, float sigma)
+{
+	// sigma 0.5 ̸  ȭ  ״ 
+	if (!image.IsValid() || !(sigma >= 0.5f)) return;
+	invalidateGrayPlane(image);
+
+	//  ->  (δ      )
+	const GaussianKernel kernel = ComputeGaussianKernel(sigma, _scratch);
+	GaussianRows(image, kernel, _scratch);
+	GaussianColumns(image, kernel, _scratch);
+}
 
-	// ---------------------
-	// 2.   ( ó)
-	// ---------------------
-#pragma omp parallel for schedule(static)
-	for (int x = 0; x < width; ++x) {
-		int sumB = 0, sumG = 0, sumR = 0;
-		const int col_offset = x * channels;
-
-		// ù  հ 
-		for (int i = -radius; i <= radius; ++i) {
-			const int yi = std::clamp(i, 0, height - 1);
-			const int idx = yi * stride + col_offset;
-			sumB += tempBuffer[idx];
-			sumG += tempBuffer[idx + 1];
-			sumR += tempBuffer[idx + 2];
-		}
+void NativeEngine::ImageProcessingEngine::ApplyGaussianBlur(
+	unsigned char* pixels, int width, int height, int radius)
+{
+	ApplyGaussianBlur(ImageView(pixels, width, height), radius);
+}
 
-		for (int y = 0; y < height; ++y) {
-			const int out_idx = y * stride + col_offset;
+void NativeEngine::ImageProcessingEngine::ApplyGaussianBlur(const ImageView& image, int radius)
+{
+	if (!image.IsValid()) return;
+	invalidateGrayPlane(image);
 
-			pixels[out_idx] = sumB / kernelSize;
-			pixels[out_idx + 1] = sumG / kernelSize;
-			pixels[out_idx + 2] = sumR / kernelSize;
+	const int channels = 4;
+	const int width = image.width;
+	const int height = image.height;
 
-			// ̵  Ʈ
-			const int old_y = std::clamp(y - radius, 0, height - 1);
-			const int new_y = std::clamp(y + radius + 1, 0, height - 1);
-			const int old_idx = old_y * stride + col_offset;
-			const int new_idx = new_y * stride + col_offset;
+	//    ӽ ۿ
+	ScratchBuffer<unsigned char> tempBuffer(_scratch, static_cast<size_t>(width) * channels * height);
+	const ImageView temp(tempBuffer.data(), width, height);
 
-			sumB += tempBuffer[new_idx] - tempBuffer[old_idx];
-			sumG += tempBuffer[new_idx + 1] - tempBuffer[old_idx + 1];
-			sumR += tempBuffer[new_idx + 2] - tempBuffer[old_idx + 2];
-		}
-	}
+	// 1.  
+	BoxFilterRows(image, temp, radius);
+	// 2.   (     )
+	BoxFilterColumns(temp, image, radius);
 }
+
 void NativeEngine::ImageProcessingEngine::ApplyMedian(
 	unsigned char* pixels, int width, int height, int kernelSize)
 {
+	ApplyMedian(ImageView(pixels, width, height), kernelSize);
+}
+
+void NativeEngine::ImageProcessingEngine::ApplyMedian(const ImageView& image, int kernelSize)
+{
+	if (!image.IsValid()) return;
+	invalidateGrayPlane(image);
+
 	const int channels = 4;
+	const int width = image.width;
+	const int height = image.height;
 	const int stride = width * channels;
-	const int dataSize = stride * height;
 
-	std::vector<unsigned char> result(dataSize);
+	ScratchBuffer<unsigned char> result(_scratch, static_cast<size_t>(stride) * height);
 	int kernelHalf = kernelSize / 2;
 	int kernelArea = kernelSize * kernelSize;
 	const int medianIndex = kernelArea / 2;
 
+	// 3x3, 5x5  Ʈũ,  ̻  ð ׷ ߾Ӱ ( ), ݰ 0 ϴ ȼ ׷
+	const ImageView resultView(result.data(), width, height);
+	if (kernelHalf >= medianConstantTimeMinRadius) {
+		if (!MedianSortingNetwork(image, resultView, kernelSize, _scratch)) {
+			MedianHistogram(image, resultView, kernelHalf, medianIndex, _scratch);
+		}
+	}
+	else {
 #pragma omp parallel for schedule(static)
-	for (int y = 0; y < height; y++) {
-		for (int x = 0; x < width; x++) {
-			int histB[256] = { 0 }, histG[256] = { 0 }, histR[256] = { 0 };
-
-			// Ŀ  ȼ ī
-			for (int ky = -kernelHalf; ky <= kernelHalf; ky++) {
-				for (int kx = -kernelHalf; kx <= kernelHalf; kx++) {
-					int nx = std::clamp(x + kx, 0, width - 1);
-					int ny = std::clamp(y + ky, 0, height - 1);
-					int idx = ny * stride + nx * channels;
-
-					histB[pixels[idx + 0]]++;
-					histG[pixels[idx + 1]]++;
-					histR[pixels[idx + 2]]++;
+		for (int y = 0; y < height; y++) {
+			for (int x = 0; x < width; x++) {
+				int histB[256] = { 0 }, histG[256] = { 0 }, histR[256] = { 0 };
+
+				// Ŀ  ȼ ī
+				for (int ky = -kernelHalf; ky <= kernelHalf; ky++) {
+					const unsigned char* row = image.Row(std::clamp(y + ky, 0, height - 1));
+					for (int kx = -kernelHalf; kx <= kernelHalf; kx++) {
+						int nx = std::clamp(x + kx, 0, width - 1);
+						int idx = nx * channels;
+
+						histB[row[idx + 0]]++;
+						histG[row[idx + 1]]++;
+						histR[row[idx + 2]]++;
+					}
 				}
-			}
 
-			// ߾Ӱ ã (BGR )
-			auto getMedian = [&](int* hist) {
-				int count = 0;
-				for (int i = 0; i < 256; i++) {
-					count += hist[i];
-					if (count > medianIndex) return i;
-				}
-				return 0;
-				};
-
-			int outIdx = y * stride + x * channels;
-			result[outIdx + 0] = (unsigned char)getMedian(histB);
-			result[outIdx + 1] = (unsigned char)getMedian(histG);
-			result[outIdx + 2] = (unsigned char)getMedian(histR);
-			result[outIdx + 3] = pixels[outIdx + 3]; //  
+				// ߾Ӱ ã (BGR )
+				auto getMedian = [&](int* hist) {
+					int count = 0;
+					for (int i = 0; i < 256; i++) {
+						count += hist[i];
+						if (count > medianIndex) return i;
+					}
+					return 0;
+					};
+
+				size_t outIdx = static_cast<size_t>(y) * stride + x * channels;
+				result[outIdx + 0] = (unsigned char)getMedian(histB);
+				result[outIdx + 1] = (unsigned char)getMedian(histG);
+				result[outIdx + 2] = (unsigned char)getMedian(histR);
+				result[outIdx + 3] = image.Pixel(x, y)[3]; //  
+			}
 		}
 	}
 
-	memcpy(pixels, result.data(), dataSize);
+#pragma omp parallel for schedule(static)
+	for (int y = 0; y < height; y++) {
+		memcpy(image.Row(y), &result[static_cast<size_t>(y) * stride], stride);
+	}
 }
 
 
 void NativeEngine::ImageProcessingEngine::ApplyBinarization(unsigned char* pixels, int width, int height) {
+	ApplyBinarization(ImageView(pixels, width, height));
+}
+
+void NativeEngine::ImageProcessingEngine::ApplyBinarization(unsigned char* pixels, int width, int height, const BinarizationOptions& options) {
+	ApplyBinarization(ImageView(pixels, width, height), options);
+}
+
+void NativeEngine::ImageProcessingEngine::ApplyBinarization(const ImageView& image) {
+	ApplyBinarization(image, BinarizationOptions());
+}
+
+void NativeEngine::ImageProcessingEngine::ApplyBinarization(const ImageView& image, const BinarizationOptions& options) {
+	if (!image.IsValid()) return;
+
 	const int channels = 4;
-	const int stride = width * channels;
+	const int width = image.width;
+	const int height = image.height;
 	const int pixelCount = width * height;
 
-	std::vector<unsigned char> gray(pixelCount);
-	std::vector<int> histogram(256, 0);
+	// 1. RGB  Grayscale ȯ (ĳÿ  )
+	ScratchBuffer<unsigned char> grayStorage;
+	unsigned char* gray = grayPlane(image, grayStorage);
 
-	// 1. RGB  Grayscale ȯ ( ó)
+	//  Ӱ谪:   â /л,  ֵ 鿡 ٷ 
+	if (options.method == BinarizationMethod::Bradley || options.method == BinarizationMethod::Sauvola) {
+		AdaptiveThreshold(gray, gray, width, height, options, _scratch);
 #pragma omp parallel for
-	for (int i = 0; i < pixelCount; ++i) {
-		gray[i] = static_cast<unsigned char>(
-			0.114 * pixels[i * channels + 0] +  // Blue
-			0.587 * pixels[i * channels + 1] +  // Green
-			0.299 * pixels[i * channels + 2]    // Red
-			);
+		for (int y = 0; y < height; ++y) {
+			WriteGrayRow(gray + static_cast<size_t>(y) * width, image.Row(y), width);
+		}
+		storeGrayPlane(image, gray);
+		return;
 	}
 
-	// ׷ 
-#pragma omp parallel
-	{
-		// 庰  ׷ 
-		std::vector<int> local_histogram(256, 0);
+	int optimalThreshold = std::clamp(options.threshold, 0, 255);
+	if (options.method == BinarizationMethod::Otsu) {
+		optimalThreshold = 0;
+		Histogram grayHistogram;
+		ComputeHistogram(gray, width, height, width, grayHistogram);
+		const unsigned int* histogram = grayHistogram.counts;
 
-		//  ->  ׷ 
-#pragma omp for nowait
-		for (int i = 0; i < pixelCount; i++) {
-			local_histogram[gray[i]]++;
+		//  Ӱ谪 
+		float totalSum = 0.0f;
+		for (int i = 0; i < 256; i++) {
+			totalSum += i * histogram[i];
 		}
 
-		//  -> ü ׷
-#pragma omp critical
-		for (int i = 0; i < 256; i++) {
-			histogram[i] += local_histogram[i];
+		float sumForeground = 0.0f;
+		int weightForeground = 0;
+		int weightBackground = 0;
+
+		float maxVariance = 0.0f;
+
+		for (int t = 0; t < 256; t++) {
+			weightForeground += histogram[t];
+			if (weightForeground == 0) continue;
+
+			weightBackground = pixelCount - weightForeground;
+			if (weightBackground == 0) break;
+
+			sumForeground += static_cast<float>(t * histogram[t]);
+
+			float meanForeground = sumForeground / weightForeground;
+			float meanBackground = (totalSum - sumForeground) / weightBackground;
+
+			float varianceBetween = static_cast<float>(weightForeground) *
+				static_cast<float>(weightBackground) *
+				(meanForeground - meanBackground) *
+				(meanForeground - meanBackground);
+
+			if (varianceBetween > maxVariance) {
+				maxVariance = varianceBetween;
+				optimalThreshold = t;
+			}
+		}
+	}
+
+	//  Ӱ谪
+#pragma omp parallel for
+	for (int y = 0; y < height; ++y) {
+		unsigned char* row = image.Row(y);
+		for (int x = 0; x < width; ++x) {
+			unsigned char value = (gray[y * width + x] > optimalThreshold) ? 255 : 0;
+			gray[y * width + x] = value;
+			row[x * channels + 0] = value;
+			row[x * channels + 1] = value;
+			row[x * channels + 2] = value;
 		}
 	}
 
-	//  Ӱ谪 
-	float totalSum = 0.0f;
-	for (int i = 0; i < 256; i++) {
-		totalSum += i * histogram[i];
+	//  ȸ̹Ƿ  Ͱ ״ 
+	storeGrayPlane(image, gray);
+}
+
+void NativeEngine::ImageProcessingEngine::ApplyMultiOtsu(unsigned char* pixels, int width, int height, int classes,
+	MultiOtsuOutput output, int* thresholds)
+{
+	ApplyMultiOtsu(ImageView(pixels, width, height), classes, output, thresholds);
+}
+
+void NativeEngine::ImageProcessingEngine::ApplyMultiOtsu(const ImageView& image, int classes, MultiOtsuOutput output, int* thresholds) {
+	if (!image.IsValid()) return;
+	classes = std::clamp(classes, 2, multiOtsuMaxClasses);
+
+	const int width = image.width;
+	const int height = image.height;
+	ScratchBuffer<unsigned char> grayStorage;
+	unsigned char* gray = grayPlane(image, grayStorage);
+
+	// ȭ  ׷ ܰ
+	Histogram histogram;
+	ComputeHistogram(gray, width, height, width, histogram);
+	int bounds[multiOtsuMaxClasses - 1];
+	const int count = MultiOtsuThresholds(histogram, classes, bounds, _scratch);
+	if (thresholds) std::copy(bounds, bounds + count, thresholds);
+
+	//  -> Ŭ ->   ǥ
+	unsigned char table[histogramBins];
+	for (int v = 0, label = 0; v < histogramBins; v++) {
+		while (label < count && v > bounds[label]) label++;
+		table[v] = static_cast<unsigned char>(output == MultiOtsuOutput::Labels ? label : label * 255 / (classes - 1));
 	}
+	ApplyLookupTable(gray, gray, static_cast<size_t>(width) * height, table);
 
-	float sumForeground = 0.0f;
-	int weightForeground = 0;
-	int weightBackground = 0;
+#pragma omp parallel for
+	for (int y = 0; y < height; ++y) {
+		WriteGrayRow(gray + static_cast<size_t>(y) * width, image.Row(y), width);
+	}
+	storeGrayPlane(image, gray);
+}
 
-	float maxVariance = 0.0f;
-	int optimalThreshold = 0;
+void NativeEngine::ImageProcessingEngine::ComputeHistograms(unsigned char* pixels, int width, int height, ImageHistograms& histograms) {
+	ComputeHistograms(ImageView(pixels, width, height), histograms);
+}
 
-	for (int t = 0; t < 256; t++) {
-		weightForeground += histogram[t];
-		if (weightForeground == 0) continue;
+void NativeEngine::ImageProcessingEngine::ComputeHistograms(const ImageView& image, ImageHistograms& histograms) {
+	NativeEngine::ComputeHistograms(image, histograms, _scratch);
+}
 
-		weightBackground = pixelCount - weightForeground;
-		if (weightBackground == 0) break;
+void NativeEngine::ImageProcessingEngine::ApplyHistogramEqualization(unsigned char* pixels, int width, int height) {
+	ApplyHistogramEqualization(ImageView(pixels, width, height));
+}
 
-		sumForeground += static_cast<float>(t * histogram[t]);
+void NativeEngine::ImageProcessingEngine::ApplyHistogramEqualization(const ImageView& image) {
+	if (!image.IsValid()) return;
 
-		float meanForeground = sumForeground / weightForeground;
-		float meanBackground = (totalSum - sumForeground) / weightBackground;
+	const int width = image.width;
+	const int height = image.height;
+	ScratchBuffer<unsigned char> grayStorage;
+	unsigned char* gray = grayPlane(image, grayStorage);
 
-		float varianceBetween = static_cast<float>(weightForeground) *
-			static_cast<float>(weightBackground) *
-			(meanForeground - meanBackground) *
-			(meanForeground - meanBackground);
+	Histogram histogram;
+	ComputeHistogram(gray, width, height, width, histogram);
+	unsigned char table[histogramBins];
+	EqualizationTable(histogram, table);
+	ApplyLookupTable(gray, gray, static_cast<size_t>(width) * height, table);
 
-		if (varianceBetween > maxVariance) {
-			maxVariance = varianceBetween;
-			optimalThreshold = t;
-		}
+#pragma omp parallel for
+	for (int y = 0; y < height; ++y) {
+		WriteGrayRow(gray + static_cast<size_t>(y) * width, image.Row(y), width);
 	}
+	storeGrayPlane(image, gray);
+}
+
+void NativeEngine::ImageProcessingEngine::ApplyClahe(unsigned char* pixels, int width, int height, const ClaheOptions& options) {
+	ApplyClahe(ImageView(pixels, width, height), options);
+}
+
+void NativeEngine::ImageProcessingEngine::ApplyClahe(const ImageView& image, const ClaheOptions& options) {
+	if (!image.IsValid()) return;
+
+	const int width = image.width;
+	const int height = image.height;
+	ScratchBuffer<unsigned char> grayStorage;
+	unsigned char* gray = grayPlane(image, grayStorage);
+
+	// ǥ    ȼ ڱ  Ƿ ڸ
+	Clahe(gray, gray, width, height, options, _scratch);
 
-	//  Ӱ谪
 #pragma omp parallel for
-	for (int i = 0; i < pixelCount; ++i) {
-		unsigned char value = (gray[i] > optimalThreshold) ? 255 : 0;
-		pixels[i * channels + 0] = value;
-		pixels[i * channels + 1] = value;
-		pixels[i * channels + 2] = value;
+	for (int y = 0; y < height; ++y) {
+		WriteGrayRow(gray + static_cast<size_t>(y) * width, image.Row(y), width);
 	}
+	storeGrayPlane(image, gray);
 }
 
 void NativeEngine::ImageProcessingEngine::ApplyDilation(unsigned char* pixels, int width, int height) {
-	const int channels = 4;
-	const int stride = width * channels;
-	const int dataSize = stride * height;
-	std::vector<unsigned char> temp(dataSize);
-	memcpy(temp.data(), pixels, dataSize); //  ̹ temp 
+	ApplyDilation(ImageView(pixels, width, height));
+}
 
-	// ڸ  ȼ ȸ
-#pragma omp parallel for
-	for (int y = 1; y < height - 1; y++) {
-		for (int x = 1; x < width - 1; x++) {
-			int current = y * stride + x * channels;
-			unsigned char max = 0;
-
-			// 3x3 Ŀ ȸ
-			for (int ky = -1; ky <= 1; ky++) {
-				for (int kx = -1; kx <= 1; kx++) {
-					int neighborIdx = (y + ky) * stride + (x + kx) * channels;
-					// B ä    
-					if (temp[neighborIdx] > max) {
-						max = temp[neighborIdx];
-					}
-				}
-			}
+void NativeEngine::ImageProcessingEngine::ApplyDilation(unsigned char* pixels, int width, int height, int kernelSize) {
+	ApplyDilation(ImageView(pixels, width, height), kernelSize, kernelSize);
+}
 
-			//ִ밪 
-			pixels[current + 0] = max;
-			pixels[current + 1] = max;
-			pixels[current + 2] = max;
-		}
-	}
+void NativeEngine::ImageProcessingEngine::ApplyDilation(const ImageView& image) {
+	ApplyDilation(image, 3, 3);
+}
+
+void NativeEngine::ImageProcessingEngine::ApplyDilation(const ImageView& image, int kernelWidth, int kernelHeight, MorphologyChannels channels) {
+	applyMorphology(image, kernelWidth, kernelHeight, MorphologyOp::Dilate, channels);
 }
 
 void NativeEngine::ImageProcessingEngine::ApplyErosion(unsigned char* pixels, int width, int height) {
-	const int channels = 4;
-	const int stride = width * channels;
-	const int dataSize = stride * height;
-	std::vector<unsigned char> temp(dataSize);
-	memcpy(temp.data(), pixels, dataSize);
+	ApplyErosion(ImageView(pixels, width, height));
+}
 
-	// ڸ  ȼ ȸ
-#pragma omp parallel for
-	for (int y = 1; y < height - 1; y++) {
-		for (int x = 1; x < width - 1; x++) {
-			int current_idx = y * stride + x * channels;
-			unsigned char min = 255;
-
-			// 3x3 Ŀ ȸ
-			for (int ky = -1; ky <= 1; ky++) {
-				for (int kx = -1; kx <= 1; kx++) {
-					int neighbor_idx = (y + ky) * stride + (x + kx) * channels;
-					// B   ο
-					if (temp[neighbor_idx] < min) {
-						min = temp[neighbor_idx];
-					}
-				}
-			}
+void NativeEngine::ImageProcessingEngine::ApplyErosion(unsigned char* pixels, int width, int height, int kernelSize) {
+	ApplyErosion(ImageView(pixels, width, height), kernelSize, kernelSize);
+}
+
+void NativeEngine::ImageProcessingEngine::ApplyErosion(const ImageView& image) {
+	ApplyErosion(image, 3, 3);
+}
+
+void NativeEngine::ImageProcessingEngine::ApplyErosion(const ImageView& image, int kernelWidth, int kernelHeight, MorphologyChannels channels) {
+	applyMorphology(image, kernelWidth, kernelHeight, MorphologyOp::Erode, channels);
+}
+
+void NativeEngine::ImageProcessingEngine::ApplyMorphology(unsigned char* pixels, int width, int height, CompoundMorphology op, int kernelSize) {
+	ApplyMorphology(ImageView(pixels, width, height), op, kernelSize, kernelSize);
+}
+
+void NativeEngine::ImageProcessingEngine::ApplyMorphology(const ImageView& image, CompoundMorphology op, int kernelWidth, int kernelHeight,
+	MorphologyChannels channels)
+{
+	if (!image.IsValid()) return;
+	invalidateGrayPlane(image);
 
-			// ּҰ 
-			pixels[current_idx + 0] = min;
-			pixels[current_idx + 1] = min;
-			pixels[current_idx + 2] = min;
+	const int planeChannels = channels == MorphologyChannels::Color ? 4 : 1;
+	ScratchBuffer<unsigned char> plane(_scratch, static_cast<size_t>(image.width) * image.height * planeChannels);
+	extractMorphologyPlane(image, plane.data(), planeChannels);
+
+	// ߰  ̹    (ܰ ̴   )
+	MorphologyCompound(plane.data(), image, planeChannels, kernelWidth, kernelHeight, op, _scratch);
+}
+
+void NativeEngine::ImageProcessingEngine::applyMorphology(const ImageView& image, int kernelWidth, int kernelHeight,
+	MorphologyOp op, MorphologyChannels channels)
+{
+	if (!image.IsValid()) return;
+	invalidateGrayPlane(image);
+
+	const int width = image.width;
+	const int height = image.height;
+	const int planeChannels = channels == MorphologyChannels::Color ? 4 : 1;
+	const size_t planeSize = static_cast<size_t>(width) * height * planeChannels;
+	ScratchBuffer<unsigned char> plane(_scratch, planeSize);
+	ScratchBuffer<unsigned char> temp(_scratch, planeSize);
+	extractMorphologyPlane(image, plane.data(), planeChannels);
+
+	// 簢  Ҵ   ->   и, ȼ  Ŀ ũ 
+	MorphologyRows(plane.data(), temp.data(), width, height, planeChannels, kernelWidth, op, _scratch);
+	MorphologyColumns(temp.data(), plane.data(), width, height, planeChannels, kernelHeight, op, _scratch);
+
+	//  B, G, R (Gray ¿  ), Ĵ ״
+	const int channelCount = 4;
+	const int green = planeChannels == channelCount ? 1 : 0;
+	const int red = planeChannels == channelCount ? 2 : 0;
+#pragma omp parallel for schedule(static)
+	for (int y = 0; y < height; y++) {
+		unsigned char* row = image.Row(y);
+		const unsigned char* in = plane.data() + static_cast<size_t>(y) * width * planeChannels;
+		for (int x = 0; x < width; x++) {
+			const int current = x * channelCount;
+			const int value = x * planeChannels;
+			row[current + 0] = in[value];
+			row[current + 1] = in[value + green];
+			row[current + 2] = in[value + red];
 		}
 	}
 }
 
-void NativeEngine::ImageProcessingEngine::ApplySobel(unsigned char* pixels, int width, int height) {
-	const int channels = 4;
-	const int stride = width * channels;
-	const int pixelNum = width * height;
+void NativeEngine::ImageProcessingEngine::ApplyDistanceTransform(unsigned char* pixels, int width, int height, float* distances) {
+	ApplyDistanceTransform(ImageView(pixels, width, height), distances);
+}
 
-	// ׷̽ ؼ ӽù ֱ
-	std::vector<unsigned char> gray_pixels(pixelNum);
-#pragma omp parallel for
-	for (int i = 0; i < pixelNum; ++i) {
-		gray_pixels[i] = static_cast<unsigned char>(
-			0.114 * pixels[i * channels + 0] + // Blue
-			0.587 * pixels[i * channels + 1] + // Green
-			0.299 * pixels[i * channels + 2]   // Red
-			);
-	}
+void NativeEngine::ImageProcessingEngine::ApplyDistanceTransform(unsigned char* pixels, int width, int height, unsigned short* distances) {
+	ApplyDistanceTransform(ImageView(pixels, width, height), distances);
+}
 
-	// ׷Ʈ    
-	std::vector<unsigned char> result(pixelNum, 0);
-	std::vector<double> gradientX(pixelNum, 0);
-	std::vector<double> gradientY(pixelNum, 0);
+void NativeEngine::ImageProcessingEngine::ApplyDistanceTransform(const ImageView& image, float* distances) {
+	distanceTransform(image, distances);
+}
 
-	// Һ Ŀ
-	int kernelX[3][3] = { {-1, 0, 1}, {-2, 0, 2}, {-1, 0, 1} };
-	int kernelY[3][3] = { {1, 2, 1}, {0, 0, 0}, {-1, -2, -1} };
+void NativeEngine::ImageProcessingEngine::ApplyDistanceTransform(const ImageView& image, unsigned short* distances) {
+	distanceTransform(image, distances);
+}
 
-	//  
-#pragma omp parallel for
-	for (int y = 1; y < height - 1; y++) {
-		for (int x = 1; x < width - 1; x++) {
-			double sumX = 0;
-			double sumY = 0;
-			for (int ky = -1; ky <= 1; ky++) {
-				for (int kx = -1; kx <= 1; kx++) {
-					int pixelVal = gray_pixels[(y + ky) * width + (x + kx)];
-					sumX += pixelVal * kernelX[ky + 1][kx + 1];
-					sumY += pixelVal * kernelY[ky + 1][kx + 1];
-				}
-			}
-			double magnitude = sqrt(pow(sumX, 2) + pow(sumY, 2));
-			result[y * width + x] = static_cast<unsigned char>(std::clamp(magnitude, 0.0, 255.0));
+int NativeEngine::ImageProcessingEngine::LabelComponents(unsigned char* pixels, int width, int height, Connectivity connectivity,
+	int* labels, std::vector<Blob>& blobs)
+{
+	return LabelComponents(ImageView(pixels, width, height), connectivity, labels, blobs);
+}
+
+int NativeEngine::ImageProcessingEngine::LabelComponents(const ImageView& image, Connectivity connectivity, int* labels, std::vector<Blob>& blobs) {
+	blobs.clear();
+	if (!image.IsValid()) return 0;
+
+	ScratchBuffer<unsigned char> grayStorage;
+	const unsigned char* gray = grayPlane(image, grayStorage);
+	return NativeEngine::LabelComponents(gray, image.width, image.height, 128, connectivity, labels, blobs, _scratch);
+}
+
+void NativeEngine::ImageProcessingEngine::ApplyDiskDilation(unsigned char* pixels, int width, int height, float radius) {
+	ApplyDiskDilation(ImageView(pixels, width, height), radius);
+}
+
+void NativeEngine::ImageProcessingEngine::ApplyDiskErosion(unsigned char* pixels, int width, int height, float radius) {
+	ApplyDiskErosion(ImageView(pixels, width, height), radius);
+}
+
+void NativeEngine::ImageProcessingEngine::ApplyDiskDilation(const ImageView& image, float radius) {
+	applyDiskMorphology(image, radius, true);
+}
+
+void NativeEngine::ImageProcessingEngine::ApplyDiskErosion(const ImageView& image, float radius) {
+	applyDiskMorphology(image, radius, false);
+}
+
+template <typename Distance>
+void NativeEngine::ImageProcessingEngine::distanceTransform(const ImageView& image, Distance* distances) {
+	if (!image.IsValid() || distances == nullptr) return;
+
+	PackBinary(image, _binary);
+	DistanceTransform(_binary, DistanceTarget::Background, distances, _scratch);
+}
+
+void NativeEngine::ImageProcessingEngine::applyDiskMorphology(const ImageView& image, float radius, bool dilate) {
+	if (!image.IsValid()) return;
+	invalidateGrayPlane(image);
+
+	// 3x3 ݺ  Ÿ ȯ   + Ӱ谪 (1Ʈ  ó)
+	PackBinary(image, _binary);
+	if (dilate) BinaryDilateDisk(_binary, _binary, radius, _scratch);
+	else BinaryErodeDisk(_binary, _binary, radius, _scratch);
+	UnpackBinary(_binary, image);
+}
+
+// Color: ̹  BGRA  / Gray: B äθ
+void NativeEngine::ImageProcessingEngine::extractMorphologyPlane(const ImageView& image, unsigned char* plane, int planeChannels) {
+	const int channels = 4;
+	const int width = image.width;
+	const int blue = image.BlueOffset();
+
+#pragma omp parallel for schedule(static)
+	for (int y = 0; y < image.height; y++) {
+		const unsigned char* row = image.Row(y);
+		unsigned char* out = plane + static_cast<size_t>(y) * width * planeChannels;
+		if (planeChannels == channels) {
+			memcpy(out, row, static_cast<size_t>(width) * channels);
+		}
+		else {
+			for (int x = 0; x < width; x++) out[x] = row[x * channels + blue];
 		}
 	}
+}
 
-	//  
-#pragma omp parallel for
-	for (int i = 0; i < pixelNum; ++i) {
-		pixels[i * channels + 0] = result[i];
-		pixels[i * channels + 1] = result[i];
-		pixels[i * channels + 2] = result[i];
+void NativeEngine::ImageProcessingEngine::ApplySobel(unsigned char* pixels, int width, int height) {
+	ApplySobel(ImageView(pixels, width, height));
+}
+
+void NativeEngine::ImageProcessingEngine::ApplySobel(unsigned char* pixels, int width, int height, GradientNorm norm, unsigned char* directions) {
+	ApplySobel(ImageView(pixels, width, height), norm, directions);
+}
+
+void NativeEngine::ImageProcessingEngine::ApplySobel(const ImageView& image, GradientNorm norm, unsigned char* directions) {
+	if (!image.IsValid()) return;
+
+	// ĳõ ֵ  а,  Ͱ ึ ȯ (ü ȯ н )
+	//  ũ ĳ 鿡 ٷ  (Sobel -> ȭ üο )
+	unsigned char* magnitude = nullptr;
+	if (image.generation != 0) {
+		_grayPlane.resize(static_cast<size_t>(image.width) * image.height);
+		magnitude = _grayPlane.data();
 	}
+	const unsigned char* gray = hasGrayPlane(image) ? _grayPlane.data() : nullptr;
+
+	SobelFilter(image, gray, magnitude, directions, norm, _scratch);
+
+	if (magnitude) storeGrayPlane(image, magnitude);
+	else invalidateGrayPlane(image);
+}
+
+void NativeEngine::ImageProcessingEngine::ApplyCanny(unsigned char* pixels, int width, int height, float sigma, int lowThreshold, int highThreshold) {
+	ApplyCanny(ImageView(pixels, width, height), sigma, lowThreshold, highThreshold);
+}
+
+void NativeEngine::ImageProcessingEngine::ApplyCanny(const ImageView& image, float sigma, int lowThreshold, int highThreshold, GradientNorm norm) {
+	if (!image.IsValid()) return;
+
+	//  -> Һ -> ִ    ̾,  鸸 ü ũ
+	const unsigned char* gray = hasGrayPlane(image) ? _grayPlane.data() : nullptr;
+	ScratchBuffer<unsigned char> edges(_scratch, static_cast<size_t>(image.width) * image.height);
+	CannyFilter(image, gray, edges.data(), sigma, lowThreshold, highThreshold, norm, _scratch);
+
+	storeGrayPlane(image, edges.data());
 }
 
 void NativeEngine::ImageProcessingEngine::ApplyLaplacian(unsigned char* pixels, int width, int height) {
-	const int channels = 4;
-	const int stride = width * channels;
-	const int pixelNum = width * height;
+	ApplyLaplacian(ImageView(pixels, width, height));
+}
 
-	// ׷̽ ȯ
-	std::vector<unsigned char> temp(pixelNum);
+void NativeEngine::ImageProcessingEngine::ApplyLaplacian(unsigned char* pixels, int width, int height, StencilOperator kernel, LaplacianScale scale) {
+	ApplyLaplacian(ImageView(pixels, width, height), kernel, scale);
+}
 
-#pragma omp parallel for
-	for (int i = 0; i < pixelNum; ++i) {
-		temp[i] = static_cast<unsigned char>(
-			0.114 * pixels[i * channels + 0] + // Blue
-			0.587 * pixels[i * channels + 1] + // Green
-			0.299 * pixels[i * channels + 2]   // Red
-			);
-	}
+void NativeEngine::ImageProcessingEngine::ApplyLaplacian(const ImageView& image, StencilOperator kernel, LaplacianScale scale) {
+	if (!image.IsValid()) return;
+	if (kernel != StencilOperator::Laplacian4) kernel = StencilOperator::Laplacian8;
 
-	// ö   
-	std::vector<int> laplacianResult(pixelNum, 0);
+	const int width = image.width;
+	const int height = image.height;
+	const int pixelNum = width * height;
 
-	// 8 
-#pragma omp parallel for
-	for (int y = 1; y < height - 1; y++) {
-		for (int x = 1; x < width - 1; x++) {
-			int current_idx = y * width + x;
-
-			int upLeft = temp[(y - 1) * width + (x - 1)];
-			int up = temp[(y - 1) * width + x];
-			int upRight = temp[(y - 1) * width + (x + 1)];
-			int left = temp[y * width + (x - 1)];
-			int current = temp[current_idx];
-			int right = temp[y * width + (x + 1)];
-			int downLeft = temp[(y + 1) * width + (x - 1)];
-			int down = temp[(y + 1) * width + x];
-			int downRight = temp[(y + 1) * width + (x + 1)];
-
-			// 8 ȼ  - 8 * ߾Ӱ
-			int laplacianValue = (upLeft + up + upRight + left + right + downLeft + down + downRight) - 8 * current;
-
-			//  ->  ðȭ
-			laplacianResult[current_idx] = abs(laplacianValue);
+	// ֵ ĳÿ  а,  ึ ȯ
+	const unsigned char* gray = hasGrayPlane(image) ? _grayPlane.data() : nullptr;
+
+	//  : ٽ    ( ĳ 鿡 ٷ)
+	if (scale == LaplacianScale::Fixed) {
+		unsigned char* result = nullptr;
+		if (image.generation != 0) {
+			_grayPlane.resize(pixelNum);
+			result = _grayPlane.data();
 		}
+		StencilFilter(image, gray, result, kernel, _scratch);
+		if (result) storeGrayPlane(image, result);
+		else invalidateGrayPlane(image);
+		return;
 	}
 
-	// ȭ
+	// |öþ| 16Ʈ  + ະ ִ (ٽǰ  н)
+	ScratchBuffer<short> laplacianResult(_scratch, pixelNum);
+	ScratchBuffer<short> rowMax(_scratch, height);
+	StencilResponse(image, gray, laplacianResult.data(), kernel, _scratch, rowMax.data());
+
 	int max_val = 0;
-#pragma omp parallel for reduction(max:max_val)
-	for (int i = 0; i < pixelNum; i++) {
-		if (laplacianResult[i] > max_val) {
-			max_val = laplacianResult[i];
-		}
-	}
+	for (int y = 0; y < height; y++) max_val = std::max(max_val, static_cast<int>(rowMax[y]));
 
-	if (max_val == 0) max_val = 1;
 	// 0  
-	if (max_val == 0) {
-		max_val = 1;
+	if (max_val == 0) max_val = 1;
+
+	//  -> 0~255 ǥ ( 0 ~ max_val, ȼ  ),   ־ ÿ
+	std::array<unsigned char, laplacianMaxResponse + 1> normalize;
+	for (int v = 0; v <= max_val; v++) normalize[v] = static_cast<unsigned char>((v * 255) / max_val);
+
+	// ȭ  (   ڶ ĳ 鿡 ٷ ᵵ , ĳ   庰  ุ)
+	unsigned char* temp = nullptr;
+	if (image.generation != 0) {
+		_grayPlane.resize(pixelNum);
+		temp = _grayPlane.data();
 	}
+#pragma omp parallel
+	{
+		ScratchBuffer<unsigned char> line;
+		if (temp == nullptr) line = ScratchBuffer<unsigned char>(_scratch, width);
 
-	// ȭ 
-#pragma omp parallel for
-	for (int i = 0; i < pixelNum; ++i) {
-		unsigned char result = static_cast<unsigned char>((laplacianResult[i] * 255) / max_val);
-		pixels[i * channels + 0] = result; // Blue
-		pixels[i * channels + 1] = result; // Green
-		pixels[i * channels + 2] = result; // Red
-		// Alpha ä ״ 
+#pragma omp for
+		for (int y = 0; y < height; ++y) {
+			unsigned char* out = temp ? temp + static_cast<size_t>(y) * width : line.data();
+			const short* response = laplacianResult.data() + static_cast<size_t>(y) * width;
+			for (int x = 0; x < width; ++x) out[x] = normalize[response[x]];
+			WriteGrayRow(out, image.Row(y), width);
+		}
 	}
-}
 
-void NativeEngine::ImageProcessingEngine::ApplyTemplateMatch(
-	unsigned char* originalPixels, int originalWidth, int originalHeight,
-	unsigned char* templatePixels, int templateWidth, int templateHeight,
-	int* matchX, int* matchY)
-{
-	const int channels = 4;
-	const int originalPixelNum = originalWidth * originalHeight;
-	const int templatePixelNum = templateWidth * templateHeight;
+	if (temp) storeGrayPlane(image, temp);
+	else invalidateGrayPlane(image);
+}
 
-	// ޸ Ҵ  
-	std::vector<unsigned char> originalGray(originalPixelNum);
-	std::vector<unsigned char> templateGray(templatePixelNum);
+void NativeEngine::ImageProcessingEngine::ApplyStencil(unsigned char* pixels, int width, int height, StencilOperator op) {
+	ApplyStencil(ImageView(pixels, width, height), op);
+}
 
-	// ׷̽ ȯ ȭ ( )
-#pragma omp parallel for schedule(static)
-	for (int i = 0; i < originalPixelNum; ++i) {
-		const int base = i * channels;
-		const unsigned int sum = originalPixels[base] + originalPixels[base + 1] + originalPixels[base + 2];
-		originalGray[i] = static_cast<unsigned char>(sum / 3);
+void NativeEngine::ImageProcessingEngine::ApplyStencil(const ImageView& image, StencilOperator op) {
+	if (!image.IsValid()) return;
+
+	switch (op) {
+	case StencilOperator::Laplacian4:
+	case StencilOperator::Laplacian8:
+		ApplyLaplacian(image, op);
+		return;
+	case StencilOperator::Sobel:
+		ApplySobel(image);
+		return;
+	default:
+		break;
 	}
 
-#pragma omp parallel for schedule(static)
-	for (int i = 0; i < templatePixelNum; ++i) {
-		const int base = i * channels;
-		const unsigned int sum = templatePixels[base] + templatePixels[base + 1] + templatePixels[base + 2];
-		templateGray[i] = static_cast<unsigned char>(sum / 3);
+	//  ĳ 鿡 ٷ  (ApplySobel  )
+	unsigned char* result = nullptr;
+	if (image.generation != 0) {
+		_grayPlane.resize(static_cast<size_t>(image.width) * image.height);
+		result = _grayPlane.data();
 	}
+	const unsigned char* gray = hasGrayPlane(image) ? _grayPlane.data() : nullptr;
 
-	// ˻ 
-	const int searchHeight = originalHeight - templateHeight + 1;
-	const int searchWidth = originalWidth - templateWidth + 1;
-	const int totalSearchPoints = searchHeight * searchWidth;
-
-	//   ü 迭
-	struct MatchResult {
-		long long sad;
-		int x, y;
-	};
+	StencilFilter(image, gray, result, op, _scratch);
 
-	std::vector<MatchResult> results(totalSearchPoints);
+	if (result) storeGrayPlane(image, result);
+	else invalidateGrayPlane(image);
+}
 
-	// ķ  ġ SAD 
-#pragma omp parallel for schedule(static)
-	for (int idx = 0; idx < totalSearchPoints; idx++) {
-		const int y = idx / searchWidth;
-		const int x = idx % searchWidth;
-
-		long long currentSAD = 0;
-
-		// ĳ ģȭ  ø Ī
-		for (int ty = 0; ty < templateHeight; ty++) {
-			const int origRowStart = (y + ty) * originalWidth + x;
-			const int tempRowStart = ty * templateWidth;
-
-			//   óϿ ĳ ȿ 
-			for (int tx = 0; tx < templateWidth; tx++) {
-				const int diff = static_cast<int>(originalGray[origRowStart + tx]) -
-					static_cast<int>(templateGray[tempRowStart + tx]);
-				currentSAD += (diff < 0) ? -diff : diff;  // abs()  Ǻ 
-			}
-		}
+void NativeEngine::ImageProcessingEngine::BuildScaleSpace(unsigned char* pixels, int width, int height,
+	const ScaleSpaceOptions& options, ScaleSpace& space)
+{
+	BuildScaleSpace(ImageView(pixels, width, height), options, space);
+}
 
-		results[idx] = { currentSAD, x, y };
+void NativeEngine::ImageProcessingEngine::BuildScaleSpace(const ImageView& image, const ScaleSpaceOptions& options, ScaleSpace& space) {
+	if (!image.IsValid()) {
+		space.gaussians.clear();
+		space.responses.clear();
+		return;
 	}
 
-	// ּҰ ã ( ó - reduction )
-	MatchResult bestMatch = results[0];
-	for (int i = 1; i < totalSearchPoints; i++) {
-		if (results[i].sad < bestMatch.sad) {
-			bestMatch = results[i];
-		}
-	}
+	// ֵ   ȯ (ĳÿ  ), Ĵ float 鸸 
+	ScratchBuffer<unsigned char> grayStorage;
+	const unsigned char* gray = grayPlane(image, grayStorage);
+	NativeEngine::BuildScaleSpace(gray, image.width, image.height, options, space, _scratch);
+}
 
-	*matchX = bestMatch.x;
-	*matchY = bestMatch.y;
+void NativeEngine::ImageProcessingEngine::ApplyTemplateMatch(
+	unsigned char* originalPixels, int originalWidth, int originalHeight,
+	unsigned char* templatePixels, int templateWidth, int templateHeight,
+	int* matchX, int* matchY, const TemplateMatchOptions& options)
+{
+	ApplyTemplateMatch(ImageView(originalPixels, originalWidth, originalHeight),
+		ImageView(templatePixels, templateWidth, templateHeight), matchX, matchY, options);
 }
 
-void fft1d(vector<complex<double>>& data, bool inverse = false) {
-	int num = data.size();
+void NativeEngine::ImageProcessingEngine::ApplyTemplateMatch(
+	const ImageView& original, const ImageView& templ, int* matchX, int* matchY, const TemplateMatchOptions& options)
+{
+	*matchX = -1;
+	*matchY = -1;
+	if (!original.IsValid() || !templ.IsValid()) return;
+	if (templ.width > original.width || templ.height > original.height) return;
+
+	// ٸ Ϳ  ֵ ȯ ( ĳÿ  )
+	ScratchBuffer<unsigned char> originalStorage;
+	const unsigned char* originalGray = grayPlane(original, originalStorage);
+	ScratchBuffer<unsigned char> templateGray(_scratch, static_cast<size_t>(templ.width) * templ.height);
+	ConvertToGray(templ, templateGray.data());
+
+	MatchTemplate(originalGray, original.width, original.height, templateGray.data(), templ.width, templ.height,
+		options, matchX, matchY, _scratch);
+}
+
+void fft1d(complex<double>* data, int num, bool inverse = false) {
 	if (num <= 1) return;
 
 	// Ʈ    
@@ -554,6 +762,10 @@ void fft1d(vector<complex<double>>& data, bool inverse = false) {
 }
 
 //shift  !
+void fft1d(vector<complex<double>>& data, bool inverse = false) {
+	fft1d(data.data(), static_cast<int>(data.size()), inverse);
+}
+
 void NativeEngine::ImageProcessingEngine::fftShift() {
 	int height = _fftData.size();
 	int width = _fftData[0].size();
@@ -582,7 +794,15 @@ int nextPowerOf2(int n) {
 }
 
 bool NativeEngine::ImageProcessingEngine::ApplyFFT(unsigned char* pixels, int width, int height) {
+	return ApplyFFT(ImageView(pixels, width, height));
+}
+
+bool NativeEngine::ImageProcessingEngine::ApplyFFT(const ImageView& image) {
+	if (!image.IsValid()) return false;
+
 	const int channels = 4;
+	const int width = image.width;
+	const int height = image.height;
 
 	// е ũ 
 	int padWidth = nextPowerOf2(width);
@@ -590,15 +810,15 @@ bool NativeEngine::ImageProcessingEngine::ApplyFFT(unsigned char* pixels, int wi
 
 	_fftData.assign(padHeight, vector<complex<double>>(padWidth));
 
-	// ׷̽ ȯ  е   ó
+	ScratchBuffer<unsigned char> grayStorage;
+	const unsigned char* gray = grayPlane(image, grayStorage);
+
+	// ׷̽   е   ó
 #pragma omp parallel for schedule(static)
 	for (int j = 0; j < padHeight; j++) {
 		for (int i = 0; i < padWidth; i++) {
 			if (j < height && i < width) {
-				const int idx = (j * width + i) * channels;
-				//   ȭ
-				const int weighted_sum = 114 * pixels[idx] + 587 * pixels[idx + 1] + 299 * pixels[idx + 2];
-				_fftData[j][i] = complex<double>(weighted_sum / 1000.0, 0.0);
+				_fftData[j][i] = complex<double>(gray[static_cast<size_t>(j) * width + i], 0.0);
 			}
 			else {
 				_fftData[j][i] = complex<double>(0.0, 0.0);
@@ -612,15 +832,20 @@ bool NativeEngine::ImageProcessingEngine::ApplyFFT(unsigned char* pixels, int wi
 		fft1d(_fftData[j], false);
 	}
 
-#pragma omp parallel for schedule(static)
-	for (int i = 0; i < padWidth; i++) {
-		vector<complex<double>> col(padHeight);
-		for (int j = 0; j < padHeight; j++) {
-			col[j] = _fftData[j][i];
-		}
-		fft1d(col, false);
-		for (int j = 0; j < padHeight; j++) {
-			_fftData[j][i] = col[j];
+#pragma omp parallel
+	{
+		//  ۴   
+		ScratchBuffer<complex<double>> col(_scratch, padHeight);
+
+#pragma omp for schedule(static)
+		for (int i = 0; i < padWidth; i++) {
+			for (int j = 0; j < padHeight; j++) {
+				col[j] = _fftData[j][i];
+			}
+			fft1d(col.data(), padHeight, false);
+			for (int j = 0; j < padHeight; j++) {
+				_fftData[j][i] = col[j];
+			}
 		}
 	}
 
@@ -629,12 +854,12 @@ bool NativeEngine::ImageProcessingEngine::ApplyFFT(unsigned char* pixels, int wi
 
 	//  ̹  ȭ
 	double max_val = 0.0;
-	vector<vector<double>> mag(padHeight, vector<double>(padWidth));
+	ScratchBuffer<double> mag(_scratch, static_cast<size_t>(padHeight) * padWidth);
 
 #pragma omp parallel for schedule(static)
 	for (int j = 0; j < padHeight; j++) {
 		for (int i = 0; i < padWidth; i++) {
-			mag[j][i] = std::log1p(std::abs(_fftData[j][i]));
+			mag[static_cast<size_t>(j) * padWidth + i] = std::log1p(std::abs(_fftData[j][i]));
 		}
 	}
 
@@ -642,7 +867,8 @@ bool NativeEngine::ImageProcessingEngine::ApplyFFT(unsigned char* pixels, int wi
 #pragma omp parallel for reduction(max:max_val)
 	for (int j = 0; j < padHeight; j++) {
 		for (int i = 0; i < padWidth; i++) {
-			if (mag[j][i] > max_val) max_val = mag[j][i];
+			const double m = mag[static_cast<size_t>(j) * padWidth + i];
+			if (m > max_val) max_val = m;
 		}
 	}
 
@@ -652,13 +878,15 @@ bool NativeEngine::ImageProcessingEngine::ApplyFFT(unsigned char* pixels, int wi
 	const int startY = (padHeight - height) / 2;
 	const double inv_max = 255.0 / max_val;
 
+	invalidateGrayPlane(image);
+
 #pragma omp parallel for schedule(static)
 	for (int j = 0; j < height; j++) {
 		for (int x = 0; x < width; x++) {
-			const unsigned char v = static_cast<unsigned char>(mag[j + startY][x + startX] * inv_max);
-			const int idx = (j * width + x) * channels;
-			pixels[idx] = pixels[idx + 1] = pixels[idx + 2] = v;
-			pixels[idx + 3] = 255;
+			const unsigned char v = static_cast<unsigned char>(mag[static_cast<size_t>(j + startY) * padWidth + x + startX] * inv_max);
+			unsigned char* px = image.Row(j) + x * channels;
+			px[0] = px[1] = px[2] = v;
+			px[3] = 255;
 		}
 	}
 
@@ -666,24 +894,34 @@ bool NativeEngine::ImageProcessingEngine::ApplyFFT(unsigned char* pixels, int wi
 }
 
 bool NativeEngine::ImageProcessingEngine::ApplyIFFT(unsigned char* pixels, int width, int height) {
-	if (_fftDataBackup.empty()) return false;
+	return ApplyIFFT(ImageView(pixels, width, height));
+}
+
+bool NativeEngine::ImageProcessingEngine::ApplyIFFT(const ImageView& image) {
+	if (_fftDataBackup.empty() || !image.IsValid()) return false;
 
 	const int channels = 4;
+	const int width = std::min(image.width, static_cast<int>(_fftDataBackup[0].size()));
+	const int height = std::min(image.height, static_cast<int>(_fftDataBackup.size()));
 	const int padHeight = _fftDataBackup.size();
 	const int padWidth = _fftDataBackup[0].size();
 
 	// ص   (shift )
 	_fftData = _fftDataBackup;
+	invalidateGrayPlane(image);
 
 	// 2D IFFT ( -> )
 #pragma omp parallel for
 	for (int y = 0; y < padHeight; y++) fft1d(_fftData[y], true);
-#pragma omp parallel for
-	for (int x = 0; x < padWidth; x++) {
-		vector<complex<double>> col(padHeight);
-		for (int y = 0; y < padHeight; y++) col[y] = _fftData[y][x];
-		fft1d(col, true);
-		for (int y = 0; y < padHeight; y++) _fftData[y][x] = col[y];
+#pragma omp parallel
+	{
+		ScratchBuffer<complex<double>> col(_scratch, padHeight);
+#pragma omp for
+		for (int x = 0; x < padWidth; x++) {
+			for (int y = 0; y < padHeight; y++) col[y] = _fftData[y][x];
+			fft1d(col.data(), padHeight, true);
+			for (int y = 0; y < padHeight; y++) _fftData[y][x] = col[y];
+		}
 	}
 
 	//  ̹ ũ⿡ °  ̹ ߶ 
@@ -694,11 +932,11 @@ bool NativeEngine::ImageProcessingEngine::ApplyIFFT(unsigned char* pixels, int w
 			unsigned char gray = static_cast<unsigned char>(std::clamp(round(val), 0.0, 255.0));
 
 			//BGRA óϱ
-			int idx = (y * width + x) * channels;
-			pixels[idx + 0] = gray;
-			pixels[idx + 1] = gray;
-			pixels[idx + 2] = gray;
-			pixels[idx + 3] = 255;
+			unsigned char* px = image.Row(y) + x * channels;
+			px[0] = gray;
+			px[1] = gray;
+			px[2] = gray;
+			px[3] = 255;
 		}
 	}
 
@@ -717,3 +955,86 @@ bool NativeEngine::ImageProcessingEngine::HasFFTData() {
 	return !_fftDataBackup.empty() && !_fftDataBackup[0].empty();
 }
 
+
+
+size_t NativeEngine::ImageProcessingEngine::GetScratchHighWaterMark() {
+	return _scratch.HighWaterMark();
+}
+
+size_t NativeEngine::ImageProcessingEngine::GetScratchReservedBytes() {
+	return _scratch.ReservedBytes();
+}
+
+size_t NativeEngine::ImageProcessingEngine::GetScratchHeapAllocations() {
+	return _scratch.HeapAllocations();
+}
+
+void NativeEngine::ImageProcessingEngine::TrimScratch() {
+	_scratch.Trim();
+}
+
+void NativeEngine::ImageProcessingEngine::ClearGrayPlaneCache() {
+	_grayPlaneValid = false;
+	_grayPlane.clear();
+	_grayPlane.shrink_to_fit();
+}
+
+namespace {
+	bool sameBuffer(const NativeEngine::ImageView& a, const NativeEngine::ImageView& b) {
+		return a.data == b.data && a.width == b.width && a.height == b.height &&
+			a.stride == b.stride && a.layout == b.layout && a.generation == b.generation;
+	}
+
+	bool overlaps(const NativeEngine::ImageView& a, const NativeEngine::ImageView& b) {
+		const unsigned char* aEnd = a.Row(a.height - 1) + a.width * NativeEngine::ImageView::channels;
+		const unsigned char* bEnd = b.Row(b.height - 1) + b.width * NativeEngine::ImageView::channels;
+		return a.data < bEnd && b.data < aEnd;
+	}
+}
+
+// ĳõ  Ǵ  ȯ  ( ,  storeGrayPlane ȣ)
+// generation 0  ĳ ʰ storage ȯ
+unsigned char* NativeEngine::ImageProcessingEngine::grayPlane(const ImageView& image, ScratchBuffer<unsigned char>& storage) {
+	const size_t pixelNum = static_cast<size_t>(image.width) * image.height;
+
+	if (image.generation == 0) {
+		storage = ScratchBuffer<unsigned char>(_scratch, pixelNum);
+		ConvertToGray(image, storage.data());
+		return storage.data();
+	}
+
+	if (!_grayPlaneValid || !sameBuffer(_grayPlaneKey, image)) {
+		_grayPlane.resize(pixelNum);
+		ConvertToGray(image, _grayPlane.data());
+		_grayPlaneKey = image;
+		_grayPlaneValid = true;
+	}
+	return _grayPlane.data();
+}
+
+bool NativeEngine::ImageProcessingEngine::hasGrayPlane(const ImageView& image) const {
+	return image.generation != 0 && _grayPlaneValid && sameBuffer(_grayPlaneKey, image);
+}
+
+//   ȸ     Բ ĳ 
+void NativeEngine::ImageProcessingEngine::storeGrayPlane(const ImageView& image, const unsigned char* plane) {
+	if (image.generation == 0) {
+		invalidateGrayPlane(image);
+		return;
+	}
+
+	const size_t pixelNum = static_cast<size_t>(image.width) * image.height;
+	if (plane != _grayPlane.data()) {
+		_grayPlane.resize(pixelNum);
+		memcpy(_grayPlane.data(), plane, pixelNum);
+	}
+	_grayPlaneKey = image;
+	_grayPlaneValid = true;
+}
+
+// ĳõ  ġ ۸ ġ 
+void NativeEngine::ImageProcessingEngine::invalidateGrayPlane(const ImageView& image) {
+	if (_grayPlaneValid && overlaps(_grayPlaneKey, image)) {
+		_grayPlaneValid = false;
+	}
+}
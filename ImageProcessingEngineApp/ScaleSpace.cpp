@@ -0,0 +1,151 @@
+﻿#include <omp.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "ScaleSpace.h"
+#include "GaussianFilter.h"
+
+using namespace std;
+
+namespace {
+	// sigma 0.5 미만은 가우시안 근사 범위 밖이라 블러 생략 (차이가 양자화 오차 수준)
+	constexpr float minBlurSigma = 0.5f;
+
+	// 재귀 근사(sigma 2 이상)는 꼬리 모양 오차가 1단계쯤이라 작은 이웃 장 차이(DoG)에는 여전히 큼
+	// 큰 sigma는 탭 필터 n번으로 나눔 (분산이 더해져 sigma / sqrt(n)씩)
+	// src -> dst (src는 그대로), 여러 번이면 임시 평면과 번갈아 마지막이 dst에 오도록
+	void blurPlane(const float* src, float* dst, int width, int height, float sigma, NativeEngine::ScratchPool& scratch) {
+		const size_t planeSize = static_cast<size_t>(width) * height;
+		if (sigma < minBlurSigma) {
+			memcpy(dst, src, sizeof(float) * planeSize);
+			return;
+		}
+
+		const float limit = NativeEngine::gaussianRecursiveMinSigma * 0.95f;
+		const int passes = static_cast<int>(ceil((sigma / limit) * (sigma / limit)));
+		const NativeEngine::GaussianKernel kernel = NativeEngine::ComputeGaussianKernel(sigma / sqrt(static_cast<float>(passes)), scratch);
+
+		NativeEngine::ScratchBuffer<float> temp;
+		if (passes > 1) temp = NativeEngine::ScratchBuffer<float>(scratch, planeSize);
+		const float* current = src;
+		for (int i = 0; i < passes; i++) {
+			float* target = (passes - 1 - i) % 2 == 0 ? dst : temp.data();
+			NativeEngine::GaussianPlane(current, target, width, height, kernel, scratch);
+			current = target;
+		}
+	}
+
+	// 2배 솎아 내기 (짝수 좌표), dst는 (width + 1) / 2 x (height + 1) / 2
+	void decimate(const float* src, int width, int height, float* dst) {
+		const int dstWidth = (width + 1) / 2;
+		const int dstHeight = (height + 1) / 2;
+#pragma omp parallel for schedule(static)
+		for (int y = 0; y < dstHeight; y++) {
+			const float* row = src + static_cast<size_t>(y) * 2 * width;
+			float* out = dst + static_cast<size_t>(y) * dstWidth;
+			for (int x = 0; x < dstWidth; x++) out[x] = row[x * 2];
+		}
+	}
+
+	void difference(const float* upper, const float* lower, float* dst, int width, int height) {
+		const long long count = static_cast<long long>(width) * height;
+#pragma omp parallel for schedule(static)
+		for (long long i = 0; i < count; i++) dst[i] = upper[i] - lower[i];
+	}
+
+	// scale * (4방향 라플라시안), 가장자리는 복제
+	void laplacian(const float* src, float* dst, int width, int height, float scale) {
+#pragma omp parallel for schedule(static)
+		for (int y = 0; y < height; y++) {
+			const float* above = src + static_cast<size_t>(std::max(y - 1, 0)) * width;
+			const float* center = src + static_cast<size_t>(y) * width;
+			const float* below = src + static_cast<size_t>(std::min(y + 1, height - 1)) * width;
+			float* out = dst + static_cast<size_t>(y) * width;
+			for (int x = 0; x < width; x++) {
+				const float left = center[std::max(x - 1, 0)];
+				const float right = center[std::min(x + 1, width - 1)];
+				out[x] = scale * (above[x] + below[x] + left + right - 4.0f * center[x]);
+			}
+		}
+	}
+}
+
+void NativeEngine::BuildScaleSpace(const unsigned char* gray, int width, int height, const ScaleSpaceOptions& options,
+	ScaleSpace& space, ScratchPool& scratch)
+{
+	space.gaussians.clear();
+	space.responses.clear();
+	if (gray == nullptr || width <= 0 || height <= 0) return;
+
+	const int scales = std::max(1, options.levelsPerOctave);
+	const int gaussianLevels = scales + 3;
+	const bool dog = options.response == ScaleSpaceResponse::DoG;
+	const int responseLevels = dog ? gaussianLevels - 1 : gaussianLevels;
+	const double k = pow(2.0, 1.0 / scales);
+
+	// 평면 배치를 먼저 정하고 arena는 한 번만 크기 조정
+	size_t total = 0;
+	int octaveWidth = width;
+	int octaveHeight = height;
+	for (int octave = 0; octave < options.octaves; octave++) {
+		if (octave > 0 && std::min(octaveWidth, octaveHeight) < options.minSize) break;
+
+		const size_t planeSize = static_cast<size_t>(octaveWidth) * octaveHeight;
+		const float octaveScale = static_cast<float>(1 << octave);
+		for (int level = 0; level < gaussianLevels; level++) {
+			const float sigma = static_cast<float>(options.baseSigma * pow(k, level)) * octaveScale;
+			space.gaussians.push_back({ octave, level, octaveWidth, octaveHeight, sigma, total });
+			total += planeSize;
+		}
+		for (int level = 0; level < responseLevels; level++) {
+			const float sigma = static_cast<float>(options.baseSigma * pow(k, level)) * octaveScale;
+			space.responses.push_back({ octave, level, octaveWidth, octaveHeight, sigma, total });
+			total += planeSize;
+		}
+		octaveWidth = (octaveWidth + 1) / 2;
+		octaveHeight = (octaveHeight + 1) / 2;
+	}
+	if (space.arena.size() < total) space.arena.resize(total);
+
+	const int octaves = static_cast<int>(space.gaussians.size()) / gaussianLevels;
+	for (int octave = 0; octave < octaves; octave++) {
+		const ScaleSpacePlane* levels = space.gaussians.data() + static_cast<size_t>(octave) * gaussianLevels;
+		const int w = levels[0].width;
+		const int h = levels[0].height;
+		const size_t planeSize = static_cast<size_t>(w) * h;
+
+		// 첫 장: 첫 옥타브는 입력 블러에서 baseSigma까지, 이후 옥타브는 앞 옥타브 s번째 장(2 * baseSigma)을 솎아 냄
+		float* base = space.Data(levels[0]);
+		if (octave == 0) {
+			ScratchBuffer<float> input(scratch, planeSize);
+			float* in = input.data();
+#pragma omp parallel for schedule(static)
+			for (long long i = 0; i < static_cast<long long>(planeSize); i++) in[i] = gray[i];
+			const float extra = options.baseSigma * options.baseSigma - options.inputSigma * options.inputSigma;
+			blurPlane(in, base, w, h, extra > 0.0f ? sqrt(extra) : 0.0f, scratch);
+		}
+		else {
+			const ScaleSpacePlane& source = space.gaussians[static_cast<size_t>(octave - 1) * gaussianLevels + scales];
+			decimate(space.Data(source), source.width, source.height, base);
+		}
+
+		// 나머지 장은 바로 앞 장에 늘어난 만큼만 더 블러 (옥타브 픽셀 단위)
+		for (int level = 1; level < gaussianLevels; level++) {
+			const double previous = options.baseSigma * pow(k, level - 1);
+			const float increment = static_cast<float>(previous * sqrt(k * k - 1.0));
+			blurPlane(space.Data(levels[level - 1]), space.Data(levels[level]), w, h, increment, scratch);
+		}
+
+		const ScaleSpacePlane* responses = space.responses.data() + static_cast<size_t>(octave) * responseLevels;
+		for (int level = 0; level < responseLevels; level++) {
+			float* out = space.Data(responses[level]);
+			if (dog) {
+				difference(space.Data(levels[level + 1]), space.Data(levels[level]), out, w, h);
+			}
+			else {
+				const float sigma = static_cast<float>(options.baseSigma * pow(k, level));
+				laplacian(space.Data(levels[level]), out, w, h, sigma * sigma);
+			}
+		}
+	}
+}
@@ -0,0 +1,47 @@
+﻿#pragma once
+
+#include <vector>
+#include "ScratchPool.h"
+
+namespace NativeEngine {
+	// 스케일 공간 응답 종류
+	enum class ScaleSpaceResponse {
+		DoG, // 이웃한 가우시안 차 G(k * sigma) - G(sigma)
+		LoG  // 정규화 라플라시안 sigma^2 * (3x3 4방향 라플라시안 of G(sigma))
+	};
+
+	struct ScaleSpaceOptions {
+		int octaves = 4;          // 최대 옥타브 수 (짧은 변이 minSize보다 작아지면 멈춤)
+		int levelsPerOctave = 3;  // 옥타브당 스케일 수 s, 가우시안은 s + 3장 (DoG s + 2장, LoG s + 3장)
+		float baseSigma = 1.6f;   // 각 옥타브 첫 장의 sigma (옥타브 픽셀 단위)
+		float inputSigma = 0.5f;  // 입력 이미지에 이미 있다고 보는 블러
+		int minSize = 8;
+		ScaleSpaceResponse response = ScaleSpaceResponse::DoG;
+	};
+
+	// 평면 하나 (width * height float), offset은 arena 안 위치
+	struct ScaleSpacePlane {
+		int octave = 0;
+		int level = 0;
+		int width = 0;
+		int height = 0;
+		float sigma = 0.0f; // 원본 픽셀 단위 sigma (DoG는 아래쪽 가우시안 기준)
+		size_t offset = 0;
+	};
+
+	// 가우시안/응답 평면을 한 덩어리 arena에 모아 둠 (다시 만들어도 arena가 충분하면 재할당 없음)
+	struct ScaleSpace {
+		std::vector<float> arena;
+		std::vector<ScaleSpacePlane> gaussians; // 옥타브 순, 옥타브 안에서 level 순
+		std::vector<ScaleSpacePlane> responses;
+
+		float* Data(const ScaleSpacePlane& plane) { return arena.data() + plane.offset; }
+		const float* Data(const ScaleSpacePlane& plane) const { return arena.data() + plane.offset; }
+	};
+
+	// gray(width * height 휘도)에서 가우시안 피라미드 + DoG/LoG를 한 번에
+	// 옥타브 안에서는 앞 장에 sqrt(sigma_i^2 - sigma_(i-1)^2)만 더 블러 (매번 원본에서 다시 블러하지 않음)
+	// 다음 옥타브 첫 장은 2 * baseSigma 장을 2배 솎아 내서 그대로 씀 (블러 없음)
+	void BuildScaleSpace(const unsigned char* gray, int width, int height, const ScaleSpaceOptions& options,
+		ScaleSpace& space, ScratchPool& scratch);
+}
@@ -0,0 +1,118 @@
+﻿#include <cstdlib>
+#include "ScratchPool.h"
+
+using namespace std;
+
+namespace {
+	const size_t minClassBytes = 4096;
+
+	void* alignedAlloc(size_t bytes) {
+#ifdef _WIN32
+		void* p = _aligned_malloc(bytes, NativeEngine::ScratchPool::alignment);
+#else
+		void* p = std::aligned_alloc(NativeEngine::ScratchPool::alignment, bytes);
+#endif
+		if (p == nullptr) throw std::bad_alloc();
+		return p;
+	}
+
+	void alignedFree(void* p) {
+#ifdef _WIN32
+		_aligned_free(p);
+#else
+		std::free(p);
+#endif
+	}
+}
+
+NativeEngine::ScratchPool::~ScratchPool() {
+	Trim();
+}
+
+// 2의 거듭제곱 구간을 4등분한 등급 (낭비 최대 25%)
+size_t NativeEngine::ScratchPool::sizeClass(size_t bytes, size_t& classBytes) {
+	if (bytes <= minClassBytes) {
+		classBytes = minClassBytes;
+		return 0;
+	}
+
+	int k = 0;
+	while ((static_cast<size_t>(1) << (k + 1)) < bytes) k++;
+	const size_t base = static_cast<size_t>(1) << k;
+	const size_t step = base / 4;
+	const size_t m = (bytes - base + step - 1) / step; // 1..4
+	classBytes = base + m * step;
+	return (k - 12) * 4 + m;
+}
+
+size_t NativeEngine::ScratchPool::classSize(size_t index) {
+	if (index == 0) return minClassBytes;
+	const size_t base = static_cast<size_t>(1) << ((index - 1) / 4 + 12);
+	return base + ((index - 1) % 4 + 1) * (base / 4);
+}
+
+void* NativeEngine::ScratchPool::Allocate(size_t bytes, size_t& capacity) {
+	const size_t index = sizeClass(bytes, capacity);
+
+	{
+		lock_guard<mutex> lock(_mutex);
+		if (index < _freeLists.size() && !_freeLists[index].empty()) {
+			void* block = _freeLists[index].back();
+			_freeLists[index].pop_back();
+			_inUse += capacity;
+			_highWater = max(_highWater, _inUse);
+			return block;
+		}
+	}
+
+	// 실제 할당은 잠금 밖에서
+	void* block = alignedAlloc(capacity);
+
+	lock_guard<mutex> lock(_mutex);
+	_inUse += capacity;
+	_highWater = max(_highWater, _inUse);
+	_reserved += capacity;
+	_heapAllocations++;
+	return block;
+}
+
+void NativeEngine::ScratchPool::Release(void* block, size_t capacity) {
+	size_t classBytes = 0;
+	const size_t index = sizeClass(capacity, classBytes);
+
+	lock_guard<mutex> lock(_mutex);
+	if (index >= _freeLists.size()) _freeLists.resize(index + 1);
+	_freeLists[index].push_back(block);
+	_inUse -= capacity;
+}
+
+void NativeEngine::ScratchPool::Trim() {
+	lock_guard<mutex> lock(_mutex);
+	for (size_t i = 0; i < _freeLists.size(); i++) {
+		for (void* block : _freeLists[i]) {
+			alignedFree(block);
+		}
+		_reserved -= classSize(i) * _freeLists[i].size();
+		_freeLists[i].clear();
+	}
+}
+
+size_t NativeEngine::ScratchPool::InUseBytes() {
+	lock_guard<mutex> lock(_mutex);
+	return _inUse;
+}
+
+size_t NativeEngine::ScratchPool::ReservedBytes() {
+	lock_guard<mutex> lock(_mutex);
+	return _reserved;
+}
+
+size_t NativeEngine::ScratchPool::HighWaterMark() {
+	lock_guard<mutex> lock(_mutex);
+	return _highWater;
+}
+
+size_t NativeEngine::ScratchPool::HeapAllocations() {
+	lock_guard<mutex> lock(_mutex);
+	return _heapAllocations;
+}
@@ -0,0 +1,91 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace NativeEngine {
+	// 엔진 임시 버퍼용 풀 (64바이트 정렬, 크기 등급별 재사용)
+	// 같은 크기 이미지를 반복 처리하면 두 번째부터는 힙 할당 없음
+	// 버퍼 내용은 초기화하지 않음 -> 필요한 부분만 직접 채울 것
+	class ScratchPool {
+	public:
+		static constexpr size_t alignment = 64;
+
+		ScratchPool() = default;
+		~ScratchPool();
+		ScratchPool(const ScratchPool&) = delete;
+		ScratchPool& operator=(const ScratchPool&) = delete;
+
+		// capacity: 실제 블록 크기 (Release 때 그대로 돌려줄 것)
+		void* Allocate(size_t bytes, size_t& capacity);
+		void Release(void* block, size_t capacity);
+
+		// 쉬고 있는 블록 전부 해제
+		void Trim();
+
+		size_t InUseBytes();
+		size_t ReservedBytes();
+		size_t HighWaterMark();     // 동시에 빌려간 바이트 최대치
+		size_t HeapAllocations();   // 실제 힙 할당 횟수 (누적)
+
+	private:
+		static size_t sizeClass(size_t bytes, size_t& classBytes);
+		static size_t classSize(size_t index);
+
+		std::mutex _mutex;
+		std::vector<std::vector<void*>> _freeLists;
+		size_t _inUse = 0;
+		size_t _reserved = 0;
+		size_t _highWater = 0;
+		size_t _heapAllocations = 0;
+	};
+
+	// 풀에서 빌린 T 배열, 소멸 시 자동 반납
+	template <typename T>
+	class ScratchBuffer {
+	public:
+		ScratchBuffer() = default;
+
+		ScratchBuffer(ScratchPool& pool, size_t count)
+			: _pool(&pool), _count(count) {
+			_data = static_cast<T*>(pool.Allocate(count * sizeof(T), _capacity));
+		}
+
+		~ScratchBuffer() {
+			if (_data != nullptr) _pool->Release(_data, _capacity);
+		}
+
+		ScratchBuffer(const ScratchBuffer&) = delete;
+		ScratchBuffer& operator=(const ScratchBuffer&) = delete;
+
+		ScratchBuffer(ScratchBuffer&& other) noexcept
+			: _pool(other._pool), _data(std::exchange(other._data, nullptr)),
+			_count(other._count), _capacity(other._capacity) {}
+
+		ScratchBuffer& operator=(ScratchBuffer&& other) noexcept {
+			if (this != &other) {
+				if (_data != nullptr) _pool->Release(_data, _capacity);
+				_pool = other._pool;
+				_data = std::exchange(other._data, nullptr);
+				_count = other._count;
+				_capacity = other._capacity;
+			}
+			return *this;
+		}
+
+		T* data() { return _data; }
+		const T* data() const { return _data; }
+		size_t size() const { return _count; }
+		T& operator[](size_t i) { return _data[i]; }
+		const T& operator[](size_t i) const { return _data[i]; }
+
+	private:
+		ScratchPool* _pool = nullptr;
+		T* _data = nullptr;
+		size_t _count = 0;
+		size_t _capacity = 0;
+	};
+}
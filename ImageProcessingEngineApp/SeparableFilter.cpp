@@ -0,0 +1,74 @@
+﻿#include "SeparableFilter.h"
+
+using namespace std;
+
+void NativeEngine::BoxFilterRows(const ImageView& src, const ImageView& dst, int radius) {
+	const int channels = 4;
+	const int width = src.width;
+	const int height = src.height;
+	const BoxDivider divide(radius * 2 + 1);
+
+#pragma omp parallel for schedule(static)
+	for (int y = 0; y < height; ++y) {
+		unsigned int sumB = 0, sumG = 0, sumR = 0;
+		const unsigned char* in = src.Row(y);
+		unsigned char* out = dst.Row(y);
+
+		// 첫 윈도우 합계
+		for (int i = -radius; i <= radius; ++i) {
+			const int idx = std::clamp(i, 0, width - 1) * channels;
+			sumB += in[idx];
+			sumG += in[idx + 1];
+			sumR += in[idx + 2];
+		}
+
+		for (int x = 0; x < width; ++x) {
+			const int out_idx = x * channels;
+			out[out_idx] = divide(sumB);
+			out[out_idx + 1] = divide(sumG);
+			out[out_idx + 2] = divide(sumR);
+			out[out_idx + 3] = in[out_idx + 3];
+
+			// 슬라이딩 윈도우 업데이트
+			const int old_idx = std::clamp(x - radius, 0, width - 1) * channels;
+			const int new_idx = std::clamp(x + radius + 1, 0, width - 1) * channels;
+			sumB += in[new_idx] - in[old_idx];
+			sumG += in[new_idx + 1] - in[old_idx + 1];
+			sumR += in[new_idx + 2] - in[old_idx + 2];
+		}
+	}
+}
+
+void NativeEngine::BoxFilterColumns(const ImageView& src, const ImageView& dst, int radius) {
+	const int channels = 4;
+	const int height = src.height;
+	const BoxDivider divide(radius * 2 + 1);
+
+	// 스레드마다 묶음이 몇 개씩은 돌아가도록 좁은 이미지에서는 묶음 폭을 줄임 (16픽셀 단위)
+	const int threadBlocks = omp_get_max_threads() * 4;
+	const int blockPixels = std::clamp((src.width / threadBlocks) & ~15, 16, boxColumnBlock);
+
+	ForEachColumnBlock(src.width, blockPixels, [&](int x0, int pixels) {
+		// 묶음 안 모든 열의 창 합 (채널별 레인), 행 하나씩 더하고 빼는 루프는 벡터화됨
+		const int lanes = pixels * channels;
+		unsigned int sums[boxColumnBlock * channels] = { 0 };
+
+		for (int i = -radius; i <= radius; ++i) {
+			const unsigned char* in = src.Pixel(x0, std::clamp(i, 0, height - 1));
+			for (int l = 0; l < lanes; l++) sums[l] += in[l];
+		}
+
+		for (int y = 0; y < height; ++y) {
+			unsigned char* out = dst.Pixel(x0, y);
+			for (int p = 0; p < pixels; p++) {
+				out[p * channels + 0] = divide(sums[p * channels + 0]);
+				out[p * channels + 1] = divide(sums[p * channels + 1]);
+				out[p * channels + 2] = divide(sums[p * channels + 2]);
+			}
+
+			const unsigned char* oldRow = src.Pixel(x0, std::clamp(y - radius, 0, height - 1));
+			const unsigned char* newRow = src.Pixel(x0, std::clamp(y + radius + 1, 0, height - 1));
+			for (int l = 0; l < lanes; l++) sums[l] += newRow[l] - oldRow[l];
+		}
+	});
+}
@@ -0,0 +1,44 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <omp.h>
+#include "ImageView.h"
+
+namespace NativeEngine {
+	// 박스 세로 패스 열 묶음 최대 폭 (픽셀), 256픽셀 = 행마다 1KB 연속 읽기
+	// 8K 폭에서 64픽셀 묶음은 행을 넘어갈 때마다 페이지가 바뀌는 비용이 커서 가로 패스의 2배 이상 걸림
+	constexpr int boxColumnBlock = 256;
+
+	// 분리 가능 필터의 세로 패스 공통 틀
+	// 열 하나를 stride 간격으로 내려가면 넓은 이미지에서 캐시/TLB 미스가 커서
+	// 이웃한 열 묶음 단위로 나눠 병렬 처리하고, 묶음 안에서는 위에서 아래로 행 순서로 훑음
+	// op(x0, pixels): 열 [x0, x0 + pixels) 묶음 하나 처리
+	template <typename BlockOp>
+	void ForEachColumnBlock(int width, int blockPixels, BlockOp&& op) {
+		const int blockCount = (width + blockPixels - 1) / blockPixels;
+#pragma omp parallel for schedule(static)
+		for (int b = 0; b < blockCount; b++) {
+			const int x0 = b * blockPixels;
+			op(x0, std::min(blockPixels, width - x0));
+		}
+	}
+
+	// 창 합 / 창 크기 (내림), 나눗셈 대신 곱셈 + 시프트
+	// 창 크기 65536 미만이면 정수 나눗셈과 같은 결과
+	struct BoxDivider {
+		unsigned long long mul;
+
+		explicit BoxDivider(int kernelSize)
+			: mul((1ull << 40) / static_cast<unsigned long long>(kernelSize) + 1) {}
+
+		unsigned char operator()(unsigned int sum) const {
+			return static_cast<unsigned char>((sum * mul) >> 40);
+		}
+	};
+
+	// 박스 필터 한 방향 (반경 radius, 가장자리 복제)
+	// src와 dst는 크기가 같고 서로 겹치지 않아야 함
+	// 가로 패스는 알파를 그대로 복사, 세로 패스는 dst 알파를 건드리지 않음
+	void BoxFilterRows(const ImageView& src, const ImageView& dst, int radius);
+	void BoxFilterColumns(const ImageView& src, const ImageView& dst, int radius);
+}
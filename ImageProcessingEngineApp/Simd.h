@@ -0,0 +1,72 @@
+﻿#pragma once
+
+// SIMD 공통 헤더
+// AVX2 커널은 별도 함수로 두고 실행 시 CPU 확인 후 호출 (/arch 옵션 없이도 빌드)
+// SSE2는 x64 기본이라 항상 사용
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define ENGINE_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+#if defined(ENGINE_X86) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define ENGINE_SSE2 1
+#endif
+
+// GCC/Clang은 함수 단위로 대상 ISA를 지정해야 intrinsic 사용 가능
+#if defined(ENGINE_X86) && (defined(__GNUC__) || defined(__clang__))
+#define ENGINE_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define ENGINE_TARGET_AVX2
+#endif
+
+// 벡터 값을 주고받는 작은 도우미는 반드시 인라인 (AVX2 함수 안에서 펼쳐져야 함)
+#ifdef _MSC_VER
+#define ENGINE_FORCEINLINE __forceinline
+#else
+#define ENGINE_FORCEINLINE inline __attribute__((always_inline))
+#endif
+
+namespace NativeEngine {
+	// AVX2 사용 가능 여부 (CPU + OS의 YMM 상태 저장 지원)
+	// ENGINE_NO_AVX2로 빌드하면 SSE2/스칼라 경로만 사용 (비교 테스트용)
+	inline bool CpuHasAvx2() {
+#if defined(ENGINE_X86) && !defined(ENGINE_NO_AVX2)
+		static const bool hasAvx2 = [] {
+			int regs[4] = { 0 };
+#ifdef _MSC_VER
+			__cpuid(regs, 1);
+#else
+			__cpuid(1, regs[0], regs[1], regs[2], regs[3]);
+#endif
+			const bool osxsave = (regs[2] & (1 << 27)) != 0;
+			const bool avx = (regs[2] & (1 << 28)) != 0;
+			if (!osxsave || !avx) return false;
+
+#ifdef _MSC_VER
+			const unsigned long long xcr0 = _xgetbv(0);
+#else
+			unsigned int eax = 0, edx = 0;
+			__asm__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+			const unsigned long long xcr0 = (static_cast<unsigned long long>(edx) << 32) | eax;
+#endif
+			if ((xcr0 & 0x6) != 0x6) return false;
+
+#ifdef _MSC_VER
+			__cpuidex(regs, 7, 0);
+#else
+			__cpuid_count(7, 0, regs[0], regs[1], regs[2], regs[3]);
+#endif
+			return (regs[1] & (1 << 5)) != 0;
+		}();
+		return hasAvx2;
+#else
+		return false;
+#endif
+	}
+}
@@ -0,0 +1,188 @@
+﻿#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include "SobelFilter.h"
+#include "GrayPlane.h"
+#include "Stencil.h"
+#include "StencilFilter.h"
+
+using namespace std;
+
+namespace {
+	using NativeEngine::GradientDirection;
+	using NativeEngine::GradientNorm;
+
+	// tan(22.5도) * 65536, ay <= (ax * tan22) >> 16 이면 가로 방향
+	constexpr int tan22Fixed = 27146;
+
+	// 자르지 않은 크기 (L2는 내림)
+	inline int magnitudeOf(int gx, int gy, GradientNorm norm) {
+		if (norm == GradientNorm::L1) return abs(gx) + abs(gy);
+		return static_cast<int>(sqrt(static_cast<double>(gx * gx + gy * gy)));
+	}
+
+	inline void storeMagnitude(unsigned char* p, int magnitude) { *p = static_cast<unsigned char>(std::min(magnitude, 255)); }
+	inline void storeMagnitude(short* p, int magnitude) { *p = static_cast<short>(magnitude); }
+
+	// gy는 위 - 아래 (화면 좌표와 부호 반대), 부호가 다르면 오른쪽 아래/왼쪽 위 방향
+	inline unsigned char directionOf(int gx, int gy) {
+		const int ax = abs(gx);
+		const int ay = abs(gy);
+		if (ay <= (ax * tan22Fixed) >> 16) return static_cast<unsigned char>(GradientDirection::Horizontal);
+		if (ax <= (ay * tan22Fixed) >> 16) return static_cast<unsigned char>(GradientDirection::Vertical);
+		return static_cast<unsigned char>((gx ^ gy) < 0 ? GradientDirection::DiagonalDown : GradientDirection::DiagonalUp);
+	}
+
+	template <typename T>
+	int sobelRowScalar(const unsigned char* a, const unsigned char* c, const unsigned char* b,
+		T* magnitude, unsigned char* direction, int x, int width, GradientNorm norm)
+	{
+		for (; x < width - 1; x++) {
+			const int gx = NativeEngine::StencilScalar<NativeEngine::SobelXKernel>(a, c, b, x);
+			const int gy = NativeEngine::StencilScalar<NativeEngine::SobelYKernel>(a, c, b, x);
+			storeMagnitude(magnitude + x, magnitudeOf(gx, gy, norm));
+			if (direction) direction[x] = directionOf(gx, gy);
+		}
+		return x;
+	}
+}
+
+#ifdef ENGINE_SSE2
+namespace {
+	using NativeEngine::StencilSse2;
+	using NativeEngine::StencilAvx2;
+
+	// 16비트 레인 하나에 픽셀 하나, |gx|, |gy| <= 1020이라 넘치지 않음
+	// 공통 연산은 Stencil.h 레인 구조체, 여기서는 방향 판정만 추가
+	// StoreDirection: directionOf와 같은 판정을 마스크로
+	struct Sse2Ops : StencilSse2 {
+		static void StoreDirection(unsigned char* p, const V& gx, const V& gy) {
+			V ax, ay;
+			Abs(ax, gx);
+			Abs(ay, gy);
+			const V tan22 = _mm_set1_epi16(static_cast<short>(tan22Fixed));
+			const V notHorizontal = _mm_cmpgt_epi16(ay, _mm_mulhi_epu16(ax, tan22));
+			const V notVertical = _mm_cmpgt_epi16(ax, _mm_mulhi_epu16(ay, tan22));
+			const V opposite = _mm_srai_epi16(_mm_xor_si128(gx, gy), 15);
+			V d = _mm_add_epi16(_mm_set1_epi16(3), _mm_add_epi16(opposite, opposite)); // DiagonalDown(1) / DiagonalUp(3)
+			d = _mm_or_si128(_mm_and_si128(notVertical, d), _mm_andnot_si128(notVertical, _mm_set1_epi16(2)));
+			Store(p, _mm_and_si128(notHorizontal, d));
+		}
+	};
+
+	struct Avx2Ops : StencilAvx2 {
+		static ENGINE_TARGET_AVX2 void StoreDirection(unsigned char* p, const V& gx, const V& gy) {
+			const __m256i ax = _mm256_abs_epi16(gx);
+			const __m256i ay = _mm256_abs_epi16(gy);
+			const __m256i tan22 = _mm256_set1_epi16(static_cast<short>(tan22Fixed));
+			const __m256i notHorizontal = _mm256_cmpgt_epi16(ay, _mm256_mulhi_epu16(ax, tan22));
+			const __m256i notVertical = _mm256_cmpgt_epi16(ax, _mm256_mulhi_epu16(ay, tan22));
+			const __m256i opposite = _mm256_srai_epi16(_mm256_xor_si256(gx, gy), 15);
+			__m256i d = _mm256_add_epi16(_mm256_set1_epi16(3), _mm256_add_epi16(opposite, opposite));
+			d = _mm256_blendv_epi8(_mm256_set1_epi16(2), d, notVertical);
+			const __m256i direction = _mm256_and_si256(notHorizontal, d);
+			Store(p, direction);
+		}
+	};
+
+	// 8비트는 255에서 포화, 16비트는 그대로 (L2는 sqrt 내림, 제곱합이 2^24 미만이라 double과 같은 결과)
+	template <class Ops, typename T>
+	ENGINE_FORCEINLINE void storeMagnitudeVector(T* p, const typename Ops::V& gx, const typename Ops::V& gy, GradientNorm norm) {
+		typename Ops::V m;
+		if (norm == GradientNorm::L1) {
+			typename Ops::V ax, ay;
+			Ops::Abs(ax, gx);
+			Ops::Abs(ay, gy);
+			Ops::Add(m, ax, ay);
+		}
+		else {
+			Ops::Magnitude(m, gx, gy);
+		}
+		Ops::Store(p, m);
+	}
+
+	// 가로 [x, width - 1) 안쪽 픽셀을 벡터 폭씩, 읽기는 x - 1 ~ x + pixels (행 끝을 넘지 않음)
+	template <class Ops, typename T>
+	ENGINE_FORCEINLINE int sobelRowVector(const unsigned char* a, const unsigned char* c, const unsigned char* b,
+		T* magnitude, unsigned char* direction, int x, int width, GradientNorm norm)
+	{
+		typename Ops::V gx, gy;
+		for (; x + Ops::pixels < width; x += Ops::pixels) {
+			NativeEngine::StencilVector<Ops, NativeEngine::SobelXKernel>(gx, a + x, c + x, b + x);
+			NativeEngine::StencilVector<Ops, NativeEngine::SobelYKernel>(gy, a + x, c + x, b + x);
+			storeMagnitudeVector<Ops>(magnitude + x, gx, gy, norm);
+			if (direction) Ops::StoreDirection(direction + x, gx, gy);
+		}
+		return x;
+	}
+
+	template <typename T>
+	int sobelRowSse2(const unsigned char* a, const unsigned char* c, const unsigned char* b,
+		T* magnitude, unsigned char* direction, int x, int width, GradientNorm norm)
+	{
+		return sobelRowVector<Sse2Ops>(a, c, b, magnitude, direction, x, width, norm);
+	}
+
+	template <typename T>
+	ENGINE_TARGET_AVX2 int sobelRowAvx2(const unsigned char* a, const unsigned char* c, const unsigned char* b,
+		T* magnitude, unsigned char* direction, int x, int width, GradientNorm norm)
+	{
+		return sobelRowVector<Avx2Ops>(a, c, b, magnitude, direction, x, width, norm);
+	}
+}
+#endif
+
+namespace {
+	// 안쪽 행 하나 (a: 위, c: 가운데, b: 아래 휘도 행)
+	template <typename T>
+	void sobelRow(const unsigned char* a, const unsigned char* c, const unsigned char* b,
+		T* magnitude, unsigned char* direction, int width, GradientNorm norm, bool avx2)
+	{
+		magnitude[0] = 0;
+		magnitude[width - 1] = 0;
+		if (direction) {
+			direction[0] = 0;
+			direction[width - 1] = 0;
+		}
+
+		int x = 1;
+#ifdef ENGINE_SSE2
+		if (avx2) x = sobelRowAvx2(a, c, b, magnitude, direction, x, width, norm);
+		x = sobelRowSse2(a, c, b, magnitude, direction, x, width, norm);
+#else
+		(void)avx2;
+#endif
+		sobelRowScalar(a, c, b, magnitude, direction, x, width, norm);
+	}
+}
+
+void NativeEngine::SobelFilter(const ImageView& image, const unsigned char* gray, unsigned char* magnitude,
+	unsigned char* direction, GradientNorm norm, ScratchPool& scratch)
+{
+	const int width = image.width;
+	const bool avx2 = CpuHasAvx2();
+
+	auto row = [&](int y, const unsigned char* above, const unsigned char* center,
+		const unsigned char* below, unsigned char* line)
+	{
+		unsigned char* out = magnitude ? magnitude + static_cast<size_t>(y) * width : line;
+		unsigned char* dir = direction ? direction + static_cast<size_t>(y) * width : nullptr;
+		if (above == nullptr || below == nullptr) {
+			memset(out, 0, width);
+			if (dir) memset(dir, 0, width);
+		}
+		else {
+			sobelRow(above, center, below, out, dir, width, norm, avx2);
+		}
+		WriteGrayRow(out, image.Row(y), width);
+	};
+	ForEachStencilRow(image, gray, std::ref(row), scratch);
+}
+
+void NativeEngine::SobelRow(const unsigned char* above, const unsigned char* center, const unsigned char* below,
+	short* magnitude, unsigned char* direction, int width, GradientNorm norm)
+{
+	sobelRow(above, center, below, magnitude, direction, width, norm, CpuHasAvx2());
+}
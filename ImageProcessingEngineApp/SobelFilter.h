@@ -0,0 +1,35 @@
+﻿#pragma once
+
+#include "ImageView.h"
+#include "ScratchPool.h"
+
+namespace NativeEngine {
+	// 그레이디언트 크기 계산 방식
+	enum class GradientNorm {
+		L2, // sqrt(gx^2 + gy^2) 내림 (기존 ApplySobel과 같은 값)
+		L1  // |gx| + |gy|, 제곱근 없음 (대각선 에지가 최대 1.41배 밝음)
+	};
+
+	// 4방향으로 양자화한 그레이디언트 방향 (방향 평면 값)
+	// 화면 좌표(x 오른쪽, y 아래쪽) 기준, 값은 비최대 억제에서 비교할 이웃 쌍
+	enum class GradientDirection : unsigned char {
+		Horizontal = 0,   // 0도 근처: 왼쪽 / 오른쪽
+		DiagonalDown = 1, // 45도: 왼쪽 위 / 오른쪽 아래
+		Vertical = 2,     // 90도: 위 / 아래
+		DiagonalUp = 3    // 135도: 오른쪽 위 / 왼쪽 아래
+	};
+
+	// 16비트 정수 3x3 소벨, 휘도 변환 + 두 방향 미분 + 크기 + 방향을 행 하나씩 한 번에
+	// AVX2 16픽셀 / SSE2 8픽셀씩 (AVX2는 실행 시 선택), 스레드마다 가로 띠 하나
+	// 휘도는 스레드별 3행 링 버퍼에만 있어 전체 크기 중간 버퍼 없음
+	// gray: 이미 있는 width * height 휘도 평면 (nullptr이면 image에서 행마다 변환)
+	// 크기는 image B/G/R에 씀 (알파 유지), magnitude/direction은 width * height 평면 (nullptr 가능)
+	// magnitude는 gray와 같은 버퍼여도 됨, 가장자리 1픽셀은 크기 0 / 방향 Horizontal
+	void SobelFilter(const ImageView& image, const unsigned char* gray, unsigned char* magnitude,
+		unsigned char* direction, GradientNorm norm, ScratchPool& scratch);
+
+	// 안쪽 한 행 (width >= 3, 양 끝 픽셀은 0), 크기를 255에서 자르지 않음 (L2 최대 1442, L1 최대 2040)
+	// Canny처럼 다른 필터 안에서 행 단위로 이어 쓰는 용도
+	void SobelRow(const unsigned char* above, const unsigned char* center, const unsigned char* below,
+		short* magnitude, unsigned char* direction, int width, GradientNorm norm);
+}
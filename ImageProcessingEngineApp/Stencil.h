@@ -0,0 +1,136 @@
+﻿#pragma once
+
+#include <cmath>
+#include "Simd.h"
+
+// 3x3 스텐실 공통 (계수가 템플릿 인자라 연산자마다 펼쳐진 코드로 컴파일)
+// 0 계수는 읽지 않고, +-1은 덧셈/뺄셈, 2의 거듭제곱은 시프트, 나머지만 곱셈
+// 결과는 16비트 레인 하나에 픽셀 하나 (계수 절댓값 합 * 255가 32767 이하여야 함)
+namespace NativeEngine {
+	// 행 우선 계수 (k00 k01 k02 / k10 k11 k12 / k20 k21 k22), 위 행이 k0x
+	template <int k00, int k01, int k02, int k10, int k11, int k12, int k20, int k21, int k22>
+	struct StencilKernel {
+		static constexpr int c00 = k00, c01 = k01, c02 = k02;
+		static constexpr int c10 = k10, c11 = k11, c12 = k12;
+		static constexpr int c20 = k20, c21 = k21, c22 = k22;
+	};
+
+	// 미분 커널은 x 오른쪽이 +, y는 위 - 아래 (기존 Sobel과 같은 부호)
+	using SobelXKernel = StencilKernel<-1, 0, 1, -2, 0, 2, -1, 0, 1>;
+	using SobelYKernel = StencilKernel<1, 2, 1, 0, 0, 0, -1, -2, -1>;
+	using ScharrXKernel = StencilKernel<-3, 0, 3, -10, 0, 10, -3, 0, 3>;
+	using ScharrYKernel = StencilKernel<3, 10, 3, 0, 0, 0, -3, -10, -3>;
+	using PrewittXKernel = StencilKernel<-1, 0, 1, -1, 0, 1, -1, 0, 1>;
+	using PrewittYKernel = StencilKernel<1, 1, 1, 0, 0, 0, -1, -1, -1>;
+	using Laplacian4Kernel = StencilKernel<0, 1, 0, 1, -4, 1, 0, 1, 0>;
+	using Laplacian8Kernel = StencilKernel<1, 1, 1, 1, -8, 1, 1, 1, 1>;
+	using EmbossKernel = StencilKernel<-2, -1, 0, -1, 1, 1, 0, 1, 2>;
+
+	// a: 위, c: 가운데, b: 아래 행, x는 1 ~ width - 2
+	template <class K>
+	inline int StencilScalar(const unsigned char* a, const unsigned char* c, const unsigned char* b, int x) {
+		return K::c00 * a[x - 1] + K::c01 * a[x] + K::c02 * a[x + 1]
+			+ K::c10 * c[x - 1] + K::c11 * c[x] + K::c12 * c[x + 1]
+			+ K::c20 * b[x - 1] + K::c21 * b[x] + K::c22 * b[x + 1];
+	}
+
+	// 그레이디언트 크기 내림, 벡터 경로와 같은 float 제곱근 (제곱합이 2^24 이상이면 double과 1 차이 날 수 있음)
+	inline int StencilMagnitude(int gx, int gy) {
+		return static_cast<int>(std::sqrt(static_cast<float>(gx * gx + gy * gy)));
+	}
+
+#ifdef ENGINE_SSE2
+	// 벡터는 참조로 주고받음 (AVX2 값 반환을 피하고, 행 함수를 강제 인라인해 AVX2 함수 안에서 펼침)
+	struct StencilSse2 {
+		using V = __m128i;
+		static constexpr int pixels = 8;
+
+		static void Load(V& v, const unsigned char* p) {
+			v = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)), _mm_setzero_si128());
+		}
+		static void Set(V& v, int value) { v = _mm_set1_epi16(static_cast<short>(value)); }
+		static void Add(V& r, const V& a, const V& b) { r = _mm_add_epi16(a, b); }
+		static void Sub(V& r, const V& a, const V& b) { r = _mm_sub_epi16(a, b); }
+		template <int shift>
+		static void ShiftLeft(V& r, const V& a) { r = _mm_slli_epi16(a, shift); }
+		static void Multiply(V& r, const V& a, int c) { r = _mm_mullo_epi16(a, _mm_set1_epi16(static_cast<short>(c))); }
+		static void Abs(V& r, const V& a) { r = _mm_max_epi16(a, _mm_sub_epi16(_mm_setzero_si128(), a)); }
+
+		// (gx, gy) 쌍을 madd로 제곱합 -> float 제곱근 -> 내림, 32767에서 포화
+		static void Magnitude(V& r, const V& gx, const V& gy) {
+			const __m128i lo = _mm_unpacklo_epi16(gx, gy);
+			const __m128i hi = _mm_unpackhi_epi16(gx, gy);
+			const __m128i rootLo = _mm_cvttps_epi32(_mm_sqrt_ps(_mm_cvtepi32_ps(_mm_madd_epi16(lo, lo))));
+			const __m128i rootHi = _mm_cvttps_epi32(_mm_sqrt_ps(_mm_cvtepi32_ps(_mm_madd_epi16(hi, hi))));
+			r = _mm_packs_epi32(rootLo, rootHi);
+		}
+
+		// 8비트는 0~255 포화, 16비트는 그대로
+		static void Store(unsigned char* p, const V& v) { _mm_storel_epi64(reinterpret_cast<__m128i*>(p), _mm_packus_epi16(v, v)); }
+		static void Store(short* p, const V& v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+	};
+
+	struct StencilAvx2 {
+		using V = __m256i;
+		static constexpr int pixels = 16;
+
+		static ENGINE_TARGET_AVX2 void Load(V& v, const unsigned char* p) {
+			v = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+		}
+		static ENGINE_TARGET_AVX2 void Set(V& v, int value) { v = _mm256_set1_epi16(static_cast<short>(value)); }
+		static ENGINE_TARGET_AVX2 void Add(V& r, const V& a, const V& b) { r = _mm256_add_epi16(a, b); }
+		static ENGINE_TARGET_AVX2 void Sub(V& r, const V& a, const V& b) { r = _mm256_sub_epi16(a, b); }
+		template <int shift>
+		static ENGINE_TARGET_AVX2 void ShiftLeft(V& r, const V& a) { r = _mm256_slli_epi16(a, shift); }
+		static ENGINE_TARGET_AVX2 void Multiply(V& r, const V& a, int c) { r = _mm256_mullo_epi16(a, _mm256_set1_epi16(static_cast<short>(c))); }
+		static ENGINE_TARGET_AVX2 void Abs(V& r, const V& a) { r = _mm256_abs_epi16(a); }
+
+		// unpack과 packs가 모두 레인 단위라 순서가 그대로 돌아옴
+		static ENGINE_TARGET_AVX2 void Magnitude(V& r, const V& gx, const V& gy) {
+			const __m256i lo = _mm256_unpacklo_epi16(gx, gy);
+			const __m256i hi = _mm256_unpackhi_epi16(gx, gy);
+			const __m256i rootLo = _mm256_cvttps_epi32(_mm256_sqrt_ps(_mm256_cvtepi32_ps(_mm256_madd_epi16(lo, lo))));
+			const __m256i rootHi = _mm256_cvttps_epi32(_mm256_sqrt_ps(_mm256_cvtepi32_ps(_mm256_madd_epi16(hi, hi))));
+			r = _mm256_packs_epi32(rootLo, rootHi);
+		}
+
+		// pack이 128비트 레인 단위라 앞쪽 8바이트 두 개를 모음
+		static ENGINE_TARGET_AVX2 void Store(unsigned char* p, const V& v) {
+			const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(v, v), 0x08);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm256_castsi256_si128(packed));
+		}
+		static ENGINE_TARGET_AVX2 void Store(short* p, const V& v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+	};
+
+	// 계수 하나를 누적 (0이면 읽지도 않음)
+	template <class Lanes, int c>
+	ENGINE_FORCEINLINE void StencilTap(typename Lanes::V& acc, const unsigned char* p) {
+		if constexpr (c != 0) {
+			constexpr int magnitude = c < 0 ? -c : c;
+			typename Lanes::V v;
+			Lanes::Load(v, p);
+			if constexpr ((magnitude & (magnitude - 1)) == 0) {
+				if constexpr (magnitude > 1) {
+					constexpr int shift = magnitude == 2 ? 1 : magnitude == 4 ? 2 : magnitude == 8 ? 3 : 4;
+					static_assert((1 << shift) == magnitude, "stencil coefficient out of range");
+					Lanes::template ShiftLeft<shift>(v, v);
+				}
+			}
+			else {
+				Lanes::Multiply(v, v, magnitude);
+			}
+			if constexpr (c > 0) Lanes::Add(acc, acc, v);
+			else Lanes::Sub(acc, acc, v);
+		}
+	}
+
+	// 픽셀 x ~ x + Lanes::pixels - 1 응답, 읽기는 x - 1 ~ x + Lanes::pixels (a, c, b는 이미 x만큼 민 포인터)
+	template <class Lanes, class K>
+	ENGINE_FORCEINLINE void StencilVector(typename Lanes::V& out, const unsigned char* a, const unsigned char* c, const unsigned char* b) {
+		Lanes::Set(out, 0);
+		StencilTap<Lanes, K::c00>(out, a - 1); StencilTap<Lanes, K::c01>(out, a); StencilTap<Lanes, K::c02>(out, a + 1);
+		StencilTap<Lanes, K::c10>(out, c - 1); StencilTap<Lanes, K::c11>(out, c); StencilTap<Lanes, K::c12>(out, c + 1);
+		StencilTap<Lanes, K::c20>(out, b - 1); StencilTap<Lanes, K::c21>(out, b); StencilTap<Lanes, K::c22>(out, b + 1);
+	}
+#endif
+}
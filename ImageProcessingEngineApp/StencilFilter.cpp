@@ -0,0 +1,232 @@
+﻿#include <omp.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include "StencilFilter.h"
+#include "Stencil.h"
+#include "GrayPlane.h"
+
+using namespace std;
+
+namespace {
+	using namespace NativeEngine;
+
+	// 연산자별 응답 (Scalar: 픽셀 하나, Vector: Lanes::pixels개), border는 가장자리 값
+	template <class K>
+	struct AbsoluteResponse {
+		static constexpr int border = 0;
+		static int Scalar(const unsigned char* a, const unsigned char* c, const unsigned char* b, int x) {
+			return abs(StencilScalar<K>(a, c, b, x));
+		}
+#ifdef ENGINE_SSE2
+		template <class Lanes>
+		static ENGINE_FORCEINLINE void Vector(typename Lanes::V& out, const unsigned char* a, const unsigned char* c, const unsigned char* b) {
+			StencilVector<Lanes, K>(out, a, c, b);
+			Lanes::Abs(out, out);
+		}
+#endif
+	};
+
+	template <class KX, class KY>
+	struct GradientResponse {
+		static constexpr int border = 0;
+		static int Scalar(const unsigned char* a, const unsigned char* c, const unsigned char* b, int x) {
+			return StencilMagnitude(StencilScalar<KX>(a, c, b, x), StencilScalar<KY>(a, c, b, x));
+		}
+#ifdef ENGINE_SSE2
+		template <class Lanes>
+		static ENGINE_FORCEINLINE void Vector(typename Lanes::V& out, const unsigned char* a, const unsigned char* c, const unsigned char* b) {
+			typename Lanes::V gx, gy;
+			StencilVector<Lanes, KX>(gx, a, c, b);
+			StencilVector<Lanes, KY>(gy, a, c, b);
+			Lanes::Magnitude(out, gx, gy);
+		}
+#endif
+	};
+
+	template <class K, int bias>
+	struct BiasedResponse {
+		static constexpr int border = bias;
+		static int Scalar(const unsigned char* a, const unsigned char* c, const unsigned char* b, int x) {
+			return StencilScalar<K>(a, c, b, x) + bias;
+		}
+#ifdef ENGINE_SSE2
+		template <class Lanes>
+		static ENGINE_FORCEINLINE void Vector(typename Lanes::V& out, const unsigned char* a, const unsigned char* c, const unsigned char* b) {
+			typename Lanes::V offset;
+			StencilVector<Lanes, K>(out, a, c, b);
+			Lanes::Set(offset, bias);
+			Lanes::Add(out, out, offset);
+		}
+#endif
+	};
+
+	inline void storeResponse(unsigned char* p, int value) { *p = static_cast<unsigned char>(std::clamp(value, 0, 255)); }
+	inline void storeResponse(short* p, int value) { *p = static_cast<short>(value); }
+
+	// 한 행 최댓값 (SSE2 8개씩)
+	short rowMaximum(const short* row, int width) {
+		int x = 0;
+		short result = std::numeric_limits<short>::min();
+#ifdef ENGINE_SSE2
+		if (width >= 8) {
+			__m128i best = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row));
+			for (x = 8; x + 8 <= width; x += 8) best = _mm_max_epi16(best, _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x)));
+			best = _mm_max_epi16(best, _mm_srli_si128(best, 8));
+			best = _mm_max_epi16(best, _mm_srli_si128(best, 4));
+			best = _mm_max_epi16(best, _mm_srli_si128(best, 2));
+			result = static_cast<short>(_mm_cvtsi128_si32(best));
+		}
+#endif
+		for (; x < width; x++) result = std::max(result, row[x]);
+		return result;
+	}
+
+	template <class Response, typename T>
+	int stencilRowScalar(const unsigned char* a, const unsigned char* c, const unsigned char* b, T* out, int x, int width) {
+		for (; x < width - 1; x++) storeResponse(out + x, Response::Scalar(a, c, b, x));
+		return x;
+	}
+}
+
+#ifdef ENGINE_SSE2
+namespace {
+	// 가로 [x, width - 1) 안쪽 픽셀을 벡터 폭씩, 읽기는 x - 1 ~ x + pixels (행 끝을 넘지 않음)
+	template <class Lanes, class Response, typename T>
+	ENGINE_FORCEINLINE int stencilRowVector(const unsigned char* a, const unsigned char* c, const unsigned char* b, T* out, int x, int width) {
+		typename Lanes::V v;
+		for (; x + Lanes::pixels < width; x += Lanes::pixels) {
+			Response::template Vector<Lanes>(v, a + x, c + x, b + x);
+			Lanes::Store(out + x, v);
+		}
+		return x;
+	}
+
+	template <class Response, typename T>
+	int stencilRowSse2(const unsigned char* a, const unsigned char* c, const unsigned char* b, T* out, int x, int width) {
+		return stencilRowVector<StencilSse2, Response>(a, c, b, out, x, width);
+	}
+
+	template <class Response, typename T>
+	ENGINE_TARGET_AVX2 int stencilRowAvx2(const unsigned char* a, const unsigned char* c, const unsigned char* b, T* out, int x, int width) {
+		return stencilRowVector<StencilAvx2, Response>(a, c, b, out, x, width);
+	}
+}
+#endif
+
+namespace {
+	// 한 행, 첫 행/마지막 행과 양 끝 픽셀은 border
+	template <class Response, typename T>
+	void stencilRow(const unsigned char* a, const unsigned char* c, const unsigned char* b, T* out, int width, bool avx2) {
+		if (a == nullptr || b == nullptr) {
+			std::fill(out, out + width, static_cast<T>(Response::border));
+			return;
+		}
+		out[0] = static_cast<T>(Response::border);
+		out[width - 1] = static_cast<T>(Response::border);
+
+		int x = 1;
+#ifdef ENGINE_SSE2
+		if (avx2) x = stencilRowAvx2<Response>(a, c, b, out, x, width);
+		x = stencilRowSse2<Response>(a, c, b, out, x, width);
+#else
+		(void)avx2;
+#endif
+		stencilRowScalar<Response>(a, c, b, out, x, width);
+	}
+
+	// 연산자 -> 컴파일 시점 커널 조합
+	template <typename T>
+	void stencilRowFor(StencilOperator op, const unsigned char* a, const unsigned char* c, const unsigned char* b,
+		T* out, int width, bool avx2)
+	{
+		switch (op) {
+		case StencilOperator::Laplacian4: stencilRow<AbsoluteResponse<Laplacian4Kernel>>(a, c, b, out, width, avx2); break;
+		case StencilOperator::Laplacian8: stencilRow<AbsoluteResponse<Laplacian8Kernel>>(a, c, b, out, width, avx2); break;
+		case StencilOperator::Sobel: stencilRow<GradientResponse<SobelXKernel, SobelYKernel>>(a, c, b, out, width, avx2); break;
+		case StencilOperator::Scharr: stencilRow<GradientResponse<ScharrXKernel, ScharrYKernel>>(a, c, b, out, width, avx2); break;
+		case StencilOperator::Prewitt: stencilRow<GradientResponse<PrewittXKernel, PrewittYKernel>>(a, c, b, out, width, avx2); break;
+		case StencilOperator::Emboss: stencilRow<BiasedResponse<EmbossKernel, 128>>(a, c, b, out, width, avx2); break;
+		}
+	}
+}
+
+void NativeEngine::ForEachStencilRow(const ImageView& image, const unsigned char* gray, const StencilRowFunction& row, ScratchPool& scratch) {
+	const int width = image.width;
+	const int height = image.height;
+
+	auto fetch = [&](int y, unsigned char* dst) {
+		if (gray) memcpy(dst, gray + static_cast<size_t>(y) * width, width);
+		else ConvertRowToGray(image.Row(y), dst, width, image.layout);
+	};
+
+#pragma omp parallel
+	{
+		// 스레드마다 연속된 행 띠 하나
+		const int threads = omp_get_num_threads();
+		const int strip = (height + threads - 1) / threads;
+		const int y0 = std::min(height, omp_get_thread_num() * strip);
+		const int y1 = std::min(height, y0 + strip);
+
+		// 휘도 링 3행 + 아래 띠 첫 행 + 작업 행 (2행 크기)
+		ScratchBuffer<unsigned char> lines(scratch, static_cast<size_t>(width) * 6);
+		unsigned char* ring = lines.data();
+		unsigned char* nextStrip = ring + static_cast<size_t>(width) * 3;
+		unsigned char* line = ring + static_cast<size_t>(width) * 4;
+		auto ringLine = [&](int y) { return ring + static_cast<size_t>((y + 3) % 3) * width; };
+
+		// 경계 행은 이웃 띠가 결과로 덮어쓰기 전에 읽어 둠
+		if (y0 < y1) {
+			if (y0 > 0) fetch(y0 - 1, ringLine(y0 - 1));
+			fetch(y0, ringLine(y0));
+			if (y1 < height) fetch(y1, nextStrip);
+		}
+#pragma omp barrier
+
+		for (int y = y0; y < y1; y++) {
+			const unsigned char* below = nullptr;
+			if (y + 1 < y1) {
+				fetch(y + 1, ringLine(y + 1));
+				below = ringLine(y + 1);
+			}
+			else if (y + 1 < height) {
+				below = nextStrip;
+			}
+			row(y, y > 0 ? ringLine(y - 1) : nullptr, ringLine(y), below, line);
+		}
+	}
+}
+
+void NativeEngine::StencilFilter(const ImageView& image, const unsigned char* gray, unsigned char* result,
+	StencilOperator op, ScratchPool& scratch)
+{
+	const int width = image.width;
+	const bool avx2 = CpuHasAvx2();
+
+	auto row = [&](int y, const unsigned char* above, const unsigned char* center,
+		const unsigned char* below, unsigned char* line)
+	{
+		unsigned char* out = result ? result + static_cast<size_t>(y) * width : line;
+		stencilRowFor(op, above, center, below, out, width, avx2);
+		WriteGrayRow(out, image.Row(y), width);
+	};
+	ForEachStencilRow(image, gray, std::ref(row), scratch);
+}
+
+void NativeEngine::StencilResponse(const ImageView& image, const unsigned char* gray, short* response,
+	StencilOperator op, ScratchPool& scratch, short* rowMax)
+{
+	const int width = image.width;
+	const bool avx2 = CpuHasAvx2();
+
+	auto row = [&](int y, const unsigned char* above, const unsigned char* center,
+		const unsigned char* below, unsigned char*)
+	{
+		short* out = response + static_cast<size_t>(y) * width;
+		stencilRowFor(op, above, center, below, out, width, avx2);
+		if (rowMax) rowMax[y] = rowMaximum(out, width);
+	};
+	ForEachStencilRow(image, gray, std::ref(row), scratch);
+}
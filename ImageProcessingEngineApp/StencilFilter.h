@@ -0,0 +1,51 @@
+﻿#pragma once
+
+#include <functional>
+#include "ImageView.h"
+#include "ScratchPool.h"
+
+namespace NativeEngine {
+	// 3x3 스텐실 연산자 (계수는 Stencil.h)
+	enum class StencilOperator {
+		Laplacian4, // |4방향 라플라시안|
+		Laplacian8, // |8방향 라플라시안|
+		Sobel,      // 그레이디언트 크기 (sqrt 내림)
+		Scharr,     // 그레이디언트 크기, 회전 대칭이 더 좋은 계수
+		Prewitt,    // 그레이디언트 크기, 균일 가중
+		Emboss      // 응답 + 128 (평탄한 곳이 회색)
+	};
+
+	// 라플라시안 결과 밝기 조절
+	enum class LaplacianScale {
+		Normalized, // 전체 최댓값이 255 (응답 평면 + 행별 최댓값, 두 번 훑음)
+		Fixed       // |응답|을 0~255에서 자름 (전체 최댓값이 필요 없어 한 번에, 중간 평면 없음)
+	};
+
+	// |라플라시안| 응답 상한 (8방향, 8 * 255), 정규화 표 크기
+	constexpr int laplacianMaxResponse = 8 * 255;
+
+	// 휘도 3행 이웃을 받는 행 콜백
+	// y: 가운데 행, above/below: 위/아래 휘도 행 (첫 행/마지막 행이면 nullptr), center: y 행
+	// line: 스레드별 width * 2 바이트 작업 행
+	using StencilRowFunction = std::function<void(int y, const unsigned char* above, const unsigned char* center,
+		const unsigned char* below, unsigned char* line)>;
+
+	// 스레드마다 가로 띠 하나를 맡아 휘도 3행 링 버퍼를 돌리며 모든 행에 row 호출 (위에서 아래 순서)
+	// gray: 이미 있는 width * height 휘도 평면 (nullptr이면 image에서 행마다 변환)
+	// 띠 경계 행은 시작 전에 읽어 두고, 각 행은 다음 행을 읽은 뒤 호출하므로
+	// row가 image나 gray의 y 행을 제자리로 덮어써도 됨
+	// 참조 캡처가 많은 람다는 std::function 안에 안 들어가 힙에 잡히므로 std::ref로 넘김
+	void ForEachStencilRow(const ImageView& image, const unsigned char* gray, const StencilRowFunction& row, ScratchPool& scratch);
+
+	// 8비트 결과 (응답을 0~255에서 자름), image B/G/R에 씀 (알파 유지)
+	// result: width * height 평면 (nullptr 가능, gray와 같은 버퍼여도 됨)
+	// 가장자리 1픽셀은 0 (Emboss는 128)
+	void StencilFilter(const ImageView& image, const unsigned char* gray, unsigned char* result,
+		StencilOperator op, ScratchPool& scratch);
+
+	// 자르지 않은 16비트 응답 평면 (width * height), image는 그대로
+	// 최댓값 정규화처럼 전체 응답이 필요한 경우용
+	// rowMax: height개, 행마다 응답 최댓값 (행이 캐시에 있을 때 같이 계산, nullptr이면 생략)
+	void StencilResponse(const ImageView& image, const unsigned char* gray, short* response,
+		StencilOperator op, ScratchPool& scratch, short* rowMax = nullptr);
+}
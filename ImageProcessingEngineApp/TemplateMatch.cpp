@@ -0,0 +1,352 @@
+﻿#include <omp.h>
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include "TemplateMatch.h"
+#include "IntegralImage.h"
+#include "Simd.h"
+
+using namespace std;
+
+namespace {
+	using namespace NativeEngine;
+
+	// SAD 계산 위치 하나
+	struct MatchCandidate {
+		long long sad;
+		int idx; // y * 검색 폭 + x
+
+		bool operator<(const MatchCandidate& other) const {
+			return sad < other.sad || (sad == other.sad && idx < other.idx);
+		}
+	};
+
+	// 풀에서 빌린 후보 배열 (용량은 처음 정한 만큼, 크기만 바뀜)
+	class CandidateList {
+	public:
+		CandidateList() = default;
+		CandidateList(ScratchPool& pool, size_t capacity) : _buffer(pool, capacity) {}
+
+		MatchCandidate* begin() { return _buffer.data(); }
+		MatchCandidate* end() { return _buffer.data() + _size; }
+		size_t size() const { return _size; }
+		MatchCandidate& operator[](size_t i) { return _buffer[i]; }
+		MatchCandidate& front() { return _buffer[0]; }
+		MatchCandidate& back() { return _buffer[_size - 1]; }
+		void push_back(const MatchCandidate& candidate) { _buffer[_size++] = candidate; }
+		void pop_back() { _size--; }
+		void resize(size_t size) { _size = size; } // 줄이기만
+
+	private:
+		ScratchBuffer<MatchCandidate> _buffer;
+		size_t _size = 0;
+	};
+
+	// 최대 힙에 넣되 limit개를 넘으면 가장 나쁜 것을 뺌 (용량은 limit + 1)
+	inline void pushBounded(CandidateList& heap, const MatchCandidate& candidate, size_t limit) {
+		if (heap.size() == limit && !(candidate < heap.front())) return;
+		heap.push_back(candidate);
+		std::push_heap(heap.begin(), heap.end());
+		if (heap.size() > limit) {
+			std::pop_heap(heap.begin(), heap.end());
+			heap.pop_back();
+		}
+	}
+
+	// 한 행 SAD (SSE2 16바이트씩 psadbw)
+	inline unsigned rowSad(const unsigned char* a, const unsigned char* b, int count) {
+		int x = 0;
+		unsigned sum = 0;
+#ifdef ENGINE_SSE2
+		__m128i acc = _mm_setzero_si128();
+		for (; x + 16 <= count; x += 16) {
+			const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + x));
+			const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + x));
+			acc = _mm_add_epi64(acc, _mm_sad_epu8(va, vb));
+		}
+		sum = static_cast<unsigned>(_mm_cvtsi128_si32(acc)) + static_cast<unsigned>(_mm_cvtsi128_si32(_mm_srli_si128(acc, 8)));
+#endif
+		for (; x < count; x++) {
+			const int diff = static_cast<int>(a[x]) - static_cast<int>(b[x]);
+			sum += (diff < 0) ? -diff : diff;
+		}
+		return sum;
+	}
+
+	// (x, y) 창 SAD, 행마다 limit 이상이면 중단 (그 위치는 더 볼 필요 없음)
+	long long windowSad(const unsigned char* image, int width, int x, int y,
+		const unsigned char* templ, int templateWidth, int templateHeight, long long limit)
+	{
+		long long sad = 0;
+		const unsigned char* row = image + static_cast<size_t>(y) * width + x;
+		for (int ty = 0; ty < templateHeight && sad < limit; ty++) {
+			sad += rowSad(row, templ + static_cast<size_t>(ty) * templateWidth, templateWidth);
+			row += width;
+		}
+		return sad;
+	}
+
+	// 2x2 평균으로 절반 (홀수 끝 행/열은 버림)
+	void halve(const unsigned char* src, int width, int height, unsigned char* dst) {
+		const int dstWidth = width / 2;
+		const int dstHeight = height / 2;
+#pragma omp parallel for schedule(static)
+		for (int y = 0; y < dstHeight; y++) {
+			const unsigned char* top = src + static_cast<size_t>(y) * 2 * width;
+			const unsigned char* bottom = top + width;
+			unsigned char* out = dst + static_cast<size_t>(y) * dstWidth;
+			for (int x = 0; x < dstWidth; x++) {
+				out[x] = static_cast<unsigned char>((top[2 * x] + top[2 * x + 1] + bottom[2 * x] + bottom[2 * x + 1] + 2) >> 2);
+			}
+		}
+	}
+
+	// 전수 탐색하되 (SAD, 위치) 작은 순 limit개만 (스레드별 최대 힙, 힙이 차면 limit번째 값이 가지치기 기준)
+	// SAD >= |창 합 - 템플릿 합|이라 적분 영상으로 창 합만 보고 기준보다 못한 위치는 건너뜀, SAD도 기준을 넘으면 중단
+	// stats: SAD를 계산한 위치 수와 계산량을 더함
+	CandidateList bestPositions(const unsigned char* image, int width, int height,
+		const unsigned char* templ, int templateWidth, int templateHeight, int limit, ScratchPool& scratch, TemplateMatchStats& stats)
+	{
+		IntegralImage integral(scratch);
+		integral.Build(image, width, height);
+		long long templateSum = 0;
+		for (size_t i = 0; i < static_cast<size_t>(templateWidth) * templateHeight; i++) templateSum += templ[i];
+
+		const int searchWidth = width - templateWidth + 1;
+		const int totalSearchPoints = searchWidth * (height - templateHeight + 1);
+		const size_t heapSize = static_cast<size_t>(limit);
+		CandidateList result(scratch, heapSize + 1); // 스레드별 힙을 합칠 때도 limit개만
+		long long count = 0;
+
+#pragma omp parallel reduction(+:count)
+		{
+			CandidateList heap(scratch, heapSize + 1);
+
+#pragma omp for schedule(static) nowait
+			for (int idx = 0; idx < totalSearchPoints; idx++) {
+				const int y = idx / searchWidth;
+				const int x = idx % searchWidth;
+
+				// 같은 SAD는 앞쪽 위치가 이기므로 기준과 같은 값까지는 끝까지 계산
+				long long limitSad = LLONG_MAX;
+				if (heap.size() == heapSize) {
+					const long long worst = heap.front().sad;
+					const long long windowSum = static_cast<long long>(integral.Sum(x, y, x + templateWidth, y + templateHeight));
+					const long long gap = windowSum - templateSum;
+					if ((gap < 0 ? -gap : gap) > worst) continue;
+					limitSad = worst + 1;
+				}
+
+				count++;
+				pushBounded(heap, { windowSad(image, width, x, y, templ, templateWidth, templateHeight, limitSad), idx }, heapSize);
+			}
+
+#pragma omp critical
+			for (const MatchCandidate& candidate : heap) pushBounded(result, candidate, heapSize);
+		}
+		std::sort_heap(result.begin(), result.end());
+		stats.positions += count;
+		stats.pixels += count * templateWidth * templateHeight;
+		return result;
+	}
+
+	// 주어진 위치들만 SAD 계산 후 정렬
+	void measurePositions(const unsigned char* image, int width, const unsigned char* templ, int templateWidth, int templateHeight,
+		int searchWidth, CandidateList& positions)
+	{
+		const int positionCount = static_cast<int>(positions.size());
+#pragma omp parallel for schedule(dynamic, 16)
+		for (int i = 0; i < positionCount; i++) {
+			const int idx = positions[i].idx;
+			positions[i].sad = windowSad(image, width, idx % searchWidth, idx / searchWidth,
+				templ, templateWidth, templateHeight, LLONG_MAX);
+		}
+		std::sort(positions.begin(), positions.end());
+	}
+
+	// 후보를 더 남기는 SAD 범위: 최선 + 25% + tolerance (반복 무늬나 밋밋한 영역에서는 그 단계 순위를 믿을 수 없음)
+	inline long long tieBand(long long best, long long tolerance) {
+		return best + best / 4 + tolerance;
+	}
+
+	// 정렬된 위치에서 서로 radius 안에 있으면 앞쪽 하나만 남김
+	// count개까지는 순서대로, 그 뒤로는 tieBand 안에 드는 것만 wide개까지 (남긴 위치 주변은 표시해 두고 건너뜀)
+	void keepCandidates(CandidateList& positions, int searchWidth, int searchHeight,
+		int count, int wide, int radius, long long tolerance, ScratchPool& scratch)
+	{
+		if (positions.size() == 0) return;
+		const long long band = tieBand(positions.front().sad, tolerance);
+		ScratchBuffer<unsigned char> taken(scratch, static_cast<size_t>(searchWidth) * searchHeight);
+		std::fill_n(taken.data(), taken.size(), static_cast<unsigned char>(0));
+
+		size_t kept = 0;
+		for (size_t i = 0; i < positions.size(); i++) {
+			const MatchCandidate candidate = positions[i];
+			if (static_cast<int>(kept) >= wide || (static_cast<int>(kept) >= count && candidate.sad > band)) break;
+			if (taken[candidate.idx]) continue;
+			const int x = candidate.idx % searchWidth;
+			const int y = candidate.idx / searchWidth;
+			for (int ny = std::max(0, y - radius); ny <= std::min(searchHeight - 1, y + radius); ny++) {
+				const int nx = std::max(0, x - radius);
+				std::fill_n(&taken[static_cast<size_t>(ny) * searchWidth + nx], std::min(searchWidth - 1, x + radius) - nx + 1, static_cast<unsigned char>(1));
+			}
+			positions[kept++] = candidate;
+		}
+		positions.resize(kept);
+	}
+
+	// 단계 크기 (0은 원본)
+	struct PyramidLevel {
+		const unsigned char* image;
+		const unsigned char* templ;
+		int width;
+		int height;
+		int templateWidth;
+		int templateHeight;
+
+		int SearchWidth() const { return width - templateWidth + 1; }
+		int SearchHeight() const { return height - templateHeight + 1; }
+	};
+
+	// 줄인 단계의 맞는 위치는 2x2 묶음이 어긋나 있을 수 있음 (원본 좌표가 홀수)
+	// 바로 아래 단계 템플릿을 한 픽셀 밀어 줄인 것과 이 단계 템플릿의 SAD (세 방향 중 최대, 템플릿 전체 넓이로 환산)
+	long long phaseTolerance(const PyramidLevel& fine, const PyramidLevel& coarse) {
+		long long worst = 0;
+		for (int shift = 1; shift <= 3; shift++) {
+			const int sx = shift & 1, sy = shift >> 1;
+			const int w = (fine.templateWidth - sx) / 2, h = (fine.templateHeight - sy) / 2;
+			if (w <= 0 || h <= 0) continue;
+			long long sad = 0;
+			for (int y = 0; y < h; y++) {
+				const unsigned char* top = fine.templ + static_cast<size_t>(2 * y + sy) * fine.templateWidth + sx;
+				const unsigned char* bottom = top + fine.templateWidth;
+				const unsigned char* row = coarse.templ + static_cast<size_t>(y) * coarse.templateWidth;
+				for (int x = 0; x < w; x++) {
+					const int shifted = (top[2 * x] + top[2 * x + 1] + bottom[2 * x] + bottom[2 * x + 1] + 2) >> 2;
+					sad += abs(shifted - row[x]);
+				}
+			}
+			worst = std::max(worst, sad * coarse.templateWidth * coarse.templateHeight / (static_cast<long long>(w) * h));
+		}
+		return worst;
+	}
+
+	MatchCandidate pyramidMatch(const unsigned char* image, int width, int height,
+		const unsigned char* templ, int templateWidth, int templateHeight,
+		const TemplateMatchOptions& options, int levelCount, ScratchPool& scratch, TemplateMatchStats& stats)
+	{
+		PyramidLevel levels[templatePyramidMaxLevels + 1];
+		ScratchBuffer<unsigned char> planes[2 * templatePyramidMaxLevels]; // 단계마다 영상, 템플릿
+		levels[0] = { image, templ, width, height, templateWidth, templateHeight };
+		for (int level = 1; level <= levelCount; level++) {
+			const PyramidLevel& previous = levels[level - 1];
+			PyramidLevel& next = levels[level];
+			next = { nullptr, nullptr, previous.width / 2, previous.height / 2, previous.templateWidth / 2, previous.templateHeight / 2 };
+			ScratchBuffer<unsigned char>& imagePlane = planes[2 * (level - 1)];
+			ScratchBuffer<unsigned char>& templatePlane = planes[2 * (level - 1) + 1];
+			imagePlane = ScratchBuffer<unsigned char>(scratch, static_cast<size_t>(next.width) * next.height);
+			halve(previous.image, previous.width, previous.height, imagePlane.data());
+			next.image = imagePlane.data();
+			templatePlane = ScratchBuffer<unsigned char>(scratch, static_cast<size_t>(next.templateWidth) * next.templateHeight);
+			halve(previous.templ, previous.templateWidth, previous.templateHeight, templatePlane.data());
+			next.templ = templatePlane.data();
+		}
+
+		const int count = std::max(1, options.candidates);
+		const int radius = std::max(1, options.refineRadius);
+		const int tieShare = std::max(1, options.tieShare);
+		// 후보가 거의 같을 때 남길 수: 다음 단계 계산량 (위치 수 * 템플릿 픽셀 수)이 원본 전수 탐색의 1 / tieShare를 넘지 않게
+		// 템플릿 픽셀이 단계마다 1/4이므로 줄인 단계일수록 후보를 4배씩 더 남길 수 있음
+		const int window = (2 * radius + 2) * (2 * radius + 2);
+		const long long fullPositions = static_cast<long long>(levels[0].SearchWidth()) * levels[0].SearchHeight();
+		auto wideCount = [&](int fineLevel) {
+			const long long positions = (fullPositions << (2 * fineLevel)) / (static_cast<long long>(tieShare) * window);
+			return static_cast<int>(std::max<long long>(count, positions));
+		};
+
+		// 맨 위 단계는 전수, 후보 하나 주변이 다 채워도 count개가 남도록 (2 * radius + 1)^2배까지 모아서 고름
+		// 모은 것이 모두 tieBand 안이면 더 있을 수 있으므로 wide개 기준으로 다시 모음
+		const PyramidLevel& top = levels[levelCount];
+		const int side = 2 * radius + 1;
+		const long long topTolerance = phaseTolerance(levels[levelCount - 1], top);
+		const int wide = wideCount(levelCount - 1);
+		CandidateList candidates = bestPositions(top.image, top.width, top.height,
+			top.templ, top.templateWidth, top.templateHeight, count * side * side, scratch, stats);
+		if (wide > count && static_cast<int>(candidates.size()) == count * side * side
+			&& candidates.back().sad <= tieBand(candidates.front().sad, topTolerance))
+		{
+			candidates = bestPositions(top.image, top.width, top.height,
+				top.templ, top.templateWidth, top.templateHeight, wide * side * side, scratch, stats);
+		}
+		keepCandidates(candidates, top.SearchWidth(), top.SearchHeight(), count, wide, radius, topTolerance, scratch);
+
+		// 한 단계씩 내려가며 후보 * 2 주변만 (겹치는 위치는 한 번만)
+		for (int level = levelCount - 1; level >= 0; level--) {
+			const PyramidLevel& coarse = levels[level + 1];
+			const PyramidLevel& fine = levels[level];
+			const int searchWidth = fine.SearchWidth();
+			const int searchHeight = fine.SearchHeight();
+
+			CandidateList positions(scratch, candidates.size() * window);
+			ScratchBuffer<unsigned char> seen(scratch, static_cast<size_t>(searchWidth) * searchHeight);
+			std::fill_n(seen.data(), seen.size(), static_cast<unsigned char>(0));
+			for (const MatchCandidate& candidate : candidates) {
+				const int cx = candidate.idx % coarse.SearchWidth() * 2;
+				const int cy = candidate.idx / coarse.SearchWidth() * 2;
+				const int x0 = std::max(0, cx - radius);
+				const int x1 = std::min(searchWidth - 1, cx + 1 + radius);
+				const int y0 = std::max(0, cy - radius);
+				const int y1 = std::min(searchHeight - 1, cy + 1 + radius);
+				for (int y = y0; y <= y1; y++) {
+					for (int x = x0; x <= x1; x++) {
+						const int idx = y * searchWidth + x;
+						if (seen[idx]) continue;
+						seen[idx] = 1;
+						positions.push_back({ 0, idx });
+					}
+				}
+			}
+
+			measurePositions(fine.image, fine.width, fine.templ, fine.templateWidth, fine.templateHeight, searchWidth, positions);
+			stats.positions += static_cast<long long>(positions.size());
+			stats.pixels += static_cast<long long>(positions.size()) * fine.templateWidth * fine.templateHeight;
+			if (level == 0) {
+				positions.resize(1);
+			} else {
+				keepCandidates(positions, searchWidth, searchHeight, count, wideCount(level - 1), radius,
+					phaseTolerance(levels[level - 1], fine), scratch);
+			}
+			candidates = std::move(positions);
+		}
+		return candidates.front();
+	}
+}
+
+void NativeEngine::MatchTemplate(const unsigned char* image, int width, int height,
+	const unsigned char* templ, int templateWidth, int templateHeight,
+	const TemplateMatchOptions& options, int* matchX, int* matchY, ScratchPool& scratch, TemplateMatchStats* stats)
+{
+	*matchX = -1;
+	*matchY = -1;
+	if (image == nullptr || templ == nullptr || templateWidth <= 0 || templateHeight <= 0) return;
+	if (templateWidth > width || templateHeight > height) return;
+
+	int levelCount = 0;
+	if (options.mode == TemplateMatchMode::Pyramid) {
+		const int minSide = std::min(templateWidth, templateHeight);
+		const int minSize = std::max(1, options.minTemplateSize);
+		const int maxLevels = options.levels > 0 ? std::min(options.levels, templatePyramidMaxLevels) : templatePyramidMaxLevels;
+		while (levelCount < maxLevels && (minSide >> (levelCount + 1)) >= minSize) levelCount++;
+	}
+
+	TemplateMatchStats work;
+	work.levels = levelCount;
+	const MatchCandidate best = levelCount > 0
+		? pyramidMatch(image, width, height, templ, templateWidth, templateHeight, options, levelCount, scratch, work)
+		: bestPositions(image, width, height, templ, templateWidth, templateHeight, 1, scratch, work).front();
+	if (stats != nullptr) *stats = work;
+
+	const int searchWidth = width - templateWidth + 1;
+	*matchX = best.idx % searchWidth;
+	*matchY = best.idx / searchWidth;
+}
@@ -0,0 +1,38 @@
+﻿#pragma once
+
+#include "ScratchPool.h"
+
+namespace NativeEngine {
+	enum class TemplateMatchMode {
+		Exhaustive, // 모든 위치 SAD (창 합 하한으로 가망 없는 위치는 건너뜀)
+		Pyramid     // 2배씩 줄인 단계에서 후보를 고르고 다음 단계에서는 후보 주변만 다시 탐색
+	};
+
+	struct TemplateMatchOptions {
+		TemplateMatchMode mode = TemplateMatchMode::Exhaustive;
+		int levels = 0;           // 줄인 단계 수 상한 (0이면 templatePyramidMaxLevels), 템플릿 짧은 변이 minTemplateSize보다 작아지는 단계는 만들지 않음
+		int minTemplateSize = 16; // 가장 작은 단계 템플릿 짧은 변 (너무 작으면 구별력이 없어 엉뚱한 후보만 남음)
+		int candidates = 8;       // 단계마다 남기는 후보 수 (서로 refineRadius 안에 있는 후보는 하나만)
+		int refineRadius = 2;     // 다음 단계에서 후보 좌표 * 2 주변 +-반경 (솎아 낸 홀수 좌표 포함)
+		int tieShare = 8;         // 후보가 거의 같으면 (반복 무늬) 더 남기되, 단계마다 계산량은 원본 전수 탐색의 1 / tieShare까지
+	};
+
+	struct TemplateMatchStats {
+		int levels = 0;          // 실제로 만든 줄인 단계 수 (0이면 전수 탐색)
+		long long positions = 0; // SAD를 계산한 위치 수, 모든 단계 합 (창 합 하한으로 건너뛴 위치는 빼고)
+		long long pixels = 0;    // 그 위치들의 템플릿 픽셀 수 합 (행 단위 조기 중단 전의 계산량 상한)
+	};
+
+	constexpr int templatePyramidMaxLevels = 6;
+
+	// 휘도 평면끼리 SAD가 가장 작은 템플릿 왼쪽 위 좌표 (같은 값이면 래스터 순서 앞쪽), 못 찾으면 -1
+	// Pyramid: 맨 위 단계만 전수 탐색, 단계가 내려갈 때마다 후보 수 * (2 * refineRadius + 2)^2 위치만 계산
+	// 템플릿이 작아 줄일 단계가 없으면 Exhaustive와 같음
+	// 최선 + 25% + 2x2 묶음 어긋남 허용치 안에 드는 후보는 그 단계에서 더 남김 (전체 다시 탐색은 하지 않으므로 일이 늘어도 단계마다 전수 탐색의 1 / tieShare까지)
+	// 후보에서 빠진 위치는 다시 보지 않으므로 Exhaustive와 결과가 다를 수 있음
+	// stats: nullptr이 아니면 탐색량을 채움
+	void MatchTemplate(const unsigned char* image, int width, int height,
+		const unsigned char* templ, int templateWidth, int templateHeight,
+		const TemplateMatchOptions& options, int* matchX, int* matchY, ScratchPool& scratch,
+		TemplateMatchStats* stats = nullptr);
+}
@@ -0,0 +1,1651 @@
+﻿#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+#include <new>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include "ImageProcessingEngineApp.h"
+#include "GaussianFilter.h"
+#include "GrayPlane.h"
+#include "IntegralImage.h"
+
+// 엔진 결과를 단순한 참조 구현과 비교하는 회귀 테스트
+// usage: ImageProcessingTests [이름 일부], 실패가 하나라도 있으면 종료 코드 1
+
+using NativeEngine::ImageProcessingEngine;
+using NativeEngine::TemplateMatchMode;
+using NativeEngine::TemplateMatchOptions;
+
+// 전역 new 횟수 (같은 영상을 다시 처리할 때 힙 할당이 없는지 확인)
+static std::atomic<size_t> heapNewCount{ 0 };
+
+void* operator new(size_t size) {
+	heapNewCount++;
+	if (void* p = std::malloc(size == 0 ? 1 : size)) return p;
+	throw std::bad_alloc();
+}
+
+// GCC는 교체한 new와 free 짝을 모르고 경고함
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+namespace {
+	struct TestCase {
+		const char* name;
+		std::function<std::string()> run; // 통과면 빈 문자열, 실패면 이유
+	};
+
+	std::string format(const char* fmt, double a, double b = 0.0, double c = 0.0) {
+		char buffer[256];
+		std::snprintf(buffer, sizeof(buffer), fmt, a, b, c);
+		return buffer;
+	}
+
+	// 0~255 무작위 BGRA (알파 255)
+	std::vector<unsigned char> randomImage(int width, int height, unsigned seed) {
+		std::mt19937 rng(seed);
+		std::vector<unsigned char> pixels(static_cast<size_t>(width) * height * 4);
+		for (size_t i = 0; i < pixels.size(); i++) pixels[i] = i % 4 == 3 ? 255 : static_cast<unsigned char>(rng() % 256);
+		return pixels;
+	}
+
+	// 행 끝에 padding 바이트를 둔 버퍼에서 op 실행 (stride != width * 4 경로), 결과는 빽빽하게 result로
+	// 여유 바이트를 건드리면 실패
+	std::string runStrided(const std::vector<unsigned char>& source, int width, int height, int padding,
+		const std::function<void(const NativeEngine::ImageView&)>& op, std::vector<unsigned char>& result)
+	{
+		const int rowBytes = width * 4;
+		const int stride = rowBytes + padding;
+		std::vector<unsigned char> buffer(static_cast<size_t>(stride) * height, 77);
+		for (int y = 0; y < height; y++) std::copy_n(&source[static_cast<size_t>(y) * rowBytes], rowBytes, &buffer[static_cast<size_t>(y) * stride]);
+		op(NativeEngine::ImageView(buffer.data(), width, height, stride));
+
+		result.resize(source.size());
+		for (int y = 0; y < height; y++) {
+			const unsigned char* row = &buffer[static_cast<size_t>(y) * stride];
+			std::copy_n(row, rowBytes, &result[static_cast<size_t>(y) * rowBytes]);
+			for (int i = rowBytes; i < stride; i++) {
+				if (row[i] != 77) return format("row %.0f padding byte %.0f overwritten", y, i - rowBytes);
+			}
+		}
+		return {};
+	}
+
+	// 처음 다른 바이트 위치 (같으면 a.size())
+	size_t firstDifference(const std::vector<unsigned char>& a, const std::vector<unsigned char>& b) {
+		size_t i = 0;
+		while (i < a.size() && a[i] == b[i]) i++;
+		return i;
+	}
+
+	// generation을 준 뷰로 체인을 돌리면 (휘도 평면 재사용) 포인터 API로 돌린 것과 결과가 같아야 함
+	// 중간에 엔진 밖에서 버퍼를 고치고 generation을 바꾸면 캐시를 버려야 함
+	std::string grayPlaneCache() {
+		const int width = 131, height = 97;
+		const std::vector<unsigned char> source = randomImage(width, height, 3);
+		using Step = std::function<void(ImageProcessingEngine&, const NativeEngine::ImageView&)>;
+		const std::vector<std::pair<const char*, Step>> steps = {
+			{ "sobel", [](ImageProcessingEngine& e, const NativeEngine::ImageView& v) { e.ApplySobel(v); } },
+			{ "binarize", [](ImageProcessingEngine& e, const NativeEngine::ImageView& v) { e.ApplyBinarization(v); } },
+			{ "laplacian", [](ImageProcessingEngine& e, const NativeEngine::ImageView& v) { e.ApplyLaplacian(v); } },
+			{ "outside write", [](ImageProcessingEngine&, const NativeEngine::ImageView& v) {
+				for (int y = 0; y < v.height; y += 3) std::fill_n(v.Row(y), v.width * 4, static_cast<unsigned char>(200));
+			} },
+			{ "multi otsu", [](ImageProcessingEngine& e, const NativeEngine::ImageView& v) { e.ApplyMultiOtsu(v, 3); } },
+			{ "canny", [](ImageProcessingEngine& e, const NativeEngine::ImageView& v) { e.ApplyCanny(v, 1.4f, 50, 150); } },
+			{ "stencil", [](ImageProcessingEngine& e, const NativeEngine::ImageView& v) { e.ApplyStencil(v, NativeEngine::StencilOperator::Scharr); } },
+		};
+
+		std::vector<unsigned char> cached = source, plain = source;
+		ImageProcessingEngine cachedEngine, plainEngine;
+		NativeEngine::ImageView view(cached.data(), width, height);
+		view.generation = 1;
+		for (const auto& step : steps) {
+			step.second(cachedEngine, view);
+			step.second(plainEngine, NativeEngine::ImageView(plain.data(), width, height));
+			if (std::string(step.first) == "outside write") view.generation++;
+			if (cached != plain) return std::string("after ") + step.first + ": cached chain differs";
+		}
+		return "";
+	}
+
+	// 한 채널 가우시안 참조 (double, +-4 sigma 탭, 가장자리 복제)
+	std::vector<double> referenceGaussian(const std::vector<unsigned char>& pixels, int width, int height, int channel, double sigma) {
+		const int radius = static_cast<int>(std::ceil(4.0 * sigma));
+		std::vector<double> taps(static_cast<size_t>(radius) * 2 + 1);
+		double sum = 0.0;
+		for (int i = -radius; i <= radius; i++) sum += taps[i + radius] = std::exp(-0.5 * i * i / (sigma * sigma));
+		for (double& t : taps) t /= sum;
+
+		std::vector<double> rows(static_cast<size_t>(width) * height);
+		std::vector<double> result(rows.size());
+		for (int y = 0; y < height; y++) {
+			for (int x = 0; x < width; x++) {
+				double acc = 0.0;
+				for (int i = -radius; i <= radius; i++) {
+					acc += taps[i + radius] * pixels[(static_cast<size_t>(y) * width + std::clamp(x + i, 0, width - 1)) * 4 + channel];
+				}
+				rows[static_cast<size_t>(y) * width + x] = acc;
+			}
+		}
+		for (int y = 0; y < height; y++) {
+			for (int x = 0; x < width; x++) {
+				double acc = 0.0;
+				for (int i = -radius; i <= radius; i++) acc += taps[i + radius] * rows[static_cast<size_t>(std::clamp(y + i, 0, height - 1)) * width + x];
+				result[static_cast<size_t>(y) * width + x] = acc;
+			}
+		}
+		return result;
+	}
+
+	// 재귀 필터(sigma 2 이상)도 가장자리가 안쪽과 같은 오차 수준이어야 함 (역방향 시작값)
+	std::string gaussianEdges() {
+		const int width = 157, height = 123;
+		const std::vector<unsigned char> source = randomImage(width, height, 7);
+		for (float sigma : { 1.5f, 2.0f, 3.3f, 6.0f, 12.0f }) {
+			std::vector<unsigned char> pixels = source;
+			ImageProcessingEngine engine;
+			engine.ApplyGaussianBlur(pixels.data(), width, height, sigma);
+
+			double worst = 0.0;
+			for (int c = 0; c < 3; c++) {
+				const std::vector<double> reference = referenceGaussian(source, width, height, c, sigma);
+				for (size_t i = 0; i < reference.size(); i++) worst = std::max(worst, std::abs(pixels[i * 4 + c] - reference[i]));
+			}
+			// 재귀 근사 오차는 1단계 남짓 (반올림 포함)
+			if (worst > 2.0) return format("sigma %.1f: max error %.2f", sigma, worst);
+		}
+		return {};
+	}
+
+	// 재귀 필터(sigma 2 이상)의 실제 폭: float 임펄스 응답의 표준편차가 sigma의 1% 안 (큰 sigma는 float 계수 반올림으로 0.5%쯤 벌어짐)
+	// 8비트 계단 가장자리는 정확한 가우시안과 1.5단계 안
+	std::string gaussianSigma() {
+		NativeEngine::ScratchPool scratch;
+		for (float sigma : { 2.0f, 2.5f, 3.3f, 5.0f, 8.0f, 12.0f, 20.0f, 40.0f }) {
+			const NativeEngine::GaussianKernel kernel = NativeEngine::ComputeGaussianKernel(sigma, scratch);
+			const int width = static_cast<int>(30.0f * sigma) + 64;
+			std::vector<float> impulse(width, 0.0f), response(width);
+			impulse[width / 2] = 1.0f;
+			NativeEngine::GaussianPlane(impulse.data(), response.data(), width, 1, kernel, scratch);
+			double m0 = 0.0, m1 = 0.0, m2 = 0.0;
+			for (int x = 0; x < width; x++) {
+				m0 += response[x];
+				m1 += response[x] * x;
+				m2 += response[x] * static_cast<double>(x) * x;
+			}
+			const double effective = std::sqrt(m2 / m0 - (m1 / m0) * (m1 / m0));
+			if (std::abs(m0 - 1.0) > 1e-4) return format("sigma %.1f: impulse sum %.6f", sigma, m0);
+			if (std::abs(effective / sigma - 1.0) > 0.01) return format("sigma %.1f: effective sigma %.4f", sigma, effective);
+
+			std::vector<unsigned char> step(static_cast<size_t>(width) * 4);
+			for (int x = 0; x < width; x++) {
+				for (int c = 0; c < 4; c++) step[x * 4 + c] = c == 3 || x >= width / 2 ? 255 : 0;
+			}
+			const std::vector<unsigned char> source = step;
+			ImageProcessingEngine engine;
+			engine.ApplyGaussianBlur(step.data(), width, 1, sigma);
+			const std::vector<double> reference = referenceGaussian(source, width, 1, 0, sigma);
+			for (int x = 0; x < width; x++) {
+				if (std::abs(step[x * 4] - reference[x]) > 1.5) return format("sigma %.1f: step x %.0f off by %.2f", sigma, x, step[x * 4] - reference[x]);
+			}
+		}
+		return {};
+	}
+
+	// 한 행 밝은 블록을 왼쪽 끝/오른쪽 끝에 두면 결과도 좌우 대칭
+	std::string gaussianEdgeSymmetry() {
+		const int width = 64;
+		for (float sigma : { 1.5f, 2.0f, 6.0f, 12.0f }) {
+			std::vector<unsigned char> left(width * 4, 0), right(width * 4, 0);
+			for (int x = 0; x < 10; x++) {
+				for (int c = 0; c < 3; c++) {
+					left[x * 4 + c] = 255;
+					right[(width - 1 - x) * 4 + c] = 255;
+				}
+			}
+			ImageProcessingEngine engine;
+			engine.ApplyGaussianBlur(left.data(), width, 1, sigma);
+			engine.ApplyGaussianBlur(right.data(), width, 1, sigma);
+			for (int x = 0; x < width; x++) {
+				const int diff = std::abs(left[x * 4] - right[(width - 1 - x) * 4]);
+				if (diff > 1) return format("sigma %.1f: x %.0f differs by %.0f", sigma, x, diff);
+			}
+		}
+		return {};
+	}
+
+	// 정수 박스 블러 = 기존 가로 -> 세로 두 번 (가장자리 복제, 창 합 / (2r + 1) 내림, 알파 유지)
+	// 반경 0, 반경 >= 폭/높이, 열 묶음(256픽셀) 배수가 아닌 폭
+	std::string boxBlurMatchesReference() {
+		const int cases[][3] = { { 300, 41, 0 }, { 300, 41, 3 }, { 531, 17, 12 }, { 37, 29, 40 }, { 256, 5, 7 }, { 1, 9, 2 } };
+		for (const auto& c : cases) {
+			const int width = c[0], height = c[1], radius = c[2];
+			const int kernelSize = radius * 2 + 1;
+			const std::vector<unsigned char> source = randomImage(width, height, 59 + radius);
+
+			std::vector<unsigned char> rows = source, expected = source;
+			for (int y = 0; y < height; y++) {
+				for (int x = 0; x < width; x++) {
+					for (int ch = 0; ch < 3; ch++) {
+						int sum = 0;
+						for (int i = -radius; i <= radius; i++) sum += source[(static_cast<size_t>(y) * width + std::clamp(x + i, 0, width - 1)) * 4 + ch];
+						rows[(static_cast<size_t>(y) * width + x) * 4 + ch] = static_cast<unsigned char>(sum / kernelSize);
+					}
+				}
+			}
+			for (int y = 0; y < height; y++) {
+				for (int x = 0; x < width; x++) {
+					for (int ch = 0; ch < 3; ch++) {
+						int sum = 0;
+						for (int i = -radius; i <= radius; i++) sum += rows[(static_cast<size_t>(std::clamp(y + i, 0, height - 1)) * width + x) * 4 + ch];
+						expected[(static_cast<size_t>(y) * width + x) * 4 + ch] = static_cast<unsigned char>(sum / kernelSize);
+					}
+				}
+			}
+
+			ImageProcessingEngine engine;
+			std::vector<unsigned char> result;
+			const std::string error = runStrided(source, width, height, 20, [&](const NativeEngine::ImageView& view) {
+				engine.ApplyGaussianBlur(view, radius);
+			}, result);
+			const std::string where = format("%.0fx%.0f radius %.0f: ", width, height, radius);
+			if (!error.empty()) return where + error;
+			const size_t i = firstDifference(result, expected);
+			if (i < result.size()) return where + format("pixel %.0f channel %.0f", static_cast<double>(i / 4), static_cast<double>(i % 4));
+		}
+		return {};
+	}
+
+	// 채널별 (2r + 1)^2 창 정렬 후 가운데 값, 가장자리 복제, 알파 유지
+	std::vector<unsigned char> referenceMedian(const std::vector<unsigned char>& pixels, int width, int height, int kernelSize) {
+		const int radius = kernelSize / 2;
+		const int rank = kernelSize * kernelSize / 2;
+		std::vector<unsigned char> result(pixels.size());
+		std::vector<unsigned char> window;
+		for (int y = 0; y < height; y++) {
+			for (int x = 0; x < width; x++) {
+				const size_t at = (static_cast<size_t>(y) * width + x) * 4;
+				for (int c = 0; c < 3; c++) {
+					window.clear();
+					for (int ky = -radius; ky <= radius; ky++) {
+						for (int kx = -radius; kx <= radius; kx++) {
+							window.push_back(pixels[(static_cast<size_t>(std::clamp(y + ky, 0, height - 1)) * width + std::clamp(x + kx, 0, width - 1)) * 4 + c]);
+						}
+					}
+					std::nth_element(window.begin(), window.begin() + rank, window.end());
+					result[at + c] = window[rank];
+				}
+				result[at + 3] = pixels[at + 3];
+			}
+		}
+		return result;
+	}
+
+	// 3x3, 5x5는 정렬 네트워크, 7 이상은 상수 시간 히스토그램: 둘 다 참조 중앙값과 같아야 함
+	// 커널이 영상보다 큰 경우 (4 x 3)와 행 끝 여유가 있는 버퍼 포함
+	std::string medianMatchesReference() {
+		const int sizes[][2] = { { 67, 53 }, { 4, 3 } };
+		for (const auto& size : sizes) {
+			const int width = size[0], height = size[1];
+			std::vector<unsigned char> source = randomImage(width, height, 13);
+			for (size_t i = 3; i < source.size(); i += 4) source[i] = static_cast<unsigned char>(i * 7);
+			for (int kernelSize : { 3, 5, 7, 15 }) {
+				const std::vector<unsigned char> expected = referenceMedian(source, width, height, kernelSize);
+				for (int padding : { 0, 20 }) {
+					ImageProcessingEngine engine;
+					std::vector<unsigned char> result;
+					const std::string error = runStrided(source, width, height, padding,
+						[&](const NativeEngine::ImageView& view) { engine.ApplyMedian(view, kernelSize); }, result);
+					if (!error.empty()) return format("%.0fx%.0f kernel %.0f: ", width, height, kernelSize) + error;
+					const size_t i = firstDifference(result, expected);
+					if (i < result.size()) {
+						return format("%.0fx%.0f kernel %.0f: ", width, height, kernelSize) + format("pixel %.0f channel %.0f: %.0f", static_cast<double>(i / 4), static_cast<double>(i % 4), result[i])
+							+ format(" expected %.0f", expected[i]);
+					}
+				}
+			}
+		}
+		return {};
+	}
+
+	// 창 x - kernelWidth / 2 ~ + kernelWidth - 1 (세로도 같은 식)의 최댓값 / 최솟값, 영상 밖은 빼고
+	// grayChannel >= 0이면 그 채널 값으로 계산해서 B, G, R에 같이 씀, 알파는 그대로
+	std::vector<unsigned char> referenceMorphology(const std::vector<unsigned char>& pixels, int width, int height,
+		int kernelWidth, int kernelHeight, bool dilate, int grayChannel = -1, bool reflected = false)
+	{
+		// 뒤집은 구조 요소: 창 [x - (k - 1 - k / 2), x + k / 2]
+		const int anchorX = reflected ? kernelWidth - 1 - kernelWidth / 2 : kernelWidth / 2;
+		const int anchorY = reflected ? kernelHeight - 1 - kernelHeight / 2 : kernelHeight / 2;
+		std::vector<unsigned char> result = pixels;
+		for (int y = 0; y < height; y++) {
+			for (int x = 0; x < width; x++) {
+				for (int c = 0; c < 3; c++) {
+					const int source = grayChannel >= 0 ? grayChannel : c;
+					int value = dilate ? 0 : 255;
+					for (int ky = y - anchorY; ky < y - anchorY + kernelHeight; ky++) {
+						for (int kx = x - anchorX; kx < x - anchorX + kernelWidth; kx++) {
+							if (kx < 0 || ky < 0 || kx >= width || ky >= height) continue;
+							const int v = pixels[(static_cast<size_t>(ky) * width + kx) * 4 + source];
+							value = dilate ? std::max(value, v) : std::min(value, v);
+						}
+					}
+					result[(static_cast<size_t>(y) * width + x) * 4 + c] = static_cast<unsigned char>(value);
+				}
+			}
+		}
+		return result;
+	}
+
+	// 직사각형 팽창 / 침식 (van Herk/Gil-Werman): 짝수, 1, 영상보다 큰 크기 포함
+	std::string morphologyRectangles() {
+		const int width = 83, height = 61;
+		const std::vector<unsigned char> source = randomImage(width, height, 17);
+		const int kernels[][2] = { { 3, 3 }, { 1, 1 }, { 5, 2 }, { 4, 7 }, { 15, 9 }, { 1, 13 }, { 51, 1 }, { 100, 70 } };
+		for (const auto& kernel : kernels) {
+			for (bool dilate : { true, false }) {
+				const std::vector<unsigned char> expected = referenceMorphology(source, width, height, kernel[0], kernel[1], dilate);
+				for (int padding : { 0, 20 }) {
+					ImageProcessingEngine engine;
+					std::vector<unsigned char> result;
+					const std::string error = runStrided(source, width, height, padding, [&](const NativeEngine::ImageView& view) {
+						if (dilate) engine.ApplyDilation(view, kernel[0], kernel[1]);
+						else engine.ApplyErosion(view, kernel[0], kernel[1]);
+					}, result);
+					const std::string where = format(dilate ? "dilate %.0fx%.0f: " : "erode %.0fx%.0f: ", kernel[0], kernel[1]);
+					if (!error.empty()) return where + error;
+					const size_t i = firstDifference(result, expected);
+					if (i < result.size()) return where + format("pixel %.0f channel %.0f", static_cast<double>(i / 4), static_cast<double>(i % 4));
+				}
+			}
+		}
+		return {};
+	}
+
+	// 채널 모드별 팽창 / 침식: Color는 B, G, R 따로, Gray는 파란 채널(Rgba면 바이트 2) 값을 셋에
+	// 포인터 API 3x3도 가장자리까지 채널별 (예전 코드는 B만 보고 가장자리를 건너뜀)
+	std::string morphologyChannels() {
+		using NativeEngine::MorphologyChannels;
+		using NativeEngine::PixelLayout;
+		const int width = 71, height = 45;
+		const std::vector<unsigned char> source = randomImage(width, height, 29);
+		for (bool dilate : { true, false }) {
+			for (PixelLayout layout : { PixelLayout::Bgra32, PixelLayout::Rgba32 }) {
+				for (MorphologyChannels channels : { MorphologyChannels::Color, MorphologyChannels::Gray }) {
+					const int grayChannel = channels == MorphologyChannels::Color ? -1 : layout == PixelLayout::Bgra32 ? 0 : 2;
+					const std::vector<unsigned char> expected = referenceMorphology(source, width, height, 6, 5, dilate, grayChannel);
+					ImageProcessingEngine engine;
+					std::vector<unsigned char> result;
+					const std::string error = runStrided(source, width, height, 8, [&](const NativeEngine::ImageView& view) {
+						NativeEngine::ImageView laidOut = view;
+						laidOut.layout = layout;
+						if (dilate) engine.ApplyDilation(laidOut, 6, 5, channels);
+						else engine.ApplyErosion(laidOut, 6, 5, channels);
+					}, result);
+					const std::string where = std::string(dilate ? "dilate" : "erode") + (layout == PixelLayout::Bgra32 ? " bgra" : " rgba")
+						+ (channels == MorphologyChannels::Color ? " color: " : " gray: ");
+					if (!error.empty()) return where + error;
+					const size_t i = firstDifference(result, expected);
+					if (i < result.size()) return where + format("pixel %.0f channel %.0f", static_cast<double>(i / 4), static_cast<double>(i % 4));
+				}
+			}
+
+			std::vector<unsigned char> pixels = source;
+			ImageProcessingEngine engine;
+			if (dilate) engine.ApplyDilation(pixels.data(), width, height);
+			else engine.ApplyErosion(pixels.data(), width, height);
+			const size_t i = firstDifference(pixels, referenceMorphology(source, width, height, 3, 3, dilate));
+			if (i < pixels.size()) return format(dilate ? "3x3 dilate pixel %.0f channel %.0f" : "3x3 erode pixel %.0f channel %.0f", static_cast<double>(i / 4), static_cast<double>(i % 4));
+		}
+		return {};
+	}
+
+	// 복합 연산 = 단일 연산 참조를 차례로 (두 번째 단계도 같은 창 위치)
+	std::vector<unsigned char> referenceCompound(const std::vector<unsigned char>& pixels, int width, int height,
+		int kernelWidth, int kernelHeight, NativeEngine::CompoundMorphology op, int grayChannel)
+	{
+		using NativeEngine::CompoundMorphology;
+		// 두 번째 단계는 뒤집은 구조 요소 (짝수 크기에서도 열림 <= 원본 <= 닫힘)
+		auto apply = [&](const std::vector<unsigned char>& p, bool dilate, bool reflected = false) {
+			return referenceMorphology(p, width, height, kernelWidth, kernelHeight, dilate, grayChannel, reflected);
+		};
+		if (op == CompoundMorphology::Opening) return apply(apply(pixels, false), true, true);
+		if (op == CompoundMorphology::Closing) return apply(apply(pixels, true), false, true);
+
+		// 나머지는 high - low, 원본은 1x1 창 (Gray면 grayChannel 값이 B, G, R에)
+		const std::vector<unsigned char> original = referenceMorphology(pixels, width, height, 1, 1, true, grayChannel);
+		std::vector<unsigned char> high, low;
+		if (op == CompoundMorphology::Gradient) {
+			high = apply(pixels, true);
+			low = apply(pixels, false);
+		}
+		else if (op == CompoundMorphology::TopHat) {
+			high = original;
+			low = apply(apply(pixels, false), true, true);
+		}
+		else {
+			high = apply(apply(pixels, true), false, true);
+			low = original;
+		}
+		std::vector<unsigned char> result = pixels;
+		for (size_t i = 0; i < pixels.size(); i++) {
+			if (i % 4 != 3) result[i] = static_cast<unsigned char>(high[i] - low[i]);
+		}
+		return result;
+	}
+
+	// 열림, 닫힘, 그레이디언트, 톱햇, 블랙햇 (한 번에 스트리밍) = 단일 연산을 차례로 한 결과
+	// 폭 1100은 열 띠(512픽셀) 셋에 걸쳐 띠 경계 겹침도 확인, 짝수 크기 구조 요소에서도 열림 <= 원본 <= 닫힘
+	std::string morphologyCompound() {
+		using NativeEngine::CompoundMorphology;
+		using NativeEngine::MorphologyChannels;
+		const int width = 1100, height = 21;
+		const std::vector<unsigned char> source = randomImage(width, height, 23);
+		const int kernels[][2] = { { 3, 3 }, { 7, 5 }, { 1, 11 }, { 25, 3 }, { 2, 2 }, { 4, 6 }, { 6, 1 } };
+		const CompoundMorphology ops[] = { CompoundMorphology::Opening, CompoundMorphology::Closing, CompoundMorphology::Gradient,
+			CompoundMorphology::TopHat, CompoundMorphology::BlackHat };
+		for (const auto& kernel : kernels) {
+			for (CompoundMorphology op : ops) {
+				for (MorphologyChannels channels : { MorphologyChannels::Color, MorphologyChannels::Gray }) {
+					const std::vector<unsigned char> expected = referenceCompound(source, width, height, kernel[0], kernel[1], op,
+						channels == MorphologyChannels::Gray ? 0 : -1);
+					ImageProcessingEngine engine;
+					std::vector<unsigned char> result;
+					const std::string error = runStrided(source, width, height, 12, [&](const NativeEngine::ImageView& view) {
+						engine.ApplyMorphology(view, op, kernel[0], kernel[1], channels);
+					}, result);
+					const std::string where = format("op %.0f kernel %.0fx%.0f", static_cast<int>(op), kernel[0], kernel[1])
+						+ (channels == MorphologyChannels::Gray ? " gray: " : " color: ");
+					if (!error.empty()) return where + error;
+					const size_t i = firstDifference(result, expected);
+					if (i < result.size()) return where + format("pixel %.0f channel %.0f", static_cast<double>(i / 4), static_cast<double>(i % 4));
+
+					if (op != CompoundMorphology::Opening && op != CompoundMorphology::Closing) continue;
+					for (size_t j = 0; j < result.size(); j++) {
+						if (j % 4 == 3) continue;
+						const unsigned char original = source[channels == MorphologyChannels::Gray ? j / 4 * 4 : j];
+						if (op == CompoundMorphology::Opening ? result[j] > original : result[j] < original) {
+							return where + format("pixel %.0f channel %.0f not bounded by the original", static_cast<double>(j / 4), static_cast<double>(j % 4));
+						}
+					}
+				}
+			}
+		}
+		return {};
+	}
+
+	// 1비트 격자의 창 OR / AND (창 위치와 영상 밖 처리는 referenceMorphology와 같음)
+	// reflected: 뒤집은 구조 요소 (열림/닫힘 두 번째 연산)
+	std::vector<char> referenceBinaryMorphology(const std::vector<char>& bits, int width, int height, int kernelWidth, int kernelHeight,
+		bool dilate, bool reflected = false)
+	{
+		const int anchorX = reflected ? kernelWidth - 1 - kernelWidth / 2 : kernelWidth / 2;
+		const int anchorY = reflected ? kernelHeight - 1 - kernelHeight / 2 : kernelHeight / 2;
+		std::vector<char> result(bits.size());
+		for (int y = 0; y < height; y++) {
+			for (int x = 0; x < width; x++) {
+				bool value = !dilate;
+				for (int ky = std::max(0, y - anchorY); ky < std::min(height, y - anchorY + kernelHeight); ky++) {
+					for (int kx = std::max(0, x - anchorX); kx < std::min(width, x - anchorX + kernelWidth); kx++) {
+						if (dilate) value = value || bits[static_cast<size_t>(ky) * width + kx];
+						else value = value && bits[static_cast<size_t>(ky) * width + kx];
+					}
+				}
+				result[static_cast<size_t>(y) * width + x] = value;
+			}
+		}
+		return result;
+	}
+
+	// BinaryImage 비트와 격자 비교, 마지막 워드의 폭 밖 비트는 0이어야 함
+	std::string compareBinary(const NativeEngine::BinaryImage& binary, const std::vector<char>& expected) {
+		for (int y = 0; y < binary.height; y++) {
+			for (int x = 0; x < binary.width; x++) {
+				if (binary.Get(x, y) != (expected[static_cast<size_t>(y) * binary.width + x] != 0)) return format("bit (%.0f, %.0f)", x, y);
+			}
+			if (binary.Row(y)[binary.wordsPerRow - 1] & ~binary.TailMask()) return format("row %.0f tail bits set", y);
+		}
+		return {};
+	}
+
+	// 1비트 묶기 (휘도 >= threshold), 풀기, 비트 단위 팽창 / 침식 / 열림 / 닫힘
+	// 폭 150은 워드 경계(64)를 걸치고 마지막 워드가 일부만 쓰임
+	std::string binaryImageOps() {
+		const int width = 150, height = 37;
+		const std::vector<unsigned char> source = randomImage(width, height, 19);
+		const int threshold = 120;
+		std::vector<char> bits(static_cast<size_t>(width) * height);
+		for (size_t i = 0; i < bits.size(); i++) bits[i] = NativeEngine::GrayOf(source[i * 4], source[i * 4 + 1], source[i * 4 + 2]) >= threshold;
+
+		std::vector<unsigned char> pixels = source;
+		NativeEngine::BinaryImage packed;
+		NativeEngine::PackBinary(NativeEngine::ImageView(pixels.data(), width, height), packed, threshold);
+		std::string error = compareBinary(packed, bits);
+		if (!error.empty()) return "pack: " + error;
+
+		NativeEngine::UnpackBinary(packed, NativeEngine::ImageView(pixels.data(), width, height));
+		for (size_t i = 0; i < bits.size(); i++) {
+			const unsigned char v = bits[i] ? 255 : 0;
+			if (pixels[i * 4] != v || pixels[i * 4 + 1] != v || pixels[i * 4 + 2] != v || pixels[i * 4 + 3] != source[i * 4 + 3]) {
+				return format("unpack pixel %.0f", static_cast<double>(i));
+			}
+		}
+
+		NativeEngine::ScratchPool scratch;
+		const int kernels[][2] = { { 3, 3 }, { 5, 2 }, { 1, 9 }, { 70, 3 }, { 130, 1 }, { 4, 40 }, { 2, 2 } };
+		for (const auto& kernel : kernels) {
+			const int kw = kernel[0], kh = kernel[1];
+			const std::vector<char> dilated = referenceBinaryMorphology(bits, width, height, kw, kh, true);
+			const std::vector<char> eroded = referenceBinaryMorphology(bits, width, height, kw, kh, false);
+			const std::vector<char> opened = referenceBinaryMorphology(eroded, width, height, kw, kh, true, true);
+			const std::vector<char> closed = referenceBinaryMorphology(dilated, width, height, kw, kh, false, true);
+			// 열림 <= 원본 <= 닫힘 (짝수 크기 포함)
+			for (size_t i = 0; i < bits.size(); i++) {
+				if (opened[i] > bits[i] || closed[i] < bits[i]) return format("reference %.0fx%.0f not bounded at %.0f", kw, kh, static_cast<double>(i));
+			}
+			const std::pair<const char*, const std::vector<char>*> cases[] = { { "dilate", &dilated }, { "erode", &eroded }, { "open", &opened }, { "close", &closed } };
+			for (int op = 0; op < 4; op++) {
+				// 다른 출력 / 제자리 둘 다
+				for (bool inPlace : { false, true }) {
+					NativeEngine::BinaryImage src = packed, separate;
+					NativeEngine::BinaryImage& dst = inPlace ? src : separate;
+					if (op == 0) NativeEngine::BinaryDilate(src, dst, kw, kh, scratch);
+					else if (op == 1) NativeEngine::BinaryErode(src, dst, kw, kh, scratch);
+					else if (op == 2) NativeEngine::BinaryOpen(src, dst, kw, kh, scratch);
+					else NativeEngine::BinaryClose(src, dst, kw, kh, scratch);
+					error = compareBinary(dst, *cases[op].second);
+					if (!error.empty()) return std::string(cases[op].first) + format(" %.0fx%.0f: ", kw, kh) + (inPlace ? "in place " : "") + error;
+				}
+			}
+		}
+		return {};
+	}
+
+	// 검은 바탕에 흰 원 몇 개 + 흩어진 점 (거리가 큰 안쪽과 작은 조각이 섞이게), 알파는 제각각
+	std::vector<unsigned char> blobImage(int width, int height, unsigned seed) {
+		std::mt19937 rng(seed);
+		std::vector<unsigned char> pixels(static_cast<size_t>(width) * height * 4, 0);
+		for (size_t i = 3; i < pixels.size(); i += 4) pixels[i] = static_cast<unsigned char>(rng());
+		for (int blob = 0; blob < 6; blob++) {
+			const int cx = rng() % width, cy = rng() % height, r = 3 + rng() % 12;
+			for (int y = std::max(0, cy - r); y <= std::min(height - 1, cy + r); y++) {
+				for (int x = std::max(0, cx - r); x <= std::min(width - 1, cx + r); x++) {
+					if ((x - cx) * (x - cx) + (y - cy) * (y - cy) <= r * r) std::fill_n(&pixels[(static_cast<size_t>(y) * width + x) * 4], 3, 255);
+				}
+			}
+		}
+		for (int dot = 0; dot < width * height / 50; dot++) {
+			std::fill_n(&pixels[(static_cast<size_t>(rng() % height) * width + rng() % width) * 4], 3, rng() % 2 ? 255 : 0);
+		}
+		return pixels;
+	}
+
+	// 모든 target 픽셀까지의 거리 중 최솟값 (없으면 무한대)
+	std::vector<double> referenceDistance(const std::vector<char>& bits, int width, int height, bool target) {
+		std::vector<double> result(bits.size(), std::numeric_limits<double>::infinity());
+		for (int y = 0; y < height; y++) {
+			for (int x = 0; x < width; x++) {
+				long long best = -1;
+				for (int ty = 0; ty < height; ty++) {
+					for (int tx = 0; tx < width; tx++) {
+						if ((bits[static_cast<size_t>(ty) * width + tx] != 0) != target) continue;
+						const long long d = static_cast<long long>(tx - x) * (tx - x) + static_cast<long long>(ty - y) * (ty - y);
+						if (best < 0 || d < best) best = d;
+					}
+				}
+				if (best >= 0) result[static_cast<size_t>(y) * width + x] = std::sqrt(static_cast<double>(best));
+			}
+		}
+		return result;
+	}
+
+	// 정확한 유클리드 거리 변환 (float / uint16, 배경 / 전경 대상, 대상 없음) = 전수 최솟값
+	// 원판 팽창 / 침식 = 거리 <= radius / > radius
+	std::string distanceTransformExact() {
+		const int width = 97, height = 53;
+		const std::vector<unsigned char> source = blobImage(width, height, 31);
+		std::vector<char> bits(static_cast<size_t>(width) * height);
+		for (size_t i = 0; i < bits.size(); i++) bits[i] = source[i * 4] == 255;
+		const std::vector<double> toBackground = referenceDistance(bits, width, height, false);
+		const std::vector<double> toForeground = referenceDistance(bits, width, height, true);
+
+		ImageProcessingEngine engine;
+		std::vector<unsigned char> pixels = source;
+		std::vector<float> distances(bits.size());
+		std::vector<unsigned short> rounded(bits.size());
+		engine.ApplyDistanceTransform(pixels.data(), width, height, distances.data());
+		engine.ApplyDistanceTransform(pixels.data(), width, height, rounded.data());
+		if (pixels != source) return "distance transform changed the image";
+		for (size_t i = 0; i < bits.size(); i++) {
+			if (std::abs(distances[i] - toBackground[i]) > 1e-4) return format("pixel %.0f: %.4f expected %.4f", static_cast<double>(i), distances[i], toBackground[i]);
+			if (rounded[i] != static_cast<unsigned short>(std::lround(toBackground[i]))) return format("pixel %.0f: uint16 %.0f expected %.4f", static_cast<double>(i), rounded[i], toBackground[i]);
+		}
+
+		NativeEngine::ScratchPool scratch;
+		NativeEngine::BinaryImage binary;
+		NativeEngine::PackBinary(NativeEngine::ImageView(pixels.data(), width, height), binary);
+		NativeEngine::DistanceTransform(binary, NativeEngine::DistanceTarget::Foreground, distances.data(), scratch);
+		for (size_t i = 0; i < bits.size(); i++) {
+			if (std::abs(distances[i] - toForeground[i]) > 1e-4) return format("foreground pixel %.0f: %.4f expected %.4f", static_cast<double>(i), distances[i], toForeground[i]);
+		}
+
+		// 대상이 없으면 무한대 / 65535
+		NativeEngine::BinaryImage empty(width, height);
+		NativeEngine::DistanceTransform(empty, NativeEngine::DistanceTarget::Foreground, distances.data(), scratch);
+		NativeEngine::DistanceTransform(empty, NativeEngine::DistanceTarget::Foreground, rounded.data(), scratch);
+		for (size_t i = 0; i < bits.size(); i++) {
+			if (!std::isinf(distances[i]) || rounded[i] != 65535) return format("no target pixel %.0f: %.1f", static_cast<double>(i), distances[i]);
+		}
+
+		for (float radius : { 1.0f, 2.5f, 6.0f }) {
+			for (bool dilate : { true, false }) {
+				std::vector<unsigned char> disk = source;
+				if (dilate) engine.ApplyDiskDilation(disk.data(), width, height, radius);
+				else engine.ApplyDiskErosion(disk.data(), width, height, radius);
+				for (size_t i = 0; i < bits.size(); i++) {
+					const bool on = dilate ? toForeground[i] <= radius : toBackground[i] > radius;
+					const unsigned char v = on ? 255 : 0;
+					if (disk[i * 4] != v || disk[i * 4 + 1] != v || disk[i * 4 + 2] != v || disk[i * 4 + 3] != source[i * 4 + 3]) {
+						return format(dilate ? "disk dilate %.1f pixel %.0f" : "disk erode %.1f pixel %.0f", radius, static_cast<double>(i));
+					}
+				}
+			}
+		}
+		return {};
+	}
+
+	// 휘도 평면 (Rgba면 R과 B 자리가 바뀜)
+	std::vector<unsigned char> referenceGray(const std::vector<unsigned char>& pixels, bool rgba = false) {
+		std::vector<unsigned char> gray(pixels.size() / 4);
+		for (size_t i = 0; i < gray.size(); i++) {
+			const unsigned char* p = &pixels[i * 4];
+			gray[i] = rgba ? NativeEngine::GrayOf(p[2], p[1], p[0]) : NativeEngine::GrayOf(p[0], p[1], p[2]);
+		}
+		return gray;
+	}
+
+	// 안쪽 픽셀 3x3 소벨 (gx: 오른쪽 - 왼쪽, gy: 위 - 아래), 가장자리 1픽셀은 0
+	std::vector<std::pair<int, int>> referenceSobel(const std::vector<unsigned char>& gray, int width, int height) {
+		std::vector<std::pair<int, int>> gradients(gray.size(), { 0, 0 });
+		auto at = [&](int x, int y) { return static_cast<int>(gray[static_cast<size_t>(y) * width + x]); };
+		for (int y = 1; y < height - 1; y++) {
+			for (int x = 1; x < width - 1; x++) {
+				const int gx = at(x + 1, y - 1) + 2 * at(x + 1, y) + at(x + 1, y + 1) - at(x - 1, y - 1) - 2 * at(x - 1, y) - at(x - 1, y + 1);
+				const int gy = at(x - 1, y - 1) + 2 * at(x, y - 1) + at(x + 1, y - 1) - at(x - 1, y + 1) - 2 * at(x, y + 1) - at(x + 1, y + 1);
+				gradients[static_cast<size_t>(y) * width + x] = { gx, gy };
+			}
+		}
+		return gradients;
+	}
+
+	// 화면 좌표 그레이디언트 (gx, -gy)의 각도 (0 ~ 180도)
+	double gradientAngle(int gx, int gy) {
+		double angle = std::atan2(-static_cast<double>(gy), static_cast<double>(gx)) * 180.0 / 3.14159265358979323846;
+		if (angle < 0.0) angle += 180.0;
+		return angle >= 180.0 ? angle - 180.0 : angle;
+	}
+
+	// GradientDirection: 0도 가로, 45도 (오른쪽 아래) DiagonalDown, 90도 세로, 135도 DiagonalUp
+	int referenceDirection(int gx, int gy) {
+		const double angle = gradientAngle(gx, gy);
+		if (angle < 22.5 || angle >= 157.5) return 0;
+		if (angle < 67.5) return 1;
+		if (angle < 112.5) return 2;
+		return 3;
+	}
+
+	// 소벨 크기 (L2 내림 / L1, 255에서 자름)와 방향 = 참조 계산
+	// 방향은 구간 경계 0.01도 안이면 건너뜀 (tan 22.5도 16비트 고정소수점 반올림)
+	std::string sobelMatchesReference() {
+		using NativeEngine::GradientNorm;
+		using NativeEngine::PixelLayout;
+		const int width = 77, height = 51;
+		std::vector<unsigned char> source = randomImage(width, height, 37);
+		// 평탄한 영역 (크기 0, 방향 가로)과 곧은 에지도 섞음
+		for (int y = 10; y < 30; y++) {
+			for (int x = 20; x < 60; x++) std::fill_n(&source[(static_cast<size_t>(y) * width + x) * 4], 3, static_cast<unsigned char>(x < 40 ? 30 : 220));
+		}
+		for (PixelLayout layout : { PixelLayout::Bgra32, PixelLayout::Rgba32 }) {
+			const std::vector<std::pair<int, int>> gradients = referenceSobel(referenceGray(source, layout == PixelLayout::Rgba32), width, height);
+			for (GradientNorm norm : { GradientNorm::L2, GradientNorm::L1 }) {
+				ImageProcessingEngine engine;
+				std::vector<unsigned char> result, directions(static_cast<size_t>(width) * height, 9);
+				const std::string error = runStrided(source, width, height, 16, [&](const NativeEngine::ImageView& view) {
+					NativeEngine::ImageView laidOut = view;
+					laidOut.layout = layout;
+					engine.ApplySobel(laidOut, norm, directions.data());
+				}, result);
+				const std::string where = std::string(layout == PixelLayout::Bgra32 ? "bgra" : "rgba") + (norm == GradientNorm::L2 ? " L2: " : " L1: ");
+				if (!error.empty()) return where + error;
+
+				for (size_t i = 0; i < gradients.size(); i++) {
+					const int gx = gradients[i].first, gy = gradients[i].second;
+					const int magnitude = norm == GradientNorm::L2 ? static_cast<int>(std::sqrt(static_cast<double>(gx * gx + gy * gy))) : std::abs(gx) + std::abs(gy);
+					const unsigned char expected = static_cast<unsigned char>(std::min(magnitude, 255));
+					if (result[i * 4] != expected || result[i * 4 + 1] != expected || result[i * 4 + 2] != expected || result[i * 4 + 3] != source[i * 4 + 3]) {
+						return where + format("pixel %.0f magnitude %.0f expected %.0f", static_cast<double>(i), result[i * 4], expected);
+					}
+					const double angle = gradientAngle(gx, gy);
+					bool ambiguous = false;
+					for (double boundary : { 22.5, 67.5, 112.5, 157.5 }) ambiguous = ambiguous || std::abs(angle - boundary) < 0.01;
+					if (!ambiguous && directions[i] != referenceDirection(gx, gy)) {
+						return where + format("pixel %.0f direction %.0f expected %.0f", static_cast<double>(i), directions[i], referenceDirection(gx, gy));
+					}
+				}
+			}
+		}
+		return {};
+	}
+
+	// Canny 참조: 정수 가우시안 탭 (합 256, 가장자리 복제, 가로 → 세로) → 소벨 → 비최대 억제 → 8이웃 히스테리시스
+	std::vector<unsigned char> referenceCanny(std::vector<unsigned char> gray, int width, int height,
+		float sigma, int low, int high, bool l2)
+	{
+		if (sigma > 0.0f) {
+			const int radius = std::clamp(static_cast<int>(std::ceil(3.0f * sigma)), 1, NativeEngine::cannyMaxBlurRadius);
+			std::vector<double> weights(radius + 1);
+			double sum = 0.0;
+			for (int i = 0; i <= radius; i++) {
+				weights[i] = std::exp(-0.5 * i * i / (static_cast<double>(sigma) * sigma));
+				sum += i == 0 ? weights[i] : 2.0 * weights[i];
+			}
+			std::vector<int> taps(radius + 1);
+			taps[0] = 256;
+			for (int i = 1; i <= radius; i++) {
+				taps[i] = static_cast<int>(std::lround(weights[i] / sum * 256));
+				taps[0] -= 2 * taps[i];
+			}
+			for (int pass = 0; pass < 2; pass++) {
+				std::vector<unsigned char> blurred(gray.size());
+				for (int y = 0; y < height; y++) {
+					for (int x = 0; x < width; x++) {
+						int acc = 0;
+						for (int i = -radius; i <= radius; i++) {
+							const int xx = pass == 0 ? std::clamp(x + i, 0, width - 1) : x;
+							const int yy = pass == 1 ? std::clamp(y + i, 0, height - 1) : y;
+							acc += taps[std::abs(i)] * gray[static_cast<size_t>(yy) * width + xx];
+						}
+						blurred[static_cast<size_t>(y) * width + x] = static_cast<unsigned char>((acc + 128) >> 8);
+					}
+				}
+				gray.swap(blurred);
+			}
+		}
+
+		const std::vector<std::pair<int, int>> gradients = referenceSobel(gray, width, height);
+		std::vector<int> magnitude(gray.size());
+		for (size_t i = 0; i < gray.size(); i++) {
+			const int gx = gradients[i].first, gy = gradients[i].second;
+			magnitude[i] = l2 ? static_cast<int>(std::sqrt(static_cast<double>(gx * gx + gy * gy))) : std::abs(gx) + std::abs(gy);
+		}
+
+		// 0: 없음, 1: 약, 2: 강 (한쪽은 >, 다른 쪽은 >=)
+		static const int offsets[4][2] = { { 1, 0 }, { 1, 1 }, { 0, 1 }, { -1, 1 } };
+		std::vector<unsigned char> classes(gray.size(), 0);
+		for (int y = 1; y < height - 1; y++) {
+			for (int x = 1; x < width - 1; x++) {
+				const size_t i = static_cast<size_t>(y) * width + x;
+				const int m = magnitude[i];
+				if (m <= low) continue;
+				const int* o = offsets[referenceDirection(gradients[i].first, gradients[i].second)];
+				const int before = magnitude[static_cast<size_t>(y - o[1]) * width + (x - o[0])];
+				const int after = magnitude[static_cast<size_t>(y + o[1]) * width + (x + o[0])];
+				if (m > before && m >= after) classes[i] = m > high ? 2 : 1;
+			}
+		}
+
+		std::vector<unsigned char> edges(gray.size(), 0);
+		std::vector<size_t> stack;
+		for (size_t i = 0; i < classes.size(); i++) {
+			if (classes[i] == 2) {
+				edges[i] = 255;
+				stack.push_back(i);
+			}
+		}
+		while (!stack.empty()) {
+			const int x = static_cast<int>(stack.back() % width), y = static_cast<int>(stack.back() / width);
+			stack.pop_back();
+			for (int ny = std::max(0, y - 1); ny <= std::min(height - 1, y + 1); ny++) {
+				for (int nx = std::max(0, x - 1); nx <= std::min(width - 1, x + 1); nx++) {
+					const size_t n = static_cast<size_t>(ny) * width + nx;
+					if (classes[n] != 0 && edges[n] == 0) {
+						edges[n] = 255;
+						stack.push_back(n);
+					}
+				}
+			}
+		}
+		return edges;
+	}
+
+	// 원 둘레를 따라 대비가 강 → 약으로 바뀌어 약한 에지가 여러 띠에 걸쳐 이어지는 영상 + 잡음
+	// sigma 0 / 1 / 2.5, L1 / L2를 참조 Canny와 비교
+	std::string cannyMatchesReference() {
+		const int width = 173, height = 211;
+		std::vector<unsigned char> source = randomImage(width, height, 41);
+		for (int y = 0; y < height; y++) {
+			for (int x = 0; x < width; x++) {
+				const double dx = x - 86.0, dy = y - 105.0;
+				const double angle = std::atan2(dy, dx);
+				const int inside = dx * dx + dy * dy < 80.0 * 80.0 ? static_cast<int>(20 + 60 * (1.0 + std::cos(angle))) : 0;
+				unsigned char* p = &source[(static_cast<size_t>(y) * width + x) * 4];
+				for (int c = 0; c < 3; c++) p[c] = static_cast<unsigned char>(90 + inside + p[c] % 9);
+			}
+		}
+		const std::vector<unsigned char> gray = referenceGray(source);
+
+		struct Case { float sigma; int low, high; NativeEngine::GradientNorm norm; };
+		const Case cases[] = {
+			{ 0.0f, 60, 160, NativeEngine::GradientNorm::L2 },
+			{ 1.0f, 40, 120, NativeEngine::GradientNorm::L2 },
+			{ 2.5f, 90, 30, NativeEngine::GradientNorm::L1 },
+		};
+		for (const Case& c : cases) {
+			const std::vector<unsigned char> expected = referenceCanny(gray, width, height, c.sigma,
+				std::min(c.low, c.high), std::max(c.low, c.high), c.norm == NativeEngine::GradientNorm::L2);
+			ImageProcessingEngine engine;
+			std::vector<unsigned char> result;
+			const std::string error = runStrided(source, width, height, 8, [&](const NativeEngine::ImageView& view) {
+				engine.ApplyCanny(view, c.sigma, c.low, c.high, c.norm);
+			}, result);
+			if (!error.empty()) return format("sigma %.1f: ", c.sigma) + error;
+
+			size_t edgeCount = 0;
+			for (size_t i = 0; i < expected.size(); i++) {
+				edgeCount += expected[i] != 0;
+				if (result[i * 4] != expected[i] || result[i * 4 + 1] != expected[i] || result[i * 4 + 2] != expected[i] || result[i * 4 + 3] != source[i * 4 + 3]) {
+					return format("sigma %.1f pixel (%.0f, %.0f) differs", c.sigma, static_cast<double>(i % width), static_cast<double>(i / width));
+				}
+			}
+			if (edgeCount < 200) return format("sigma %.1f: only %.0f edge pixels", c.sigma, static_cast<double>(edgeCount));
+		}
+		return {};
+	}
+
+	// 3x3 상관 (k: 행 우선, 위 행이 k[0..2]), 가장자리 1픽셀은 0
+	std::vector<int> referenceStencil(const std::vector<unsigned char>& gray, int width, int height, const int (&k)[9]) {
+		std::vector<int> response(gray.size(), 0);
+		for (int y = 1; y < height - 1; y++) {
+			for (int x = 1; x < width - 1; x++) {
+				int acc = 0;
+				for (int j = 0; j < 3; j++) {
+					for (int i = 0; i < 3; i++) acc += k[j * 3 + i] * gray[static_cast<size_t>(y + j - 1) * width + (x + i - 1)];
+				}
+				response[static_cast<size_t>(y) * width + x] = acc;
+			}
+		}
+		return response;
+	}
+
+	// ApplyStencil / ApplyLaplacian (Fixed, Normalized) = 참조 상관
+	// 그레이디언트는 float 제곱근 내림, 엠보스는 응답 + 128 (가장자리 128), 정규화는 |응답| * 255 / 최댓값
+	std::string stencilsMatchReference() {
+		using NativeEngine::StencilOperator;
+		using NativeEngine::LaplacianScale;
+		const int width = 67, height = 45;
+		const std::vector<unsigned char> source = randomImage(width, height, 43);
+		const std::vector<unsigned char> gray = referenceGray(source);
+
+		static const int scharrX[9] = { -3, 0, 3, -10, 0, 10, -3, 0, 3 }, scharrY[9] = { 3, 10, 3, 0, 0, 0, -3, -10, -3 };
+		static const int prewittX[9] = { -1, 0, 1, -1, 0, 1, -1, 0, 1 }, prewittY[9] = { 1, 1, 1, 0, 0, 0, -1, -1, -1 };
+		static const int sobelX[9] = { -1, 0, 1, -2, 0, 2, -1, 0, 1 }, sobelY[9] = { 1, 2, 1, 0, 0, 0, -1, -2, -1 };
+		static const int laplacian4[9] = { 0, 1, 0, 1, -4, 1, 0, 1, 0 }, laplacian8[9] = { 1, 1, 1, 1, -8, 1, 1, 1, 1 };
+		static const int emboss[9] = { -2, -1, 0, -1, 1, 1, 0, 1, 2 };
+		auto magnitude = [&](const int (&kx)[9], const int (&ky)[9]) {
+			const std::vector<int> gx = referenceStencil(gray, width, height, kx), gy = referenceStencil(gray, width, height, ky);
+			std::vector<int> out(gray.size());
+			for (size_t i = 0; i < out.size(); i++) out[i] = static_cast<int>(std::sqrt(static_cast<float>(gx[i] * gx[i] + gy[i] * gy[i])));
+			return out;
+		};
+		auto absolute = [&](const int (&k)[9]) {
+			std::vector<int> out = referenceStencil(gray, width, height, k);
+			for (int& v : out) v = std::abs(v);
+			return out;
+		};
+		auto clip = [](std::vector<int> values, int bias) {
+			for (int& v : values) v = std::clamp(v + bias, 0, 255);
+			return values;
+		};
+		auto normalized = [](std::vector<int> values) {
+			const int top = std::max(1, *std::max_element(values.begin(), values.end()));
+			for (int& v : values) v = v * 255 / top;
+			return values;
+		};
+
+		std::vector<int> embossed = clip(referenceStencil(gray, width, height, emboss), 128);
+		for (int y = 0; y < height; y++) {
+			for (int x = 0; x < width; x++) {
+				if (x == 0 || y == 0 || x == width - 1 || y == height - 1) embossed[static_cast<size_t>(y) * width + x] = 128;
+			}
+		}
+
+		using Apply = std::function<void(ImageProcessingEngine&, const NativeEngine::ImageView&)>;
+		auto stencil = [](StencilOperator op) -> Apply {
+			return [op](ImageProcessingEngine& engine, const NativeEngine::ImageView& view) { engine.ApplyStencil(view, op); };
+		};
+		auto laplacian = [](StencilOperator op, LaplacianScale scale) -> Apply {
+			return [op, scale](ImageProcessingEngine& engine, const NativeEngine::ImageView& view) { engine.ApplyLaplacian(view, op, scale); };
+		};
+		const std::pair<Apply, std::vector<int>> cases[] = {
+			{ stencil(StencilOperator::Scharr), clip(magnitude(scharrX, scharrY), 0) },
+			{ stencil(StencilOperator::Prewitt), clip(magnitude(prewittX, prewittY), 0) },
+			{ stencil(StencilOperator::Sobel), clip(magnitude(sobelX, sobelY), 0) },
+			{ stencil(StencilOperator::Emboss), embossed },
+			{ laplacian(StencilOperator::Laplacian4, LaplacianScale::Fixed), clip(absolute(laplacian4), 0) },
+			{ laplacian(StencilOperator::Laplacian8, LaplacianScale::Fixed), clip(absolute(laplacian8), 0) },
+			{ laplacian(StencilOperator::Laplacian4, LaplacianScale::Normalized), normalized(absolute(laplacian4)) },
+			{ laplacian(StencilOperator::Laplacian8, LaplacianScale::Normalized), normalized(absolute(laplacian8)) },
+			{ stencil(StencilOperator::Laplacian8), normalized(absolute(laplacian8)) },
+		};
+		for (size_t c = 0; c < std::size(cases); c++) {
+			ImageProcessingEngine engine;
+			std::vector<unsigned char> result;
+			const std::string error = runStrided(source, width, height, 8, [&](const NativeEngine::ImageView& view) {
+				cases[c].first(engine, view);
+			}, result);
+			if (!error.empty()) return format("case %.0f: ", static_cast<double>(c)) + error;
+			const std::vector<int>& expected = cases[c].second;
+			for (size_t i = 0; i < expected.size(); i++) {
+				if (result[i * 4] != expected[i] || result[i * 4 + 1] != expected[i] || result[i * 4 + 2] != expected[i] || result[i * 4 + 3] != source[i * 4 + 3]) {
+					return format("case %.0f pixel %.0f expected %.0f", static_cast<double>(c), static_cast<double>(i), expected[i]);
+				}
+			}
+		}
+		return {};
+	}
+
+	// 가우시안 장 = 원본 휘도를 정확한 가우시안 (입력 블러 0.5를 뺀 누적 sigma)으로 블러해 옥타브 간격으로 뽑은 값
+	// 증분 블러 + 솎아 내기가 한 번에 블러한 것과 0.5단계 안, DoG / LoG는 가우시안 장에서 다시 계산한 값과 같음
+	std::string scaleSpaceMatchesReference() {
+		using NativeEngine::ScaleSpaceResponse;
+		const int width = 131, height = 97;
+		std::vector<unsigned char> source(static_cast<size_t>(width) * height * 4, 255);
+		for (int y = 0; y < height; y++) {
+			for (int x = 0; x < width; x++) {
+				const double dx = x - 70.0, dy = y - 40.0;
+				const double value = 110.0 + 50.0 * std::sin(x / 6.0) * std::cos(y / 8.0) + (dx * dx + dy * dy < 400.0 ? 70.0 : 0.0);
+				std::fill_n(&source[(static_cast<size_t>(y) * width + x) * 4], 3, static_cast<unsigned char>(value));
+			}
+		}
+
+		for (ScaleSpaceResponse response : { ScaleSpaceResponse::DoG, ScaleSpaceResponse::LoG }) {
+			NativeEngine::ScaleSpaceOptions options;
+			options.response = response;
+			ImageProcessingEngine engine;
+			NativeEngine::ScaleSpace space;
+			engine.BuildScaleSpace(source.data(), width, height, options, space);
+
+			const bool dog = response == ScaleSpaceResponse::DoG;
+			const int levels = options.levelsPerOctave + 3;
+			const int responseLevels = dog ? levels - 1 : levels;
+			// 131 x 97 -> 66 x 49 -> 33 x 25 -> 17 x 13
+			if (space.gaussians.size() != static_cast<size_t>(4 * levels) || space.responses.size() != static_cast<size_t>(4 * responseLevels)) {
+				return format("%.0f gaussians, %.0f responses", static_cast<double>(space.gaussians.size()), static_cast<double>(space.responses.size()));
+			}
+
+			// 가장자리 복제는 블러를 나눠 하면 한 번에 한 것과 달라지므로 원본 2 sigma 안쪽만 비교
+			double worst[4] = {};
+			for (const NativeEngine::ScaleSpacePlane& plane : space.gaussians) {
+				const int step = 1 << plane.octave;
+				const double expectedSigma = options.baseSigma * std::pow(2.0, plane.level / static_cast<double>(options.levelsPerOctave)) * step;
+				if (plane.width != (width + step - 1) / step || plane.height != (height + step - 1) / step || std::abs(plane.sigma - expectedSigma) > 1e-3 * expectedSigma) {
+					return format("octave %.0f level %.0f layout", plane.octave, plane.level);
+				}
+				const std::vector<double> reference = referenceGaussian(source, width, height, 0,
+					std::sqrt(expectedSigma * expectedSigma - options.inputSigma * options.inputSigma));
+				const float* data = space.Data(plane);
+				const int margin = static_cast<int>(std::ceil(2.0 * expectedSigma));
+				for (int y = 0; y < plane.height; y++) {
+					for (int x = 0; x < plane.width; x++) {
+						if (std::min(x * step, y * step) < margin || x * step >= width - margin || y * step >= height - margin) continue;
+						const double error = std::abs(data[static_cast<size_t>(y) * plane.width + x] - reference[static_cast<size_t>(y) * step * width + static_cast<size_t>(x) * step]);
+						worst[plane.octave] = std::max(worst[plane.octave], error);
+					}
+				}
+			}
+			for (int octave = 0; octave < 4; octave++) {
+				if (worst[octave] > 0.5) return format("octave %.0f: max error %.3f", octave, worst[octave]);
+			}
+
+			for (const NativeEngine::ScaleSpacePlane& plane : space.responses) {
+				const NativeEngine::ScaleSpacePlane& lower = space.gaussians[static_cast<size_t>(plane.octave) * levels + plane.level];
+				const float* g = space.Data(lower);
+				const float* upper = dog ? space.Data(space.gaussians[static_cast<size_t>(plane.octave) * levels + plane.level + 1]) : nullptr;
+				const double scale = std::pow(lower.sigma / (1 << plane.octave), 2.0);
+				const float* data = space.Data(plane);
+				const int w = plane.width, h = plane.height;
+				for (int y = 0; y < h; y++) {
+					for (int x = 0; x < w; x++) {
+						const size_t i = static_cast<size_t>(y) * w + x;
+						double expected;
+						if (dog) expected = upper[i] - g[i];
+						else {
+							auto at = [&](int xx, int yy) { return static_cast<double>(g[static_cast<size_t>(std::clamp(yy, 0, h - 1)) * w + std::clamp(xx, 0, w - 1)]); };
+							expected = scale * (at(x - 1, y) + at(x + 1, y) + at(x, y - 1) + at(x, y + 1) - 4.0 * at(x, y));
+						}
+						// float 차의 상쇄 오차가 sigma^2배로 커짐
+						if (std::abs(data[i] - expected) > 1e-4 * (1.0 + 2.0 * scale)) {
+							return format("octave %.0f level %.0f response %.4f", plane.octave, plane.level, data[i]) + format(" expected %.4f", expected);
+						}
+					}
+				}
+			}
+		}
+		return {};
+	}
+
+	// 적분 영상 Sum / SquareSum / Variance = 사각형을 직접 더한 값
+	// 4200 x 4100 (1720만 픽셀)은 합/제곱 합 모두 64비트 표, 밝은 영상이라 전체 합이 2^32를 넘음
+	// 300 x 200은 합 32비트, 제곱 합 64비트 (6만 6051픽셀 기준 아래/위를 둘 다)
+	std::string integralImageMatchesBruteForce() {
+		struct Case { int width, height; bool wideSum, wideSquares; };
+		const Case cases[] = { { 4200, 4100, true, true }, { 300, 200, false, false }, { 300, 230, false, true } };
+		for (const Case& c : cases) {
+			const int width = c.width, height = c.height;
+			std::mt19937 rng(67);
+			std::vector<unsigned char> gray(static_cast<size_t>(width) * height);
+			for (unsigned char& v : gray) v = static_cast<unsigned char>(250 + rng() % 6);
+			// 어두운 잡음 구간
+			for (int y = height / 3; y < height / 3 + height / 20; y++) {
+				for (int x = width / 4; x < width / 4 + width / 14; x++) gray[static_cast<size_t>(y) * width + x] = static_cast<unsigned char>(rng());
+			}
+
+			NativeEngine::ScratchPool scratch;
+			NativeEngine::IntegralImage integral(scratch);
+			integral.Build(gray.data(), width, height, true);
+			const std::string where = format("%.0fx%.0f: ", width, height);
+			if (integral.WideSum() != c.wideSum || integral.WideSquares() != c.wideSquares) return where + "table width";
+
+			// 전체, 이미지 밖으로 나간 사각형 (잘림), 빈 사각형, 띠 경계를 지나는 임의 사각형
+			std::vector<std::array<int, 4>> rects = { { 0, 0, width, height }, { -50, -20, width / 3, height + 40 }, { 10, 10, 10, 50 } };
+			for (int i = 0; i < 12; i++) {
+				const int x0 = static_cast<int>(rng() % width), y0 = static_cast<int>(rng() % height);
+				rects.push_back({ x0, y0, x0 + 1 + static_cast<int>(rng() % (width - x0)), y0 + 1 + static_cast<int>(rng() % (height - y0)) });
+			}
+			for (const auto& r : rects) {
+				const int x0 = std::clamp(r[0], 0, width), y0 = std::clamp(r[1], 0, height);
+				const int x1 = std::clamp(r[2], x0, width), y1 = std::clamp(r[3], y0, height);
+				unsigned long long sum = 0, squares = 0;
+				for (int y = y0; y < y1; y++) {
+					const unsigned char* row = &gray[static_cast<size_t>(y) * width];
+					for (int x = x0; x < x1; x++) {
+						sum += row[x];
+						squares += static_cast<unsigned long long>(row[x]) * row[x];
+					}
+				}
+				const double area = static_cast<double>(x1 - x0) * (y1 - y0);
+				const double mean = area > 0.0 ? sum / area : 0.0;
+				const double variance = area > 0.0 ? squares / area - mean * mean : 0.0;
+				const std::string rect = format("rect (%.0f, %.0f, ", r[0], r[1]) + format("%.0f, %.0f) ", r[2], r[3]);
+				if (integral.Sum(r[0], r[1], r[2], r[3]) != sum) return where + rect + format("sum %.0f expected %.0f", static_cast<double>(integral.Sum(r[0], r[1], r[2], r[3])), static_cast<double>(sum));
+				if (integral.SquareSum(r[0], r[1], r[2], r[3]) != squares) return where + rect + "square sum";
+				if (std::abs(integral.Variance(r[0], r[1], r[2], r[3]) - variance) > 1e-6 * (1.0 + variance)) {
+					return where + rect + format("variance %.6f expected %.6f", integral.Variance(r[0], r[1], r[2], r[3]), variance);
+				}
+			}
+			if (c.wideSum && integral.Sum(0, 0, width, height) <= 0xFFFFFFFFull) return where + "total does not exceed 32 bits";
+
+			// 픽셀 루프용 표도 같은 값
+			unsigned long long visited = 0;
+			integral.VisitSum([&](const auto& table) { visited = table.Sum(1, 2, width - 3, height - 1); });
+			if (visited != integral.Sum(1, 2, width - 3, height - 1)) return where + "VisitSum table";
+		}
+		return {};
+	}
+
+	// Bradley / Sauvola = 창을 직접 더한 double 참조 (창은 이미지 안쪽만, 창 크기 0 -> 기본값, 짝수 -> 홀수)
+	// 적분 영상 float 반올림으로 뒤집힐 수 있는 임계값 바로 옆 픽셀은 건너뜀 (전체의 1% 미만이어야 함)
+	std::string adaptiveThresholdMatchesReference() {
+		using NativeEngine::BinarizationMethod;
+		const int width = 93, height = 71;
+		std::vector<unsigned char> source = randomImage(width, height, 47);
+		// 조명 기울기 + 글자 같은 어두운 획 + 잡음
+		for (int y = 0; y < height; y++) {
+			for (int x = 0; x < width; x++) {
+				unsigned char* p = &source[(static_cast<size_t>(y) * width + x) * 4];
+				const int stroke = (x % 17 < 3 || (y % 13 < 2 && x % 29 < 20)) ? 70 : 0;
+				for (int c = 0; c < 3; c++) p[c] = static_cast<unsigned char>(std::clamp(60 + x + y / 2 - stroke + p[c] % 23, 0, 255));
+			}
+		}
+		const std::vector<unsigned char> gray = referenceGray(source);
+
+		struct Case { BinarizationMethod method; int windowSize; int expectedWindow; float sensitivity, k, range; };
+		const Case cases[] = {
+			{ BinarizationMethod::Bradley, 0, 15, 0.15f, 0.0f, 0.0f },
+			{ BinarizationMethod::Bradley, 10, 11, 0.05f, 0.0f, 0.0f },
+			{ BinarizationMethod::Sauvola, 31, 31, 0.0f, 0.34f, 128.0f },
+			{ BinarizationMethod::Sauvola, 0, 15, 0.0f, 0.2f, 64.0f },
+		};
+		for (const Case& c : cases) {
+			NativeEngine::BinarizationOptions options;
+			options.method = c.method;
+			options.windowSize = c.windowSize;
+			options.sensitivity = c.sensitivity;
+			options.k = c.k;
+			options.dynamicRange = c.range;
+			if (NativeEngine::AdaptiveWindowSize(options, width, height) != c.expectedWindow) {
+				return format("window %.0f -> %.0f", c.windowSize, NativeEngine::AdaptiveWindowSize(options, width, height));
+			}
+
+			ImageProcessingEngine engine;
+			std::vector<unsigned char> result;
+			const std::string error = runStrided(source, width, height, 8, [&](const NativeEngine::ImageView& view) {
+				engine.ApplyBinarization(view, options);
+			}, result);
+			if (!error.empty()) return format("window %.0f: ", c.windowSize) + error;
+
+			const int radius = c.expectedWindow / 2;
+			int skipped = 0;
+			for (int y = 0; y < height; y++) {
+				for (int x = 0; x < width; x++) {
+					double sum = 0.0, squares = 0.0;
+					int area = 0;
+					for (int yy = std::max(0, y - radius); yy <= std::min(height - 1, y + radius); yy++) {
+						for (int xx = std::max(0, x - radius); xx <= std::min(width - 1, x + radius); xx++) {
+							const double v = gray[static_cast<size_t>(yy) * width + xx];
+							sum += v;
+							squares += v * v;
+							area++;
+						}
+					}
+					const double mean = sum / area;
+					const double threshold = c.method == BinarizationMethod::Bradley ? mean * (1.0 - c.sensitivity)
+						: mean * (1.0 + c.k * (std::sqrt(std::max(0.0, squares / area - mean * mean)) / c.range - 1.0));
+					const size_t i = static_cast<size_t>(y) * width + x;
+					const double value = gray[i];
+					if (std::abs(value - threshold) < 0.25) {
+						skipped++;
+						continue;
+					}
+					const unsigned char expected = value > threshold ? 255 : 0;
+					if (result[i * 4] != expected || result[i * 4 + 1] != expected || result[i * 4 + 2] != expected || result[i * 4 + 3] != source[i * 4 + 3]) {
+						return format("window %.0f pixel (%.0f, %.0f) differs", c.windowSize, x, y);
+					}
+				}
+			}
+			if (skipped * 100 > width * height) return format("window %.0f: %.0f pixels at the threshold", c.windowSize, skipped);
+		}
+		return {};
+	}
+
+	// 라벨 평면과 요소 통계 = 래스터 순서 BFS 참조 (라벨은 요소 첫 픽셀 순서)
+	// 모든 띠를 지나는 뱀 모양과, 띠마다 따로 시작해 맨 아래에서야 합쳐지는 빗 모양 + 절반 밀도 잡음
+	std::string componentsMatchReference() {
+		using NativeEngine::Connectivity;
+		const int width = 89, height = 233;
+		std::mt19937 rng(53);
+		std::vector<unsigned char> source(static_cast<size_t>(width) * height * 4);
+		for (size_t i = 0; i < source.size(); i += 4) {
+			const unsigned char v = rng() % 2 ? 255 : 0;
+			std::fill_n(&source[i], 3, v);
+			source[i + 3] = static_cast<unsigned char>(rng());
+		}
+		auto set = [&](int x, int y, unsigned char v) { std::fill_n(&source[(static_cast<size_t>(y) * width + x) * 4], 3, v); };
+		for (int y = 0; y < height; y++) {
+			for (int x = 0; x < 30; x++) set(x, y, 0);
+			for (int x = 60; x < width; x++) set(x, y, 0);
+		}
+		// 뱀: 3행마다 방향을 바꾸는 가로 줄 (x 1..27)
+		for (int y = 0; y < height; y += 3) {
+			for (int x = 1; x < 28; x++) set(x, y, 255);
+			if (y + 3 < height) {
+				const int x = (y / 3) % 2 ? 1 : 27;
+				set(x, y + 1, 255);
+				set(x, y + 2, 255);
+			}
+		}
+		// 빗: 세로 살 (x 62, 66, ...)이 마지막 행에서만 이어짐
+		for (int x = 62; x < width - 1; x += 4) {
+			for (int y = 0; y < height; y++) set(x, y, 255);
+		}
+		for (int x = 62; x < width - 1; x++) set(x, height - 1, 255);
+
+		for (Connectivity connectivity : { Connectivity::Four, Connectivity::Eight }) {
+			const bool eight = connectivity == Connectivity::Eight;
+			std::vector<int> expected(static_cast<size_t>(width) * height, 0);
+			std::vector<NativeEngine::Blob> expectedBlobs;
+			std::vector<size_t> queue;
+			for (size_t start = 0; start < expected.size(); start++) {
+				if (source[start * 4] < 128 || expected[start] != 0) continue;
+				NativeEngine::Blob blob;
+				blob.label = static_cast<int>(expectedBlobs.size()) + 1;
+				blob.left = width;
+				blob.top = height;
+				blob.right = blob.bottom = -1;
+				double sumX = 0.0, sumY = 0.0;
+				expected[start] = blob.label;
+				queue.assign(1, start);
+				for (size_t head = 0; head < queue.size(); head++) {
+					const int x = static_cast<int>(queue[head] % width), y = static_cast<int>(queue[head] / width);
+					blob.area++;
+					sumX += x;
+					sumY += y;
+					blob.left = std::min(blob.left, x);
+					blob.right = std::max(blob.right, x);
+					blob.top = std::min(blob.top, y);
+					blob.bottom = std::max(blob.bottom, y);
+					for (int dy = -1; dy <= 1; dy++) {
+						for (int dx = -1; dx <= 1; dx++) {
+							if ((dx == 0 && dy == 0) || (!eight && dx != 0 && dy != 0)) continue;
+							const int nx = x + dx, ny = y + dy;
+							if (nx < 0 || ny < 0 || nx >= width || ny >= height) continue;
+							const size_t n = static_cast<size_t>(ny) * width + nx;
+							if (source[n * 4] >= 128 && expected[n] == 0) {
+								expected[n] = blob.label;
+								queue.push_back(n);
+							}
+						}
+					}
+				}
+				blob.centroidX = sumX / blob.area;
+				blob.centroidY = sumY / blob.area;
+				expectedBlobs.push_back(blob);
+			}
+
+			ImageProcessingEngine engine;
+			std::vector<int> labels(expected.size(), -1);
+			std::vector<NativeEngine::Blob> blobs;
+			int count = 0;
+			std::vector<unsigned char> result;
+			const std::string error = runStrided(source, width, height, 8, [&](const NativeEngine::ImageView& view) {
+				count = engine.LabelComponents(view, connectivity, labels.data(), blobs);
+			}, result);
+			const std::string where = eight ? "8-connected: " : "4-connected: ";
+			if (!error.empty()) return where + error;
+			if (result != source) return where + "image changed";
+			if (count != static_cast<int>(expectedBlobs.size()) || blobs.size() != expectedBlobs.size()) {
+				return where + format("%.0f components (%.0f blobs), expected %.0f", count, static_cast<double>(blobs.size()), static_cast<double>(expectedBlobs.size()));
+			}
+			if (labels != expected) return where + format("label plane differs at %.0f", static_cast<double>(std::mismatch(labels.begin(), labels.end(), expected.begin()).first - labels.begin()));
+			for (size_t i = 0; i < blobs.size(); i++) {
+				const NativeEngine::Blob& a = blobs[i];
+				const NativeEngine::Blob& b = expectedBlobs[i];
+				if (a.label != b.label || a.area != b.area || a.left != b.left || a.top != b.top || a.right != b.right || a.bottom != b.bottom
+					|| std::abs(a.centroidX - b.centroidX) > 1e-9 || std::abs(a.centroidY - b.centroidY) > 1e-9)
+				{
+					return where + format("blob %.0f area %.0f expected %.0f", static_cast<double>(b.label), a.area, b.area);
+				}
+			}
+		}
+		return {};
+	}
+
+	// 반복 무늬 + 작은 잡음에서 그대로 잘라 낸 템플릿: 줄인 단계에서는 주기마다 비슷해 보여도 원래 위치를 찾아야 함
+	std::string templateMatchRepetitive() {
+		std::mt19937 rng(5);
+		for (int run = 0; run < 12; run++) {
+			const int width = 300 + rng() % 200, height = 200 + rng() % 150;
+			const int periodX = 20 + rng() % 30, periodY = 20 + rng() % 30;
+			std::vector<unsigned char> pixels(static_cast<size_t>(width) * height * 4);
+			for (int y = 0; y < height; y++) {
+				for (int x = 0; x < width; x++) {
+					const double wave = 128.0 + 60.0 * std::sin(6.283185307 * x / periodX) + 50.0 * std::cos(6.283185307 * y / periodY);
+					const unsigned char v = static_cast<unsigned char>(std::clamp(static_cast<int>(wave) + static_cast<int>(rng() % 5), 0, 255));
+					unsigned char* p = &pixels[(static_cast<size_t>(y) * width + x) * 4];
+					p[0] = p[1] = p[2] = v;
+					p[3] = 255;
+				}
+			}
+			const int templateWidth = 48 + rng() % 40, templateHeight = 48 + rng() % 40;
+			const int originX = rng() % (width - templateWidth + 1), originY = rng() % (height - templateHeight + 1);
+			std::vector<unsigned char> templ(static_cast<size_t>(templateWidth) * templateHeight * 4);
+			for (int y = 0; y < templateHeight; y++) {
+				std::copy_n(&pixels[(static_cast<size_t>(originY + y) * width + originX) * 4], templateWidth * 4, &templ[static_cast<size_t>(y) * templateWidth * 4]);
+			}
+
+			ImageProcessingEngine engine;
+			for (TemplateMatchMode mode : { TemplateMatchMode::Exhaustive, TemplateMatchMode::Pyramid }) {
+				TemplateMatchOptions options;
+				options.mode = mode;
+				int x = -1, y = -1;
+				engine.ApplyTemplateMatch(pixels.data(), width, height, templ.data(), templateWidth, templateHeight, &x, &y, options);
+				if (x != originX || y != originY) {
+					return format(mode == TemplateMatchMode::Pyramid ? "pyramid found %.0f,%.0f expected %.0f" : "exhaustive found %.0f,%.0f expected %.0f",
+						x, y, originX) + format(",%.0f", originY);
+				}
+			}
+		}
+		return "";
+	}
+
+	// 격자 간격 cell마다 무작위 값, 사이는 쌍선형 보간 (자연 영상처럼 부드러운 무늬)
+	void addValueNoise(std::vector<double>& plane, int width, int height, int cell, double amplitude, std::mt19937& rng) {
+		const int gridWidth = width / cell + 2, gridHeight = height / cell + 2;
+		std::vector<double> grid(static_cast<size_t>(gridWidth) * gridHeight);
+		for (double& g : grid) g = (rng() % 2001 / 1000.0 - 1.0) * amplitude;
+		for (int y = 0; y < height; y++) {
+			for (int x = 0; x < width; x++) {
+				const int gx = x / cell, gy = y / cell;
+				const double fx = static_cast<double>(x % cell) / cell, fy = static_cast<double>(y % cell) / cell;
+				const double* g0 = &grid[static_cast<size_t>(gy) * gridWidth + gx];
+				const double* g1 = g0 + gridWidth;
+				plane[static_cast<size_t>(y) * width + x] += (g0[0] * (1 - fx) + g0[1] * fx) * (1 - fy) + (g1[0] * (1 - fx) + g1[1] * fx) * fy;
+			}
+		}
+	}
+
+	// 잡음 없는 영상에서 잘라 낸 템플릿을 잡음 섞인 영상에서 찾기
+	// 피라미드는 전수 탐색과 같은 위치를 찾되 SAD 계산량은 원본 모든 위치 계산의 1/16 이하여야 함 (전체 다시 탐색 없음)
+	std::string templateMatchNoisy() {
+		const int width = 1024, height = 768, templateSize = 64;
+		const long long fullWork = static_cast<long long>(width - templateSize + 1) * (height - templateSize + 1) * templateSize * templateSize;
+		std::mt19937 rng(23);
+		for (double noise : { 2.0, 12.0 }) {
+			for (int run = 0; run < 3; run++) {
+				std::vector<double> clean(static_cast<size_t>(width) * height, 128.0);
+				addValueNoise(clean, width, height, 32, 70.0, rng);
+				addValueNoise(clean, width, height, 8, 30.0, rng);
+				const int originX = rng() % (width - templateSize + 1), originY = rng() % (height - templateSize + 1);
+
+				std::vector<unsigned char> image(clean.size());
+				std::vector<unsigned char> templ(static_cast<size_t>(templateSize) * templateSize);
+				std::normal_distribution<double> gauss(0.0, noise);
+				for (size_t i = 0; i < clean.size(); i++) image[i] = static_cast<unsigned char>(std::clamp(std::lround(clean[i] + gauss(rng)), 0L, 255L));
+				for (int y = 0; y < templateSize; y++) {
+					for (int x = 0; x < templateSize; x++) {
+						templ[static_cast<size_t>(y) * templateSize + x] = static_cast<unsigned char>(std::lround(clean[static_cast<size_t>(originY + y) * width + originX + x]));
+					}
+				}
+
+				NativeEngine::ScratchPool scratch;
+				int found[2][2] = {};
+				NativeEngine::TemplateMatchStats stats[2];
+				for (int m = 0; m < 2; m++) {
+					TemplateMatchOptions options;
+					options.mode = m == 0 ? TemplateMatchMode::Exhaustive : TemplateMatchMode::Pyramid;
+					NativeEngine::MatchTemplate(image.data(), width, height, templ.data(), templateSize, templateSize,
+						options, &found[m][0], &found[m][1], scratch, &stats[m]);
+				}
+				if (found[0][0] != originX || found[0][1] != originY) {
+					return format("noise %.0f: exhaustive found %.0f,%.0f", noise, found[0][0], found[0][1]) + format(" expected %.0f,%.0f", originX, originY);
+				}
+				if (found[1][0] != originX || found[1][1] != originY) {
+					return format("noise %.0f: pyramid found %.0f,%.0f", noise, found[1][0], found[1][1]) + format(" expected %.0f,%.0f", originX, originY);
+				}
+				if (stats[1].levels == 0 || stats[1].pixels * 16 > fullWork) {
+					return format("noise %.0f: pyramid (%.0f levels) computed %.0f template pixels", noise, stats[1].levels, static_cast<double>(stats[1].pixels))
+						+ format(" of %.0f", static_cast<double>(fullWork));
+				}
+			}
+		}
+		return "";
+	}
+
+	// 행 끝 여유가 있는 RGBA 버퍼의 ROI(SubView): 채널/휘도 히스토그램 = 픽셀별 세기 (채널 이름은 실제 색)
+	// 평활화는 ROI 안만 누적 분포 식 round((cdf - cdf(처음 값)) * 255 / (전체 - cdf(처음 값)))로 바뀌고 밖은 그대로
+	std::string histogramsMatchCounts() {
+		const int width = 120, height = 90;
+		const int roiX = 13, roiY = 7, roiWidth = 70, roiHeight = 61;
+		std::vector<unsigned char> source = randomImage(width, height, 61);
+		// 같은 값이 길게 이어지는 구간 (뱅크 교대), 휘도는 중간 값만 쓰게
+		for (int y = 20; y < 40; y++) {
+			for (int x = 0; x < width; x++) {
+				unsigned char* p = &source[(static_cast<size_t>(y) * width + x) * 4];
+				p[0] = 200;
+				p[1] = static_cast<unsigned char>(40 + x % 90);
+				p[2] = static_cast<unsigned char>(60 + y);
+			}
+		}
+
+		// R, G, B, A 순서 바이트
+		NativeEngine::Histogram red, green, blue, alpha, luminance;
+		for (int y = roiY; y < roiY + roiHeight; y++) {
+			for (int x = roiX; x < roiX + roiWidth; x++) {
+				const unsigned char* p = &source[(static_cast<size_t>(y) * width + x) * 4];
+				red.counts[p[0]]++;
+				green.counts[p[1]]++;
+				blue.counts[p[2]]++;
+				alpha.counts[p[3]]++;
+				luminance.counts[NativeEngine::GrayOf(p[2], p[1], p[0])]++;
+			}
+		}
+		auto roi = [&](const NativeEngine::ImageView& view) {
+			NativeEngine::ImageView rgba = view;
+			rgba.layout = NativeEngine::PixelLayout::Rgba32;
+			return rgba.SubView(roiX, roiY, roiWidth, roiHeight);
+		};
+
+		ImageProcessingEngine engine;
+		NativeEngine::ImageHistograms histograms;
+		std::vector<unsigned char> result;
+		std::string error = runStrided(source, width, height, 24, [&](const NativeEngine::ImageView& view) {
+			engine.ComputeHistograms(roi(view), histograms);
+		}, result);
+		if (!error.empty()) return "histograms: " + error;
+		if (result != source) return "histograms: image changed";
+		const std::pair<const NativeEngine::Histogram*, const NativeEngine::Histogram*> channels[] = {
+			{ &histograms.blue, &blue }, { &histograms.green, &green }, { &histograms.red, &red },
+			{ &histograms.alpha, &alpha }, { &histograms.luminance, &luminance } };
+		for (int c = 0; c < 5; c++) {
+			for (int v = 0; v < NativeEngine::histogramBins; v++) {
+				if (channels[c].first->counts[v] != channels[c].second->counts[v]) {
+					return format("histogram %.0f bin %.0f count %.0f", c, v, channels[c].first->counts[v]);
+				}
+			}
+		}
+
+		// 평활화 표 = 누적 분포 식
+		const double total = static_cast<double>(roiWidth) * roiHeight;
+		int first = 0;
+		while (luminance.counts[first] == 0) first++;
+		unsigned char table[NativeEngine::histogramBins];
+		NativeEngine::EqualizationTable(luminance, table);
+		double cdf = 0.0;
+		for (int v = 0; v < NativeEngine::histogramBins; v++) {
+			cdf += luminance.counts[v];
+			const double expected = v < first ? 0.0 : std::floor((cdf - luminance.counts[first]) * 255.0 / (total - luminance.counts[first]) + 0.5);
+			if (table[v] != expected) return format("table %.0f = %.0f, expected %.0f", v, table[v], expected);
+		}
+		// 값이 하나뿐이면 항등
+		NativeEngine::Histogram single;
+		single.counts[90] = 1000;
+		NativeEngine::EqualizationTable(single, table);
+		for (int v = 0; v < NativeEngine::histogramBins; v++) {
+			if (table[v] != v) return format("single-value table %.0f = %.0f", v, table[v]);
+		}
+
+		NativeEngine::EqualizationTable(luminance, table);
+		error = runStrided(source, width, height, 24, [&](const NativeEngine::ImageView& view) {
+			engine.ApplyHistogramEqualization(roi(view));
+		}, result);
+		if (!error.empty()) return "equalization: " + error;
+		for (int y = 0; y < height; y++) {
+			for (int x = 0; x < width; x++) {
+				const size_t i = (static_cast<size_t>(y) * width + x) * 4;
+				const bool inside = x >= roiX && x < roiX + roiWidth && y >= roiY && y < roiY + roiHeight;
+				const unsigned char v = table[NativeEngine::GrayOf(source[i + 2], source[i + 1], source[i])];
+				for (int c = 0; c < 4; c++) {
+					const unsigned char expected = inside && c < 3 ? v : source[i + c];
+					if (result[i + c] != expected) return format("equalization pixel (%.0f, %.0f) channel %.0f", x, y, c);
+				}
+			}
+		}
+		return {};
+	}
+
+	// 크기가 타일 수로 나눠떨어지지 않아도 (49 / 8) 빈 타일이 없어야 함
+	// 자르지 않으면 단색 타일의 표는 모두 그 값을 255로 보내므로, 빈 타일(항등 표)이 있으면 가장자리가 덜 밝아짐
+	std::string claheUnevenTiles() {
+		for (int size : { 49, 50, 55, 63 }) {
+			const int width = size, height = size - 9;
+			std::vector<unsigned char> pixels(static_cast<size_t>(width) * height * 4, 50);
+			for (size_t i = 3; i < pixels.size(); i += 4) pixels[i] = 255;
+
+			NativeEngine::ClaheOptions options;
+			options.tilesX = 8;
+			options.tilesY = 8;
+			options.clipLimit = 0.0f;
+			ImageProcessingEngine engine;
+			engine.ApplyClahe(pixels.data(), width, height, options);
+
+			for (int y = 0; y < height; y++) {
+				for (int x = 0; x < width; x++) {
+					const int v = pixels[(static_cast<size_t>(y) * width + x) * 4];
+					if (v != 255) return format("%.0f x %.0f: output %.0f", width, height, v) + format(" at %.0f,%.0f", x, y);
+				}
+			}
+		}
+		return "";
+	}
+
+	// 클래스 간 분산에 해당하는 값 (구간마다 S^2 / P 합), P/S는 앞에 0 한 칸 둔 누적 합, bounds는 각 클래스의 마지막 값
+	double otsuObjective(const double* P, const double* S, const int* bounds, int count) {
+		double total = 0.0;
+		for (int k = 0, start = 0; k <= count; k++) {
+			const int end = k < count ? bounds[k] : NativeEngine::histogramBins - 1;
+			const double weight = P[end + 1] - P[start];
+			const double moment = S[end + 1] - S[start];
+			if (weight > 0.0) total += moment * moment / weight;
+			start = end + 1;
+		}
+		return total;
+	}
+
+	// 동적 계획법 임계값이 모든 조합 중 최대와 같은 값을 내야 함 (4클래스까지 전수)
+	std::string multiOtsuExhaustive() {
+		std::mt19937 rng(11);
+		NativeEngine::ScratchPool scratch;
+		for (int run = 0; run < 6; run++) {
+			NativeEngine::Histogram histogram;
+			const bool sparse = run % 2 == 0;
+			for (int i = 0; i < NativeEngine::histogramBins; i++) {
+				histogram.counts[i] = sparse ? (rng() % 8 == 0 ? rng() % 500 : 0) : 100 + static_cast<unsigned int>(80.0 * std::sin(i / 17.0) + rng() % 40);
+			}
+			double P[NativeEngine::histogramBins + 1] = {};
+			double S[NativeEngine::histogramBins + 1] = {};
+			for (int i = 0; i < NativeEngine::histogramBins; i++) {
+				P[i + 1] = P[i] + histogram.counts[i];
+				S[i + 1] = S[i] + static_cast<double>(i) * histogram.counts[i];
+			}
+
+			for (int classes = 2; classes <= 4; classes++) {
+				int bounds[3] = {};
+				const int count = NativeEngine::MultiOtsuThresholds(histogram, classes, bounds, scratch);
+				const double found = otsuObjective(P, S, bounds, count);
+
+				double best = 0.0;
+				int trial[3] = {};
+				const int last = NativeEngine::histogramBins - 1;
+				for (trial[0] = 0; trial[0] < last; trial[0]++) {
+					if (count == 1) {
+						best = std::max(best, otsuObjective(P, S, trial, 1));
+						continue;
+					}
+					for (trial[1] = trial[0] + 1; trial[1] < last; trial[1]++) {
+						if (count == 2) {
+							best = std::max(best, otsuObjective(P, S, trial, 2));
+							continue;
+						}
+						for (trial[2] = trial[1] + 1; trial[2] < last; trial[2]++) best = std::max(best, otsuObjective(P, S, trial, 3));
+					}
+				}
+				if (found < best * (1.0 - 1e-12)) return format("run %.0f, %.0f classes: %.6g", run, classes, found) + format(" < %.6g", best);
+			}
+		}
+		return "";
+	}
+
+	// 같은 영상을 두 번 처리하면 두 번째는 풀의 블록만 다시 씀
+	// 풀 최고 사용량, 풀 힙 할당 수, 전역 new 횟수가 늘면 안 됨
+	std::string scratchSteadyState() {
+		const int width = 317, height = 241;
+		const int templateWidth = 48, templateHeight = 40;
+		const std::vector<unsigned char> source = randomImage(width, height, 5);
+		std::vector<unsigned char> templ(static_cast<size_t>(templateWidth) * templateHeight * 4);
+		for (int y = 0; y < templateHeight; y++) {
+			std::copy_n(&source[(static_cast<size_t>(y + 90) * width + 130) * 4], templateWidth * 4, &templ[static_cast<size_t>(y) * templateWidth * 4]);
+		}
+		std::vector<unsigned char> pixels(source.size());
+		ImageProcessingEngine engine;
+		TemplateMatchOptions options;
+		options.mode = TemplateMatchMode::Pyramid;
+		int x = -1, y = -1;
+
+		auto process = [&]() {
+			const NativeEngine::ImageView view(pixels.data(), width, height);
+			std::copy(source.begin(), source.end(), pixels.begin());
+			engine.ApplyGaussianBlur(view, 3.5f);
+			engine.ApplyGaussianBlur(view, 1.2f);
+			engine.ApplyDiskDilation(view, 2.5f);
+			engine.ApplyDiskErosion(view, 1.5f);
+			engine.ApplySobel(view);
+			engine.ApplyLaplacian(view);
+			std::copy(source.begin(), source.end(), pixels.begin());
+			engine.ApplyTemplateMatch(view, NativeEngine::ImageView(templ.data(), templateWidth, templateHeight), &x, &y, options);
+		};
+
+		process();
+		const size_t highWater = engine.GetScratchHighWaterMark();
+		const size_t poolAllocations = engine.GetScratchHeapAllocations();
+		const size_t news = heapNewCount.load();
+		process();
+		if (x != 130 || y != 90) return format("match (%.0f, %.0f)", x, y);
+		if (engine.GetScratchHighWaterMark() != highWater) return format("high water %.0f -> %.0f", static_cast<double>(highWater), static_cast<double>(engine.GetScratchHighWaterMark()));
+		if (engine.GetScratchHeapAllocations() != poolAllocations) {
+			return format("pool allocations %.0f -> %.0f", static_cast<double>(poolAllocations), static_cast<double>(engine.GetScratchHeapAllocations()));
+		}
+		if (heapNewCount.load() != news) return format("%.0f operator new calls on the second run", static_cast<double>(heapNewCount.load() - news));
+		return "";
+	}
+
+	std::vector<TestCase> makeTests() {
+		return {
+			{ "grayPlaneCache", grayPlaneCache },
+			{ "gaussianEdges", gaussianEdges },
+			{ "gaussianEdgeSymmetry", gaussianEdgeSymmetry },
+			{ "gaussianSigma", gaussianSigma },
+			{ "boxBlurMatchesReference", boxBlurMatchesReference },
+			{ "medianMatchesReference", medianMatchesReference },
+			{ "morphologyRectangles", morphologyRectangles },
+			{ "binaryImageOps", binaryImageOps },
+			{ "morphologyCompound", morphologyCompound },
+			{ "morphologyChannels", morphologyChannels },
+			{ "distanceTransformExact", distanceTransformExact },
+			{ "sobelMatchesReference", sobelMatchesReference },
+			{ "cannyMatchesReference", cannyMatchesReference },
+			{ "stencilsMatchReference", stencilsMatchReference },
+			{ "scaleSpaceMatchesReference", scaleSpaceMatchesReference },
+			{ "integralImageMatchesBruteForce", integralImageMatchesBruteForce },
+			{ "adaptiveThresholdMatchesReference", adaptiveThresholdMatchesReference },
+			{ "componentsMatchReference", componentsMatchReference },
+			{ "templateMatchRepetitive", templateMatchRepetitive },
+			{ "templateMatchNoisy", templateMatchNoisy },
+			{ "histogramsMatchCounts", histogramsMatchCounts },
+			{ "claheUnevenTiles", claheUnevenTiles },
+			{ "multiOtsuExhaustive", multiOtsuExhaustive },
+			{ "scratchSteadyState", scratchSteadyState },
+		};
+	}
+}
+
+int main(int argc, char** argv) {
+	const std::string filter = argc > 1 ? argv[1] : "";
+	int failed = 0;
+	int run = 0;
+	for (const TestCase& test : makeTests()) {
+		if (!filter.empty() && std::string(test.name).find(filter) == std::string::npos) continue;
+		run++;
+		const std::string error = test.run();
+		if (error.empty()) std::printf("PASS %s\n", test.name);
+		else {
+			std::printf("FAIL %s: %s\n", test.name, error.c_str());
+			failed++;
+		}
+	}
+	std::printf("%d/%d passed\n", run - failed, run);
+	return failed == 0 ? 0 : 1;
+}
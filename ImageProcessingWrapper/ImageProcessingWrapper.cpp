@@ -3,66 +3,248 @@
 #include "ImageProcessingEngineApp.h"
 using namespace ImageProcessingWrapper;
 
+// Validates the managed buffer and returns a view of the selected region
+static NativeEngine::ImageView MakeRegionView(array<System::Byte>^ pixels, unsigned char* p, int width, int height, int stride, int roiX, int roiY, int roiWidth, int roiHeight,
+    unsigned long long generation) {
+    if (width <= 0 || height <= 0 || stride < width * 4 || static_cast<long long>(stride) * height > pixels->Length) {
+        throw gcnew ArgumentException("pixel buffer is smaller than stride * height");
+    }
+    NativeEngine::ImageView view(p, width, height, stride);
+    view.generation = generation;
+    return view.SubView(roiX, roiY, roiWidth, roiHeight);
+}
+
+// Copies one native histogram into a managed array of at least 256 entries (null is skipped)
+static void CopyHistogram(const NativeEngine::Histogram& histogram, array<int>^ counts) {
+    if (counts == nullptr) return;
+    if (counts->Length < NativeEngine::histogramBins) {
+        throw gcnew ArgumentException("histogram array needs 256 entries");
+    }
+    for (int i = 0; i < NativeEngine::histogramBins; i++) counts[i] = static_cast<int>(histogram.counts[i]);
+}
+
+static void CopyHistograms(const NativeEngine::ImageHistograms& histograms,
+    array<int>^ blue, array<int>^ green, array<int>^ red, array<int>^ luminance) {
+    CopyHistogram(histograms.blue, blue);
+    CopyHistogram(histograms.green, green);
+    CopyHistogram(histograms.red, red);
+    CopyHistogram(histograms.luminance, luminance);
+}
+
+// The same array keeps its generation, so the engine can reuse the luminance plane of its last result.
+// A different array, or one marked changed, gets a new generation.
+unsigned long long ImageEngine::PixelGeneration(array<System::Byte>^ pixels) {
+    if (_lastPixels == nullptr || !Object::ReferenceEquals(_lastPixels->Target, pixels)) {
+        _lastPixels = gcnew WeakReference(pixels);
+        _lastGeneration = ++_generationCounter;
+    }
+    return _lastGeneration;
+}
+
+NativeEngine::ImageView ImageEngine::PixelView(array<System::Byte>^ pixels, unsigned char* p, int width, int height) {
+    NativeEngine::ImageView view(p, width, height);
+    view.generation = PixelGeneration(pixels);
+    return view;
+}
+
+void ImageEngine::MarkPixelsChanged(array<System::Byte>^ pixels) {
+    if (_lastPixels != nullptr && Object::ReferenceEquals(_lastPixels->Target, pixels)) {
+        _lastPixels = nullptr;
+    }
+}
+
 void ImageEngine::ApplyGrayscale(array<System::Byte>^ pixels, int width, int height) {
     pin_ptr<unsigned char> p = &pixels[0];
-    _nativeEngine->ApplyGrayscale(p, width, height);
+    _nativeEngine->ApplyGrayscale(PixelView(pixels, p, width, height));
+}
+void ImageEngine::ApplyGaussianBlur(array<System::Byte>^ pixels, int width, int height, float sigma) {
+    pin_ptr<unsigned char> p = &pixels[0];
+    _nativeEngine->ApplyGaussianBlur(PixelView(pixels, p, width, height), sigma);
 }
-//void ImageEngine::ApplyGaussianBlur(array<System::Byte>^ pixels, int width, int height, float sigma) {
-//    pin_ptr<unsigned char> p = &pixels[0];
-//    _nativeEngine->ApplyGaussianBlur(p, width, height, sigma);
-//}
 void ImageEngine::ApplyGaussianBlur(array<System::Byte>^ pixels, int width, int height, int radius) {
     pin_ptr<unsigned char> p = &pixels[0];
-    _nativeEngine->ApplyGaussianBlur(p, width, height, radius);
+    _nativeEngine->ApplyGaussianBlur(PixelView(pixels, p, width, height), radius);
 }
 void ImageEngine::ApplyMedian(array<System::Byte>^ pixels, int width, int height, int kernelSize) {
     pin_ptr<unsigned char> p = &pixels[0];
-    _nativeEngine->ApplyMedian(p, width, height, kernelSize);
+    _nativeEngine->ApplyMedian(PixelView(pixels, p, width, height), kernelSize);
 }
 
 void ImageEngine::ApplyBinarization(array<System::Byte>^ pixels, int width, int height) {
     pin_ptr<unsigned char> p = &pixels[0];
-    _nativeEngine->ApplyBinarization(p, width, height);
+    _nativeEngine->ApplyBinarization(PixelView(pixels, p, width, height));
+}
+
+void ImageEngine::ApplyBinarization(array<System::Byte>^ pixels, int width, int height, BinarizationMethod method, int threshold, int windowSize) {
+    pin_ptr<unsigned char> p = &pixels[0];
+    NativeEngine::BinarizationOptions options;
+    options.method = static_cast<NativeEngine::BinarizationMethod>(method);
+    options.threshold = threshold;
+    options.windowSize = windowSize;
+    _nativeEngine->ApplyBinarization(PixelView(pixels, p, width, height), options);
+}
+
+void ImageEngine::ApplyMultiOtsu(array<System::Byte>^ pixels, int width, int height, int classes, bool labels, array<int>^ thresholds) {
+    pin_ptr<unsigned char> p = &pixels[0];
+    int bounds[NativeEngine::multiOtsuMaxClasses - 1];
+    _nativeEngine->ApplyMultiOtsu(PixelView(pixels, p, width, height), classes,
+        labels ? NativeEngine::MultiOtsuOutput::Labels : NativeEngine::MultiOtsuOutput::Levels, bounds);
+    if (thresholds != nullptr) {
+        const int count = std::clamp(classes, 2, NativeEngine::multiOtsuMaxClasses) - 1;
+        for (int i = 0; i < count && i < thresholds->Length; i++) thresholds[i] = bounds[i];
+    }
 }
 
 void ImageEngine::ApplyDilation(array<System::Byte>^ pixels, int width, int height) {
     pin_ptr<unsigned char> p = &pixels[0];
-    _nativeEngine->ApplyDilation(p, width, height);
+    _nativeEngine->ApplyDilation(PixelView(pixels, p, width, height));
 }
 
 void ImageEngine::ApplyErosion(array<System::Byte>^ pixels, int width, int height) {
     pin_ptr<unsigned char> p = &pixels[0];
-    _nativeEngine->ApplyErosion(p, width, height);
+    _nativeEngine->ApplyErosion(PixelView(pixels, p, width, height));
+}
+
+void ImageEngine::ComputeHistograms(array<System::Byte>^ pixels, int width, int height,
+    array<int>^ blue, array<int>^ green, array<int>^ red, array<int>^ luminance) {
+    pin_ptr<unsigned char> p = &pixels[0];
+    NativeEngine::ImageHistograms histograms;
+    _nativeEngine->ComputeHistograms(PixelView(pixels, p, width, height), histograms);
+    CopyHistograms(histograms, blue, green, red, luminance);
+}
+
+void ImageEngine::ApplyHistogramEqualization(array<System::Byte>^ pixels, int width, int height) {
+    pin_ptr<unsigned char> p = &pixels[0];
+    _nativeEngine->ApplyHistogramEqualization(PixelView(pixels, p, width, height));
+}
+
+void ImageEngine::ApplyClahe(array<System::Byte>^ pixels, int width, int height, int tilesX, int tilesY, float clipLimit) {
+    pin_ptr<unsigned char> p = &pixels[0];
+    NativeEngine::ClaheOptions options;
+    options.tilesX = tilesX;
+    options.tilesY = tilesY;
+    options.clipLimit = clipLimit;
+    _nativeEngine->ApplyClahe(PixelView(pixels, p, width, height), options);
+}
+
+void ImageEngine::ApplyDilation(array<System::Byte>^ pixels, int width, int height, int kernelSize) {
+    pin_ptr<unsigned char> p = &pixels[0];
+    _nativeEngine->ApplyDilation(PixelView(pixels, p, width, height), kernelSize);
+}
+
+void ImageEngine::ApplyErosion(array<System::Byte>^ pixels, int width, int height, int kernelSize) {
+    pin_ptr<unsigned char> p = &pixels[0];
+    _nativeEngine->ApplyErosion(PixelView(pixels, p, width, height), kernelSize);
+}
+
+void ImageEngine::ApplyMorphology(array<System::Byte>^ pixels, int width, int height, MorphologyOperation operation, int kernelSize) {
+    pin_ptr<unsigned char> p = &pixels[0];
+    _nativeEngine->ApplyMorphology(PixelView(pixels, p, width, height), static_cast<NativeEngine::CompoundMorphology>(operation), kernelSize);
+}
+
+void ImageEngine::ApplyDistanceTransform(array<System::Byte>^ pixels, int width, int height, array<float>^ distances) {
+    if (distances == nullptr) {
+        throw gcnew ArgumentNullException("distances");
+    }
+    if (distances->Length < static_cast<long long>(width) * height) {
+        throw gcnew ArgumentException("distance array needs width * height entries");
+    }
+    pin_ptr<unsigned char> p = &pixels[0];
+    pin_ptr<float> d = &distances[0];
+    _nativeEngine->ApplyDistanceTransform(PixelView(pixels, p, width, height), d);
+}
+
+void ImageEngine::ApplyDiskDilation(array<System::Byte>^ pixels, int width, int height, float radius) {
+    pin_ptr<unsigned char> p = &pixels[0];
+    _nativeEngine->ApplyDiskDilation(PixelView(pixels, p, width, height), radius);
+}
+
+void ImageEngine::ApplyDiskErosion(array<System::Byte>^ pixels, int width, int height, float radius) {
+    pin_ptr<unsigned char> p = &pixels[0];
+    _nativeEngine->ApplyDiskErosion(PixelView(pixels, p, width, height), radius);
+}
+
+array<Blob>^ ImageEngine::LabelComponents(array<System::Byte>^ pixels, int width, int height, bool eightConnected, array<int>^ labels) {
+    if (labels != nullptr && labels->Length < static_cast<long long>(width) * height) {
+        throw gcnew ArgumentException("label array needs width * height entries");
+    }
+    pin_ptr<unsigned char> p = &pixels[0];
+    pin_ptr<int> l = labels != nullptr ? &labels[0] : nullptr;
+    std::vector<NativeEngine::Blob> blobs;
+    const int count = _nativeEngine->LabelComponents(PixelView(pixels, p, width, height),
+        eightConnected ? NativeEngine::Connectivity::Eight : NativeEngine::Connectivity::Four, l, blobs);
+
+    array<Blob>^ result = gcnew array<Blob>(count);
+    for (int i = 0; i < count; i++) {
+        const NativeEngine::Blob& blob = blobs[i];
+        result[i].Label = blob.label;
+        result[i].Area = blob.area;
+        result[i].Left = blob.left;
+        result[i].Top = blob.top;
+        result[i].Right = blob.right;
+        result[i].Bottom = blob.bottom;
+        result[i].CentroidX = blob.centroidX;
+        result[i].CentroidY = blob.centroidY;
+    }
+    return result;
 }
 
 void ImageEngine::ApplySobel(array<System::Byte>^ pixels, int width, int height) {
     pin_ptr<unsigned char> p = &pixels[0];
-    _nativeEngine->ApplySobel(p, width, height);
+    _nativeEngine->ApplySobel(PixelView(pixels, p, width, height));
+}
+
+void ImageEngine::ApplyCanny(array<System::Byte>^ pixels, int width, int height, float sigma, int lowThreshold, int highThreshold) {
+    pin_ptr<unsigned char> p = &pixels[0];
+    _nativeEngine->ApplyCanny(PixelView(pixels, p, width, height), sigma, lowThreshold, highThreshold);
 }
 
 void ImageEngine::ApplyLaplacian(array<System::Byte>^ pixels, int width, int height) {
     pin_ptr<unsigned char> p = &pixels[0];
-    _nativeEngine->ApplyLaplacian(p, width, height);
+    _nativeEngine->ApplyLaplacian(PixelView(pixels, p, width, height));
+}
+
+void ImageEngine::ApplyLaplacian(array<System::Byte>^ pixels, int width, int height, StencilOperator kernel) {
+    pin_ptr<unsigned char> p = &pixels[0];
+    _nativeEngine->ApplyLaplacian(PixelView(pixels, p, width, height), static_cast<NativeEngine::StencilOperator>(kernel));
+}
+
+void ImageEngine::ApplyLaplacian(array<System::Byte>^ pixels, int width, int height, StencilOperator kernel, LaplacianScale scale) {
+    pin_ptr<unsigned char> p = &pixels[0];
+    _nativeEngine->ApplyLaplacian(PixelView(pixels, p, width, height), static_cast<NativeEngine::StencilOperator>(kernel),
+        static_cast<NativeEngine::LaplacianScale>(scale));
+}
+
+void ImageEngine::ApplyStencil(array<System::Byte>^ pixels, int width, int height, StencilOperator op) {
+    pin_ptr<unsigned char> p = &pixels[0];
+    _nativeEngine->ApplyStencil(PixelView(pixels, p, width, height), static_cast<NativeEngine::StencilOperator>(op));
 }
 
 void ImageEngine::ApplyTemplateMatch(array<System::Byte>^ originalPixels, int width, int height, array<System::Byte>^ templatePixels, int templateWidth, int templateHeight, int% matchX, int% matchY){
+    ApplyTemplateMatch(originalPixels, width, height, templatePixels, templateWidth, templateHeight, matchX, matchY, false);
+}
+
+void ImageEngine::ApplyTemplateMatch(array<System::Byte>^ originalPixels, int width, int height, array<System::Byte>^ templatePixels, int templateWidth, int templateHeight, int% matchX, int% matchY, bool pyramid) {
     pin_ptr<unsigned char> p = &originalPixels[0];
     pin_ptr<unsigned char> t = &templatePixels[0];
 
     pin_ptr<int> px = &matchX;
     pin_ptr<int> py = &matchY;
 
-    _nativeEngine->ApplyTemplateMatch(p, width, height, t,  templateWidth, templateHeight, px, py);
+    NativeEngine::TemplateMatchOptions options;
+    options.mode = pyramid ? NativeEngine::TemplateMatchMode::Pyramid : NativeEngine::TemplateMatchMode::Exhaustive;
+    _nativeEngine->ApplyTemplateMatch(PixelView(originalPixels, p, width, height),
+        NativeEngine::ImageView(t, templateWidth, templateHeight), px, py, options);
 }
 
 bool ImageEngine::ApplyFFT(array<System::Byte>^ pixels, int width, int height) {
     pin_ptr<unsigned char> p = &pixels[0];
-    return _nativeEngine->ApplyFFT(p, width, height);
+    return _nativeEngine->ApplyFFT(PixelView(pixels, p, width, height));
 }
 
 bool ImageEngine::ApplyIFFT(array<System::Byte>^ pixels, int width, int height) {
     pin_ptr<unsigned char> p = &pixels[0];
-    return _nativeEngine->ApplyIFFT(p, width, height);
+    return _nativeEngine->ApplyIFFT(PixelView(pixels, p, width, height));
 }
 
 void ImageEngine::ClearFFTData() {
@@ -70,4 +252,81 @@ void ImageEngine::ClearFFTData() {
 }
 bool ImageEngine::HasFFTData() {
     return _nativeEngine->HasFFTData();
+}
+
+long long ImageEngine::GetScratchHighWaterMark() {
+    return static_cast<long long>(_nativeEngine->GetScratchHighWaterMark());
+}
+
+void ImageEngine::TrimScratch() {
+    _nativeEngine->TrimScratch();
+}
+
+void ImageEngine::ApplyGrayscale(array<System::Byte>^ pixels, int width, int height, int stride, int roiX, int roiY, int roiWidth, int roiHeight) {
+    pin_ptr<unsigned char> p = &pixels[0];
+    _nativeEngine->ApplyGrayscale(MakeRegionView(pixels, p, width, height, stride, roiX, roiY, roiWidth, roiHeight, PixelGeneration(pixels)));
+}
+
+void ImageEngine::ApplyGaussianBlur(array<System::Byte>^ pixels, int width, int height, int stride, int roiX, int roiY, int roiWidth, int roiHeight, float sigma) {
+    pin_ptr<unsigned char> p = &pixels[0];
+    _nativeEngine->ApplyGaussianBlur(MakeRegionView(pixels, p, width, height, stride, roiX, roiY, roiWidth, roiHeight, PixelGeneration(pixels)), sigma);
+}
+
+void ImageEngine::ApplyGaussianBlur(array<System::Byte>^ pixels, int width, int height, int stride, int roiX, int roiY, int roiWidth, int roiHeight, int radius) {
+    pin_ptr<unsigned char> p = &pixels[0];
+    _nativeEngine->ApplyGaussianBlur(MakeRegionView(pixels, p, width, height, stride, roiX, roiY, roiWidth, roiHeight, PixelGeneration(pixels)), radius);
+}
+
+void ImageEngine::ApplyMedian(array<System::Byte>^ pixels, int width, int height, int stride, int roiX, int roiY, int roiWidth, int roiHeight, int kernelSize) {
+    pin_ptr<unsigned char> p = &pixels[0];
+    _nativeEngine->ApplyMedian(MakeRegionView(pixels, p, width, height, stride, roiX, roiY, roiWidth, roiHeight, PixelGeneration(pixels)), kernelSize);
+}
+
+void ImageEngine::ApplyBinarization(array<System::Byte>^ pixels, int width, int height, int stride, int roiX, int roiY, int roiWidth, int roiHeight) {
+    pin_ptr<unsigned char> p = &pixels[0];
+    _nativeEngine->ApplyBinarization(MakeRegionView(pixels, p, width, height, stride, roiX, roiY, roiWidth, roiHeight, PixelGeneration(pixels)));
+}
+
+void ImageEngine::ApplyDilation(array<System::Byte>^ pixels, int width, int height, int stride, int roiX, int roiY, int roiWidth, int roiHeight) {
+    pin_ptr<unsigned char> p = &pixels[0];
+    _nativeEngine->ApplyDilation(MakeRegionView(pixels, p, width, height, stride, roiX, roiY, roiWidth, roiHeight, PixelGeneration(pixels)));
+}
+
+void ImageEngine::ApplyErosion(array<System::Byte>^ pixels, int width, int height, int stride, int roiX, int roiY, int roiWidth, int roiHeight) {
+    pin_ptr<unsigned char> p = &pixels[0];
+    _nativeEngine->ApplyErosion(MakeRegionView(pixels, p, width, height, stride, roiX, roiY, roiWidth, roiHeight, PixelGeneration(pixels)));
+}
+
+void ImageEngine::ComputeHistograms(array<System::Byte>^ pixels, int width, int height, int stride, int roiX, int roiY, int roiWidth, int roiHeight,
+    array<int>^ blue, array<int>^ green, array<int>^ red, array<int>^ luminance) {
+    pin_ptr<unsigned char> p = &pixels[0];
+    NativeEngine::ImageHistograms histograms;
+    _nativeEngine->ComputeHistograms(MakeRegionView(pixels, p, width, height, stride, roiX, roiY, roiWidth, roiHeight, PixelGeneration(pixels)), histograms);
+    CopyHistograms(histograms, blue, green, red, luminance);
+}
+
+void ImageEngine::ApplyDilation(array<System::Byte>^ pixels, int width, int height, int stride, int roiX, int roiY, int roiWidth, int roiHeight, int kernelWidth, int kernelHeight) {
+    pin_ptr<unsigned char> p = &pixels[0];
+    _nativeEngine->ApplyDilation(MakeRegionView(pixels, p, width, height, stride, roiX, roiY, roiWidth, roiHeight, PixelGeneration(pixels)), kernelWidth, kernelHeight);
+}
+
+void ImageEngine::ApplyErosion(array<System::Byte>^ pixels, int width, int height, int stride, int roiX, int roiY, int roiWidth, int roiHeight, int kernelWidth, int kernelHeight) {
+    pin_ptr<unsigned char> p = &pixels[0];
+    _nativeEngine->ApplyErosion(MakeRegionView(pixels, p, width, height, stride, roiX, roiY, roiWidth, roiHeight, PixelGeneration(pixels)), kernelWidth, kernelHeight);
+}
+
+void ImageEngine::ApplyMorphology(array<System::Byte>^ pixels, int width, int height, int stride, int roiX, int roiY, int roiWidth, int roiHeight, MorphologyOperation operation, int kernelWidth, int kernelHeight) {
+    pin_ptr<unsigned char> p = &pixels[0];
+    _nativeEngine->ApplyMorphology(MakeRegionView(pixels, p, width, height, stride, roiX, roiY, roiWidth, roiHeight, PixelGeneration(pixels)),
+        static_cast<NativeEngine::CompoundMorphology>(operation), kernelWidth, kernelHeight);
+}
+
+void ImageEngine::ApplySobel(array<System::Byte>^ pixels, int width, int height, int stride, int roiX, int roiY, int roiWidth, int roiHeight) {
+    pin_ptr<unsigned char> p = &pixels[0];
+    _nativeEngine->ApplySobel(MakeRegionView(pixels, p, width, height, stride, roiX, roiY, roiWidth, roiHeight, PixelGeneration(pixels)));
+}
+
+void ImageEngine::ApplyLaplacian(array<System::Byte>^ pixels, int width, int height, int stride, int roiX, int roiY, int roiWidth, int roiHeight) {
+    pin_ptr<unsigned char> p = &pixels[0];
+    _nativeEngine->ApplyLaplacian(MakeRegionView(pixels, p, width, height, stride, roiX, roiY, roiWidth, roiHeight, PixelGeneration(pixels)));
 }
\ No newline at end of file
@@ -5,11 +5,62 @@ using namespace System;
 
 namespace ImageProcessingWrapper {
 
+    // Same order as NativeEngine::CompoundMorphology
+    public enum class MorphologyOperation {
+        Opening,
+        Closing,
+        Gradient,
+        TopHat,
+        BlackHat
+    };
+
+    // Same order as NativeEngine::StencilOperator
+    public enum class StencilOperator {
+        Laplacian4,
+        Laplacian8,
+        Sobel,
+        Scharr,
+        Prewitt,
+        Emboss
+    };
+
+    // Same order as NativeEngine::LaplacianScale
+    public enum class LaplacianScale {
+        Normalized,
+        Fixed
+    };
+
+    // Same order as NativeEngine::BinarizationMethod
+    public enum class BinarizationMethod {
+        Otsu,
+        Fixed,
+        Bradley,
+        Sauvola
+    };
+
+    // One connected component (NativeEngine::Blob)
+    public value struct Blob {
+        int Label;
+        int Area;
+        int Left;
+        int Top;
+        int Right;
+        int Bottom;
+        double CentroidX;
+        double CentroidY;
+    };
+
     public ref class ImageEngine
     {
     private:
         NativeEngine::ImageProcessingEngine* _nativeEngine;
 
+        // 마지막으로 받은 픽셀 배열과 그 버전 (ImageView::generation, 같은 배열이면 엔진이 휘도 평면 재사용)
+        WeakReference^ _lastPixels;
+        unsigned long long _lastGeneration;
+        unsigned long long _generationCounter;
+        unsigned long long PixelGeneration(array<System::Byte>^ pixels);
+        NativeEngine::ImageView PixelView(array<System::Byte>^ pixels, unsigned char* p, int width, int height);
 
     public:
         ImageEngine() {
@@ -20,19 +71,66 @@ namespace ImageProcessingWrapper {
         !ImageEngine() { delete _nativeEngine; }
 
         void ApplyGrayscale(array<System::Byte>^ pixels, int width, int height);
-        //void ApplyGaussianBlur(array<Byte>^ data, int width, int height, float sigma);
+        void ApplyGaussianBlur(array<Byte>^ data, int width, int height, float sigma);
         void ApplyGaussianBlur(array<Byte>^ data, int width, int height, int radius);
 
         void ApplyMedian(array<System::Byte>^ pixels, int width, int height, int kernelSize);
         void ApplyBinarization(array<System::Byte>^ pixels, int width, int height);
+        // threshold: Fixed 임계값 / windowSize: Bradley, Sauvola 창 한 변 (0이면 자동)
+        void ApplyBinarization(array<System::Byte>^ pixels, int width, int height, BinarizationMethod method, int threshold, int windowSize);
+        // classes개 클래스 다중 Otsu, labels면 클래스 번호 그대로 (아니면 회색 단계), thresholds: classes - 1개 (null 가능)
+        void ApplyMultiOtsu(array<System::Byte>^ pixels, int width, int height, int classes, bool labels, array<int>^ thresholds);
         void ApplyDilation(array<System::Byte>^ pixels, int width, int height);
         void ApplyErosion(array<System::Byte>^ pixels, int width, int height);
+        // 256칸 히스토그램 (필요 없는 채널은 nullptr)
+        void ComputeHistograms(array<System::Byte>^ pixels, int width, int height,
+            array<int>^ blue, array<int>^ green, array<int>^ red, array<int>^ luminance);
+        void ApplyHistogramEqualization(array<System::Byte>^ pixels, int width, int height);
+        void ApplyClahe(array<System::Byte>^ pixels, int width, int height, int tilesX, int tilesY, float clipLimit);
+        void ApplyDilation(array<System::Byte>^ pixels, int width, int height, int kernelSize);
+        void ApplyErosion(array<System::Byte>^ pixels, int width, int height, int kernelSize);
+        void ApplyMorphology(array<System::Byte>^ pixels, int width, int height, MorphologyOperation operation, int kernelSize);
+        // distances: width * height (전경 픽셀에서 가장 가까운 배경 픽셀까지, null이거나 짧으면 예외)
+        void ApplyDistanceTransform(array<System::Byte>^ pixels, int width, int height, array<float>^ distances);
+        void ApplyDiskDilation(array<System::Byte>^ pixels, int width, int height, float radius);
+        void ApplyDiskErosion(array<System::Byte>^ pixels, int width, int height, float radius);
+        // 휘도 128 이상 연결 요소, labels: width * height (0 = 배경, null 가능), 반환은 라벨 순서 요소 목록
+        array<Blob>^ LabelComponents(array<System::Byte>^ pixels, int width, int height, bool eightConnected, array<int>^ labels);
         void ApplySobel(array<System::Byte>^ pixels, int width, int height);
+        void ApplyCanny(array<System::Byte>^ pixels, int width, int height, float sigma, int lowThreshold, int highThreshold);
         void ApplyLaplacian(array<System::Byte>^ pixels, int width, int height);
+        void ApplyLaplacian(array<System::Byte>^ pixels, int width, int height, StencilOperator kernel);
+        void ApplyLaplacian(array<System::Byte>^ pixels, int width, int height, StencilOperator kernel, LaplacianScale scale);
+        void ApplyStencil(array<System::Byte>^ pixels, int width, int height, StencilOperator op);
         void ApplyTemplateMatch(array<System::Byte>^ originalPixels, int width, int height, array<System::Byte>^ templatePixels, int templateWidth, int templateHeight, int% matchX, int% matchY);
+        // pyramid: 줄인 단계에서 후보를 고르고 후보 주변만 원본까지 다시 탐색 (큰 템플릿/이미지용)
+        void ApplyTemplateMatch(array<System::Byte>^ originalPixels, int width, int height, array<System::Byte>^ templatePixels, int templateWidth, int templateHeight, int% matchX, int% matchY, bool pyramid);
         bool ApplyFFT(array<System::Byte>^ pixels, int width, int height);
         bool ApplyIFFT(array<System::Byte>^ pixels, int width, int height);
         void ClearFFTData();
         bool HasFFTData();
+
+        // 같은 배열을 연달아 넘기면 앞 결과의 휘도 평면을 재사용하므로, 엔진 밖에서 배열을 고쳤으면 다음 호출 전에 알려 줄 것
+        void MarkPixelsChanged(array<System::Byte>^ pixels);
+
+        // 엔진 임시 버퍼 풀
+        long long GetScratchHighWaterMark();
+        void TrimScratch();
+
+        // stride가 있는 버퍼의 선택 영역만 제자리 처리 (복사 없음)
+        void ApplyGrayscale(array<System::Byte>^ pixels, int width, int height, int stride, int roiX, int roiY, int roiWidth, int roiHeight);
+        void ApplyGaussianBlur(array<System::Byte>^ pixels, int width, int height, int stride, int roiX, int roiY, int roiWidth, int roiHeight, float sigma);
+        void ApplyGaussianBlur(array<System::Byte>^ pixels, int width, int height, int stride, int roiX, int roiY, int roiWidth, int roiHeight, int radius);
+        void ApplyMedian(array<System::Byte>^ pixels, int width, int height, int stride, int roiX, int roiY, int roiWidth, int roiHeight, int kernelSize);
+        void ApplyBinarization(array<System::Byte>^ pixels, int width, int height, int stride, int roiX, int roiY, int roiWidth, int roiHeight);
+        void ApplyDilation(array<System::Byte>^ pixels, int width, int height, int stride, int roiX, int roiY, int roiWidth, int roiHeight);
+        void ApplyErosion(array<System::Byte>^ pixels, int width, int height, int stride, int roiX, int roiY, int roiWidth, int roiHeight);
+        void ComputeHistograms(array<System::Byte>^ pixels, int width, int height, int stride, int roiX, int roiY, int roiWidth, int roiHeight,
+            array<int>^ blue, array<int>^ green, array<int>^ red, array<int>^ luminance);
+        void ApplyDilation(array<System::Byte>^ pixels, int width, int height, int stride, int roiX, int roiY, int roiWidth, int roiHeight, int kernelWidth, int kernelHeight);
+        void ApplyErosion(array<System::Byte>^ pixels, int width, int height, int stride, int roiX, int roiY, int roiWidth, int roiHeight, int kernelWidth, int kernelHeight);
+        void ApplyMorphology(array<System::Byte>^ pixels, int width, int height, int stride, int roiX, int roiY, int roiWidth, int roiHeight, MorphologyOperation operation, int kernelWidth, int kernelHeight);
+        void ApplySobel(array<System::Byte>^ pixels, int width, int height, int stride, int roiX, int roiY, int roiWidth, int roiHeight);
+        void ApplyLaplacian(array<System::Byte>^ pixels, int width, int height, int stride, int roiX, int roiY, int roiWidth, int roiHeight);
     };
 }
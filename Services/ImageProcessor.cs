@@ -16,6 +16,10 @@ namespace ImageProcessing.Services
         private readonly Stack<BitmapImage> _undoStack = new Stack<BitmapImage>();
         private readonly Stack<BitmapImage> _redoStack = new Stack<BitmapImage>();
 
+        // 마지막 필터 결과와 그 픽셀 배열, 다음 입력이 이 결과면 배열을 그대로 넘겨 엔진이 휘도 평면을 재사용 (배열은 엔진만 고침)
+        private BitmapImage _lastResult;
+        private byte[] _lastPixels;
+
         public bool CanUndo => _undoStack.Any();
         public bool CanRedo => _redoStack.Any();
         public bool HasFFTData() => _engine.HasFFTData();
@@ -91,7 +95,9 @@ namespace ImageProcessing.Services
             });
         }
 
-        public Rect TemplateMatch(BitmapSource source, BitmapSource templateImage)
+        // pyramid: 줄인 이미지에서 후보를 고른 뒤 후보 주변만 원본에서 확인 (템플릿이 작으면 전수 탐색과 같음)
+        // 기본은 엔진과 같은 전수 탐색 (피라미드는 근사라 결과가 다를 수 있어 호출 쪽에서 선택)
+        public Rect TemplateMatch(BitmapSource source, BitmapSource templateImage, bool pyramid = false)
         {
             if (source == null || templateImage == null) return Rect.Empty;
             if (templateImage.PixelWidth > source.PixelWidth || templateImage.PixelHeight > source.PixelHeight)
@@ -100,10 +106,7 @@ namespace ImageProcessing.Services
                 return Rect.Empty;
             }
 
-            var sourceBitmap = new FormatConvertedBitmap(source, PixelFormats.Bgra32, null, 0);
-            int sourceStride = sourceBitmap.PixelWidth * 4;
-            byte[] sourcePixels = new byte[sourceBitmap.PixelHeight * sourceStride];
-            sourceBitmap.CopyPixels(sourcePixels, sourceStride, 0);
+            byte[] sourcePixels = GetPixels(source);
 
             var templateBitmap = new FormatConvertedBitmap(templateImage, PixelFormats.Bgra32, null, 0);
             int templateStride = templateBitmap.PixelWidth * 4;
@@ -113,7 +116,7 @@ namespace ImageProcessing.Services
             _engine.ApplyTemplateMatch(
                 sourcePixels, source.PixelWidth, source.PixelHeight,
                 templatePixels, templateImage.PixelWidth, templateImage.PixelHeight,
-                ref matchX, ref matchY
+                ref matchX, ref matchY, pyramid
             );
 
             if (matchX >= 0 && matchY >= 0)
@@ -126,19 +129,42 @@ namespace ImageProcessing.Services
                 return Rect.Empty;
             }
         }
+        // 연결 요소 목록 (휘도 128 이상이 전경, 이진화 뒤에 쓰는 용도), 이미지는 그대로
+        public Blob[] FindBlobs(BitmapSource source, bool eightConnected = true)
+        {
+            if (source == null) return Array.Empty<Blob>();
+
+            byte[] pixels = GetPixels(source);
+            return _engine.LabelComponents(pixels, source.PixelWidth, source.PixelHeight, eightConnected, null);
+        }
+
+        // Bgra32 픽셀 배열 (마지막 필터 결과면 복사 없이 그 배열)
+        private byte[] GetPixels(BitmapSource source)
+        {
+            if (_lastResult != null && ReferenceEquals(source, _lastResult)) return _lastPixels;
+
+            var bitmap = new FormatConvertedBitmap(source, PixelFormats.Bgra32, null, 0);
+            int stride = bitmap.PixelWidth * 4;
+            byte[] pixels = new byte[bitmap.PixelHeight * stride];
+            bitmap.CopyPixels(pixels, stride, 0);
+            return pixels;
+        }
+
         private BitmapImage ProcessImageInternal(BitmapImage img, Action<byte[], int, int> processAction)
         {
-            var bitmap = new FormatConvertedBitmap(img, PixelFormats.Bgra32, null, 0);
-            int width = bitmap.PixelWidth;
-            int height = bitmap.PixelHeight;
+            int width = img.PixelWidth;
+            int height = img.PixelHeight;
             int stride = width * 4;
-            byte[] pixels = new byte[height * stride];
-            bitmap.CopyPixels(pixels, stride, 0);
+            byte[] pixels = GetPixels(img);
+            _lastResult = null; // 처리 도중 실패해도 고쳐진 배열을 이전 결과의 픽셀로 쓰지 않게
 
             processAction(pixels, width, height);
 
             var processedBitmap = BitmapSource.Create(width, height, 96, 96, PixelFormats.Bgra32, null, pixels, stride);
-            return ConvertBitmapSourceToBitmapImage(processedBitmap);
+            var result = ConvertBitmapSourceToBitmapImage(processedBitmap);
+            _lastResult = result;
+            _lastPixels = pixels;
+            return result;
         }
 
         private BitmapImage ApplyFilter(BitmapImage source, Action<byte[], int, int> processAction)
@@ -152,9 +178,9 @@ namespace ImageProcessing.Services
         public BitmapImage ApplyGrayscale(BitmapImage source) {
            return ApplyFilter(source, (p, w, h) => _engine.ApplyGrayscale(p, w, h));
         }
-        //public BitmapImage ApplyGaussianBlur(BitmapImage source, float sigma) { 
-        //    return ApplyFilter(source, (p, w, h) => _engine.ApplyGaussianBlur(p, w, h, sigma));
-        //}
+        public BitmapImage ApplyGaussianBlur(BitmapImage source, float sigma) { 
+            return ApplyFilter(source, (p, w, h) => _engine.ApplyGaussianBlur(p, w, h, sigma));
+        }
         public BitmapImage ApplyGaussianBlur(BitmapImage source, int radius)
         {
             return ApplyFilter(source, (p, w, h) => _engine.ApplyGaussianBlur(p, w, h, radius));
@@ -162,21 +188,67 @@ namespace ImageProcessing.Services
         public BitmapImage ApplySobel(BitmapImage source) { 
             return ApplyFilter(source, (p, w, h) => _engine.ApplySobel(p, w, h));
         }
-        public BitmapImage ApplyLaplacian(BitmapImage source, int kernelType)
+        // 얇은 에지 (블러 -> 소벨 -> 비최대 억제 -> 히스테리시스), 임계값은 소벨 크기 기준
+        public BitmapImage ApplyCanny(BitmapImage source, float sigma = 1.4f, int lowThreshold = 50, int highThreshold = 150)
+        {
+            return ApplyFilter(source, (p, w, h) => _engine.ApplyCanny(p, w, h, sigma, lowThreshold, highThreshold));
+        }
+        // kernelType: 0 = 4방향, 1 = 8방향 (설정 창 콤보박스 순서)
+        // fixedScale: 최댓값 정규화 없이 255에서 자름 (큰 이미지에서 중간 버퍼 없음)
+        public BitmapImage ApplyLaplacian(BitmapImage source, int kernelType, bool fixedScale = false)
         {
-            return ApplyFilter(source, (p, w, h) => _engine.ApplyLaplacian(p, w, h));
+            var kernel = kernelType == 0 ? StencilOperator.Laplacian4 : StencilOperator.Laplacian8;
+            var scale = fixedScale ? LaplacianScale.Fixed : LaplacianScale.Normalized;
+            return ApplyFilter(source, (p, w, h) => _engine.ApplyLaplacian(p, w, h, kernel, scale));
         }
-        public BitmapImage ApplyBinarization(BitmapImage source, int param = 128)
+        // 3x3 스텐실 (Scharr, Prewitt, 엠보스 등)
+        public BitmapImage ApplyStencil(BitmapImage source, StencilOperator op)
         {
-            return ApplyFilter(source, (p, w, h) => _engine.ApplyBinarization(p, w, h));
+            return ApplyFilter(source, (p, w, h) => _engine.ApplyStencil(p, w, h, op));
+        }
+        // param: Fixed 임계값 (Otsu는 자동, Bradley/Sauvola는 국소 임계값이라 무시)
+        // windowSize: Bradley/Sauvola 창 한 변 (0이면 짧은 변의 1/8), 조명이 고르지 않은 스캔용
+        public BitmapImage ApplyBinarization(BitmapImage source, int param = 128,
+            BinarizationMethod method = BinarizationMethod.Otsu, int windowSize = 0)
+        {
+            return ApplyFilter(source, (p, w, h) => _engine.ApplyBinarization(p, w, h, method, param, windowSize));
+        }
+        // 휘도 히스토그램 평활화 (결과는 회색)
+        public BitmapImage ApplyHistogramEqualization(BitmapImage source)
+        {
+            return ApplyFilter(source, (p, w, h) => _engine.ApplyHistogramEqualization(p, w, h));
+        }
+        // 타일별 대비 제한 평활화 (tiles x tiles 타일, clipLimit은 칸 평균의 배수)
+        public BitmapImage ApplyClahe(BitmapImage source, float clipLimit = 2.0f, int tiles = 8)
+        {
+            return ApplyFilter(source, (p, w, h) => _engine.ApplyClahe(p, w, h, tiles, tiles, clipLimit));
+        }
+        // 다중 Otsu (classes개 밝기 단계로 분할)
+        public BitmapImage ApplyMultiOtsu(BitmapImage source, int classes = 3)
+        {
+            return ApplyFilter(source, (p, w, h) => _engine.ApplyMultiOtsu(p, w, h, classes, false, null));
         }
         public BitmapImage ApplyDilation(BitmapImage source, int param = 3)
         {
-            return ApplyFilter(source, (p, w, h) => _engine.ApplyDilation(p, w, h));
+            return ApplyFilter(source, (p, w, h) => _engine.ApplyDilation(p, w, h, param));
         }
         public BitmapImage ApplyErosion(BitmapImage source, int param = 3)
         {
-            return ApplyFilter(source, (p, w, h) => _engine.ApplyErosion(p, w, h));
+            return ApplyFilter(source, (p, w, h) => _engine.ApplyErosion(p, w, h, param));
+        }
+        // 열림/닫힘/그레이디언트/톱햇 (침식, 팽창을 따로 적용하는 것보다 한 번에)
+        public BitmapImage ApplyMorphology(BitmapImage source, MorphologyOperation operation, int param = 3)
+        {
+            return ApplyFilter(source, (p, w, h) => _engine.ApplyMorphology(p, w, h, operation, param));
+        }
+        // 원판 팽창/침식 (이진화된 이미지용, 반지름이 커도 비용이 같음)
+        public BitmapImage ApplyDiskDilation(BitmapImage source, float radius)
+        {
+            return ApplyFilter(source, (p, w, h) => _engine.ApplyDiskDilation(p, w, h, radius));
+        }
+        public BitmapImage ApplyDiskErosion(BitmapImage source, float radius)
+        {
+            return ApplyFilter(source, (p, w, h) => _engine.ApplyDiskErosion(p, w, h, radius));
         }
         public BitmapImage ApplyMedian(BitmapImage source, int param = 3)
         {